@@ -22,6 +22,7 @@
 #include "globalutilities.h"
 #include "tools/idtools.h"
 #include "application/appapplication.h"
+#include "project/prjproject.h"
 #include "parameter/prmparameter.h"
 #include "feature/ftrbase.h"
 #include "library/lbrcsysdragger.h"
@@ -102,7 +103,14 @@ namespace ann
       {
         lbr::CSysDragger *dragger = dynamic_cast<lbr::CSysDragger*>(this->getTransform());
         assert(dragger);
-        if (dragger->isLinked())
+        prj::Project *project = app::instance()->getProject();
+        if (project && project->isUpdating())
+        {
+          //features are being updated on a worker. put the dragger back.
+          this->getTransform()->setMatrix(cachedMatrix);
+          stream << QObject::tr("Model update running. Dragger reset").toUtf8().data();
+        }
+        else if (dragger->isLinked())
         {
           if (lastTranslation != 0.0 || lastRotation != 0.0)
           {
@@ -160,6 +168,7 @@ prmObserver(std::make_unique<prm::Observer>())
   
   prmObserver->constantHandler = std::bind(&CSysDragger::csysActiveChanged, this);
   prmObserver->activeHandler = std::bind(&CSysDragger::csysActiveChanged, this);
+  prmObserver->setDeferrable(); //scene graph changes.
   parameter->connect(*prmObserver);
 }
 
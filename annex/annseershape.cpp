@@ -17,6 +17,8 @@
  *
  */
 #include <functional>
+#include <atomic>
+#include <mutex>
 #include <stack>
 #include <algorithm>
 
@@ -232,17 +234,52 @@ namespace ann
   
   struct ShapeStow
   {
-    ShapeIdContainer shapeIds;
     EvolveContainer evolves;
     FeatureTagContainer featureTags;
     DerivedContainer derives;
-    Graph graph;
-    Graph rGraph; //reversed graph.
+    
+    /* shape data. A shape set with a reader isn't read until the first
+     * call for shape data, which can come from a const function.
+     */
+    ShapeIdContainer& shapeIds() const {load(); return shapeIdData;}
+    Graph& graph() const {load(); return graphData;}
+    Graph& rGraph() const {load(); return rGraphData;} //reversed graph.
+    
+    mutable std::function<void ()> loader; //!< fills in shape data. set while pending.
+    std::vector<std::pair<std::size_t, uuid>> pendingIds; //!< shape offset and id from serialIn while pending.
+    mutable std::atomic<bool> pending{false};
+    mutable std::recursive_mutex loadMutex;
+    mutable bool loading = false; //!< loader is running. shape data is ready for its own calls.
+    
+    void load() const
+    {
+      if (!pending.load())
+        return;
+      std::lock_guard<std::recursive_mutex> lock(loadMutex);
+      if (!pending.load() || loading)
+        return;
+      loading = true;
+      loader();
+      loader = nullptr;
+      loading = false;
+      pending.store(false);
+    }
+    
+    //! forget a pending shape. Does nothing from inside the loader.
+    void cancel()
+    {
+      std::lock_guard<std::recursive_mutex> lock(loadMutex);
+      if (loading)
+        return;
+      pending.store(false);
+      loader = nullptr;
+      pendingIds.clear();
+    }
     
     const ShapeIdRecord& findShapeIdRecord(const uuid& idIn) const
     {
       typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-      const List &list = shapeIds.get<ShapeIdRecord::ById>();
+      const List &list = shapeIds().get<ShapeIdRecord::ById>();
       List::const_iterator it = list.find(idIn);
       assert(it != list.end());
       return *it;
@@ -251,7 +288,7 @@ namespace ann
     const ShapeIdRecord& findShapeIdRecord(const Vertex& vertexIn) const
     {
       typedef ShapeIdContainer::index<ShapeIdRecord::ByVertex>::type List;
-      const List &list = shapeIds.get<ShapeIdRecord::ByVertex>();
+      const List &list = shapeIds().get<ShapeIdRecord::ByVertex>();
       List::const_iterator it = list.find(vertexIn);
       assert(it != list.end());
       return *it;
@@ -260,11 +297,15 @@ namespace ann
     const ShapeIdRecord& findShapeIdRecord(const TopoDS_Shape& shapeIn) const
     {
       typedef ShapeIdContainer::index<ShapeIdRecord::ByShape>::type List;
-      const List &list = shapeIds.get<ShapeIdRecord::ByShape>();
+      const List &list = shapeIds().get<ShapeIdRecord::ByShape>();
       List::const_iterator it = list.find(shapeIn);
       assert(it != list.end());
       return *it;
     }
+  private:
+    mutable ShapeIdContainer shapeIdData;
+    mutable Graph graphData;
+    mutable Graph rGraphData;
   };
   
   template <class GraphTypeIn>
@@ -378,6 +419,69 @@ void SeerShape::setOCCTShape(const TopoDS_Shape& shapeIn, const uuid &idIn)
   if (shapeIn.IsNull())
     return;
   
+  buildShapeData(shapeIn, idIn);
+  rootShapeId = idIn;
+  if (!hasEvolveRecordOut(idIn))
+    insertEvolve(gu::createNilId(), idIn);
+}
+
+/*! @brief Resets the seershape and adds an occt shape read on first use.
+ * 
+ * @param readerIn returns the shape. Called once, from whichever thread
+ * first asks for shape data. Ids, evolve records and feature tags are
+ * available right away and serialIn applies shape ids when the shape is read.
+ * @param idIn is the shape id for the root compound.
+ * @details Project open uses this, so shapes of features nobody looks at
+ * are never read.
+ */
+void SeerShape::setOCCTShape(const std::function<TopoDS_Shape ()> &readerIn, const uuid &idIn)
+{
+  reset();
+  rootShapeId = idIn;
+  if (!hasEvolveRecordOut(idIn))
+    insertEvolve(gu::createNilId(), idIn);
+  
+  stow->loader = [this, readerIn, idIn]()
+  {
+    TopoDS_Shape shape = readerIn();
+    if (shape.IsNull())
+      return;
+    TopoDS_Shape workShape = buildShapeData(shape, idIn);
+    occt::ShapeVector shapes = occt::mapShapes(workShape);
+    for (const auto &pendingId : stow->pendingIds)
+    {
+      if (pendingId.first < shapes.size())
+        updateId(shapes.at(pendingId.first), pendingId.second);
+      else
+        std::cerr << "WARNING: invalid shape offset in SeerShape::setOCCTShape" << std::endl;
+    }
+    stow->pendingIds.clear();
+  };
+  stow->pending.store(true);
+}
+
+//! @brief True when the shape was set with a reader that hasn't been called yet.
+bool SeerShape::isPending() const
+{
+  return stow->pending.load();
+}
+
+/*! @brief Resets the seershape.
+ * 
+ * @details clears shapeIds and graphs.
+ */
+void SeerShape::reset()
+{
+  stow->cancel();
+  rootShapeId = gu::createNilId();
+  stow->shapeIds().get<ShapeIdRecord::ById>().clear();
+  stow->graph() = Graph();
+  stow->rGraph() = stow->graph();
+}
+
+//! fill in shape ids and graphs. Doesn't touch rootShapeId or evolve records. @return the root compound.
+TopoDS_Shape SeerShape::buildShapeData(const TopoDS_Shape &shapeIn, const uuid &idIn)
+{
   //make sure we have a compound as root of shape.
   TopoDS_Shape workShape = occt::compoundWrap(shapeIn);
   
@@ -386,38 +490,23 @@ void SeerShape::setOCCTShape(const TopoDS_Shape& shapeIn, const uuid &idIn)
   {
     ShapeIdRecord record;
     record.shape = s;
-    record.graphVertex = boost::add_vertex(stow->graph);
+    record.graphVertex = boost::add_vertex(stow->graph());
     //id is nil. set by record constructor.
     
-    stow->shapeIds.insert(record);
+    stow->shapeIds().insert(record);
   }
   
   updateId(workShape, idIn);
-  rootShapeId = idIn;
-  if (!hasEvolveRecordOut(idIn))
-    insertEvolve(gu::createNilId(), idIn);
-  stow->rGraph = stow->graph; //now graph and rGraph are equal, edgeless graphs.
+  stow->rGraph() = stow->graph(); //now graph and rGraph are equal, edgeless graphs.
   
-  updateGraphs();
+  updateGraphs(workShape);
+  return workShape;
 }
 
-/*! @brief Resets the seershape.
- * 
- * @details clears shapeIds and graphs.
- */
-void SeerShape::reset()
-{
-  rootShapeId = gu::createNilId();
-  stow->shapeIds.get<ShapeIdRecord::ById>().clear();
-  stow->graph = Graph();
-  stow->rGraph = stow->graph;
-}
-
-void SeerShape::updateGraphs()
+void SeerShape::updateGraphs(const TopoDS_Shape &rootWorkShape)
 {
   //expects that graph and rGraph are equal and edgeless.
   //expects that the graph and rGraph contain vertices for all shapes in container.
-  //expects that the rootShapeId is set even temporarily.
   
   //recursive function to build graph.
   std::stack<TopoDS_Shape> shapeStack;
@@ -435,10 +524,10 @@ void SeerShape::updateGraphs()
         Vertex pVertex = stow->findShapeIdRecord(shapeStack.top()).graphVertex;
         Vertex cVertex = stow->findShapeIdRecord(currentShape).graphVertex;
         
-        if (!boost::edge(pVertex, cVertex, stow->graph).second)
+        if (!boost::edge(pVertex, cVertex, stow->graph()).second)
         {
-          boost::add_edge(pVertex, cVertex, stow->graph);
-          boost::add_edge(cVertex, pVertex, stow->rGraph);
+          boost::add_edge(pVertex, cVertex, stow->graph());
+          boost::add_edge(cVertex, pVertex, stow->rGraph());
         }
       }
       shapeStack.push(currentShape);
@@ -447,7 +536,6 @@ void SeerShape::updateGraphs()
     }
   };
   
-  const TopoDS_Shape &rootWorkShape = getRootOCCTShape();
   shapeStack.push(rootWorkShape);
   recursion(rootWorkShape);
 }
@@ -455,7 +543,7 @@ void SeerShape::updateGraphs()
 bool SeerShape::hasId(const uuid& idIn) const
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   List::const_iterator it = list.find(idIn);
   return (it != list.end());
 }
@@ -463,7 +551,7 @@ bool SeerShape::hasId(const uuid& idIn) const
 bool SeerShape::hasShape(const TopoDS_Shape& shapeIn) const
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ByShape>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ByShape>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ByShape>();
   List::const_iterator it = list.find(shapeIn);
   return (it != list.end());
 }
@@ -471,7 +559,7 @@ bool SeerShape::hasShape(const TopoDS_Shape& shapeIn) const
 const TopoDS_Shape& SeerShape::findShape(const uuid& idIn) const
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   List::const_iterator it = list.find(idIn);
   assert(it != list.end());
   return it->shape;
@@ -480,7 +568,7 @@ const TopoDS_Shape& SeerShape::findShape(const uuid& idIn) const
 const uuid& SeerShape::findId(const TopoDS_Shape& shapeIn) const
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ByShape>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ByShape>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ByShape>();
   List::const_iterator it = list.find(shapeIn);
   assert(it != list.end());
   return it->id;
@@ -490,7 +578,7 @@ const uuid& SeerShape::findId(const TopoDS_Shape& shapeIn) const
 void SeerShape::updateId(const TopoDS_Shape& shapeIn, const uuid& idIn)
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ByShape>::type List;
-  List &list = stow->shapeIds.get<ShapeIdRecord::ByShape>();
+  List &list = stow->shapeIds().get<ShapeIdRecord::ByShape>();
   List::iterator it = list.find(shapeIn);
   assert(it != list.end());
   ShapeIdRecord record = *it;
@@ -503,7 +591,7 @@ std::vector<uuid> SeerShape::getAllShapeIds() const
   std::vector<uuid> out;
   
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   for (const auto &entry : list)
     out.push_back(entry.id);
   return out;
@@ -514,7 +602,7 @@ occt::ShapeVector SeerShape::getAllShapes() const
   occt::ShapeVector out;
   
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   for (const auto &entry : list)
     out.push_back(entry.shape);
   return out;
@@ -524,7 +612,7 @@ occt::ShapeVector SeerShape::getAllNilShapes() const
 {
   occt::ShapeVector out;
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   auto rangeItPair = list.equal_range(gu::createNilId());
   for (; rangeItPair.first != rangeItPair.second; ++rangeItPair.first)
     out.push_back(rangeItPair.first->shape);
@@ -616,7 +704,7 @@ void SeerShape::fillInHistory(ftr::ShapeHistory &historyIn, const BID::uuid &fea
       historyIn.addShape(featureId, it->outId);
     
     if (historyIn.hasShape(it->inId) && historyIn.hasShape(it->outId))
-      historyIn.addConnection(it->outId, it->inId); //child points to parent.
+      historyIn.addConnection(featureId, it->outId, it->inId); //child points to parent.
   }
 }
 
@@ -677,6 +765,8 @@ void SeerShape::setRootShapeId(const uuid& idIn)
 
 bool SeerShape::isNull() const
 {
+  if (isPending())
+    return rootShapeId.is_nil();
   return rootShapeId.is_nil() || (!hasId(rootShapeId));
 }
 
@@ -687,7 +777,7 @@ std::vector<uuid> SeerShape::useGetParentsOfType
 
   std::vector<Vertex> vertices;
   TypeCollectionVisitor vis(shapeTypeIn, *this, vertices);
-  boost::breadth_first_search(stow->rGraph, stow->findShapeIdRecord(idIn).graphVertex, boost::visitor(vis));
+  boost::breadth_first_search(stow->rGraph(), stow->findShapeIdRecord(idIn).graphVertex, boost::visitor(vis));
 
   std::vector<Vertex>::const_iterator vit;
   std::vector<uuid> idsOut;
@@ -703,7 +793,7 @@ occt::ShapeVector SeerShape::useGetParentsOfType
   
   std::vector<Vertex> vertices;
   TypeCollectionVisitor vis(shapeTypeIn, *this, vertices);
-  boost::breadth_first_search(stow->rGraph, stow->findShapeIdRecord(shapeIn).graphVertex, boost::visitor(vis));
+  boost::breadth_first_search(stow->rGraph(), stow->findShapeIdRecord(shapeIn).graphVertex, boost::visitor(vis));
 
   occt::ShapeVector shapesOut;
   for (const auto &gVertex : vertices)
@@ -719,7 +809,7 @@ std::vector<uuid> SeerShape::useGetChildrenOfType
 
   std::vector<Vertex> vertices;
   TypeCollectionVisitor vis(shapeTypeIn, *this, vertices);
-  boost::breadth_first_search(stow->graph, stow->findShapeIdRecord(idIn).graphVertex, boost::visitor(vis));
+  boost::breadth_first_search(stow->graph(), stow->findShapeIdRecord(idIn).graphVertex, boost::visitor(vis));
 
   std::vector<Vertex>::const_iterator vit;
   std::vector<uuid> idsOut;
@@ -735,7 +825,7 @@ occt::ShapeVector SeerShape::useGetChildrenOfType
 
   std::vector<Vertex> vertices;
   TypeCollectionVisitor vis(shapeTypeIn, *this, vertices);
-  boost::breadth_first_search(stow->graph, stow->findShapeIdRecord(shapeIn).graphVertex, boost::visitor(vis));
+  boost::breadth_first_search(stow->graph(), stow->findShapeIdRecord(shapeIn).graphVertex, boost::visitor(vis));
 
   std::vector<Vertex>::const_iterator vit;
   occt::ShapeVector out;
@@ -754,10 +844,10 @@ uuid SeerShape::useGetWire
   Vertex faceVertex = stow->findShapeIdRecord(faceIdIn).graphVertex;
 
   VertexAdjacencyIterator wireIt, wireItEnd;
-  for (boost::tie(wireIt, wireItEnd) = boost::adjacent_vertices(faceVertex, stow->graph); wireIt != wireItEnd; ++wireIt)
+  for (boost::tie(wireIt, wireItEnd) = boost::adjacent_vertices(faceVertex, stow->graph()); wireIt != wireItEnd; ++wireIt)
   {
     VertexAdjacencyIterator edgeIt, edgeItEnd;
-    for (boost::tie(edgeIt, edgeItEnd) = boost::adjacent_vertices((*wireIt), stow->graph); edgeIt != edgeItEnd; ++edgeIt)
+    for (boost::tie(edgeIt, edgeItEnd) = boost::adjacent_vertices((*wireIt), stow->graph()); edgeIt != edgeItEnd; ++edgeIt)
     {
       if (edgeVertex == (*edgeIt))
         return stow->findShapeIdRecord(*wireIt).id;
@@ -778,7 +868,7 @@ uuid SeerShape::useGetClosestWire(const uuid& faceIn, const osg::Vec3d& pointIn)
   VertexAdjacencyIterator it, itEnd;
   uuid wireOut = gu::createNilId();
   double distance = std::numeric_limits<double>::max();
-  for (boost::tie(it, itEnd) = boost::adjacent_vertices(faceVertex, stow->graph); it != itEnd; ++it)
+  for (boost::tie(it, itEnd) = boost::adjacent_vertices(faceVertex, stow->graph()); it != itEnd; ++it)
   {
     const ShapeIdRecord &cRecord = stow->findShapeIdRecord(*it);
     assert(cRecord.shape.ShapeType() == TopAbs_WIRE);
@@ -967,7 +1057,7 @@ occt::ShapeVector SeerShape::useGetNonCompoundChildren() const
   
   occt::ShapeVector out;
   auto r = stow->findShapeIdRecord(getRootShapeId());
-  for (auto aits = boost::adjacent_vertices(r.graphVertex, stow->graph); aits.first != aits.second; ++aits.first)
+  for (auto aits = boost::adjacent_vertices(r.graphVertex, stow->graph()); aits.first != aits.second; ++aits.first)
   {
     const TopoDS_Shape &subShape = stow->findShapeIdRecord(*aits.first).shape;
     assert(subShape.ShapeType() != TopAbs_COMPOUND);
@@ -1022,7 +1112,7 @@ occt::EdgeVector SeerShape::useWalkTangentEdges(const TopoDS_Edge &eIn) const
 void SeerShape::shapeMatch(const SeerShape &source)
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ByShape>::type List;
-  const List &list = source.stow->shapeIds.get<ShapeIdRecord::ByShape>();
+  const List &list = source.stow->shapeIds().get<ShapeIdRecord::ByShape>();
   
   //every feature shape has unique id even if it is the same topoDS_shape.
   //all tracking of shapes between feature will have to use evolve container.
@@ -1093,8 +1183,8 @@ void SeerShape::uniqueTypeMatch(const SeerShape &source)
     ShapeIdRecord targetRecord;
     if
     (
-      (!getUniqueRecord(source.stow->shapeIds, sourceRecord, currentShapeType)) ||
-      (!getUniqueRecord(stow->shapeIds, targetRecord, currentShapeType))
+      (!getUniqueRecord(source.stow->shapeIds(), sourceRecord, currentShapeType)) ||
+      (!getUniqueRecord(stow->shapeIds(), targetRecord, currentShapeType))
     )
       continue;
       
@@ -1157,7 +1247,7 @@ void SeerShape::modifiedMatch
 )
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &sourceList = source.stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &sourceList = source.stow->shapeIds().get<ShapeIdRecord::ById>();
   for (const auto &sourceRecord : sourceList)
   {
     const TopTools_ListOfShape &modifiedList = shapeMakerIn.Modified(sourceRecord.shape);
@@ -1195,7 +1285,7 @@ void SeerShape::modifiedMatch
 void SeerShape::derivedMatch()
 {
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   occt::ShapeVector nilShapes;
   auto rangeItPair = list.equal_range(gu::createNilId());
   for (; rangeItPair.first != rangeItPair.second; ++rangeItPair.first)
@@ -1251,7 +1341,7 @@ void SeerShape::dumpNils(const std::string &headerIn)
   std::ostringstream stream;
   
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   auto rangeItPair = list.equal_range(gu::createNilId());
   for (; rangeItPair.first != rangeItPair.second; ++rangeItPair.first)
     stream << gu::idToString(rangeItPair.first->id) << "    "
@@ -1268,12 +1358,12 @@ void SeerShape::dumpDuplicates(const std::string &headerIn)
   
   std::set<boost::uuids::uuid> processed;
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   for (const auto &record : list)
   {
     if (processed.count(record.id) > 0)
       continue;
-    std::size_t count = stow->shapeIds.count(record.id);
+    std::size_t count = stow->shapeIds().count(record.id);
     if (count > 1)
     {
       processed.insert(record.id);
@@ -1289,7 +1379,7 @@ void SeerShape::ensureNoNils()
   occt::ShapeVector nilShapes;
   
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   auto rangeItPair = list.equal_range(gu::createNilId());
   for (; rangeItPair.first != rangeItPair.second; ++rangeItPair.first)
     nilShapes.push_back(rangeItPair.first->shape);
@@ -1308,7 +1398,7 @@ void SeerShape::ensureNoDuplicates()
   std::set<boost::uuids::uuid> processed;
   occt::ShapeVector shapes;
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  const List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   for (const auto &record : list)
   {
     if (processed.count(record.id) > 0)
@@ -1326,7 +1416,7 @@ void SeerShape::ensureNoDuplicates()
 
 void SeerShape::ensureEvolve()
 {
-  const auto &shapeIdlist = stow->shapeIds.get<ShapeIdRecord::ById>();
+  const auto &shapeIdlist = stow->shapeIds().get<ShapeIdRecord::ById>();
   auto &evolveList = stow->evolves.get<EvolveRecord::ByOutId>();
   for (const auto &record : shapeIdlist)
   {
@@ -1340,7 +1430,7 @@ void SeerShape::faceEdgeMatch(const SeerShape &source)
 {
   occt::ShapeVector nilEdges;
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   auto rangeItPair = list.equal_range(gu::createNilId());
   for (; rangeItPair.first != rangeItPair.second; ++rangeItPair.first)
   {
@@ -1405,7 +1495,7 @@ void SeerShape::edgeVertexMatch(const SeerShape &source)
   
   occt::ShapeVector nilVertices;
   typedef ShapeIdContainer::index<ShapeIdRecord::ById>::type List;
-  List &list = stow->shapeIds.get<ShapeIdRecord::ById>();
+  List &list = stow->shapeIds().get<ShapeIdRecord::ById>();
   auto rangeItPair = list.equal_range(gu::createNilId());
   for (; rangeItPair.first != rangeItPair.second; ++rangeItPair.first)
   {
@@ -1476,18 +1566,18 @@ void SeerShape::edgeVertexMatch(const SeerShape &source)
 void SeerShape::dumpGraph(const std::string &filePathIn) const
 {
   std::ofstream file(filePathIn.c_str());
-  boost::write_graphviz(file, stow->graph, Node_writer<Graph>(stow->graph, *this), boost::default_writer());
+  boost::write_graphviz(file, stow->graph(), Node_writer<Graph>(stow->graph(), *this), boost::default_writer());
 }
 
 void SeerShape::dumpReverseGraph(const std::string &filePathIn) const
 {
   std::ofstream file(filePathIn.c_str());
-  boost::write_graphviz(file, stow->rGraph, Node_writer<Graph>(stow->rGraph, *this), boost::default_writer());
+  boost::write_graphviz(file, stow->rGraph(), Node_writer<Graph>(stow->rGraph(), *this), boost::default_writer());
 }
 
 void SeerShape::dumpShapeIdContainer(std::ostream &streamIn) const
 {
-  streamIn << stow->shapeIds << std::endl;
+  streamIn << stow->shapeIds() << std::endl;
 }
 
 void SeerShape::dumpEvolveContainer(std::ostream &streamIn) const
@@ -1581,18 +1671,28 @@ void SeerShape::serialIn(const prj::srl::spt::SeerShape &ssIn)
   //note: shape has already been set through setOCCTShape, so shapeIdContainer has been populated, so don't clear.
   //setOCCTShape assigns an id for the root, so that is valid.
   
-  //fill in shapeId container.
-  occt::ShapeVector shapes = occt::mapShapes(getRootOCCTShape());
-  for (const auto &sRRecord : ssIn.shapeIdContainer())
+  if (isPending())
+  {
+    //shape not read yet. ids go in when it is.
+    stow->pendingIds.clear();
+    for (const auto &sRRecord : ssIn.shapeIdContainer())
+      stow->pendingIds.emplace_back(sRRecord.shapeOffset(), gu::stringToId(sRRecord.id()));
+  }
+  else
   {
-    std::size_t offset = sRRecord.shapeOffset();
-    assert(offset < shapes.size());
-    if (offset >= shapes.size())
+    //fill in shapeId container.
+    occt::ShapeVector shapes = occt::mapShapes(getRootOCCTShape());
+    for (const auto &sRRecord : ssIn.shapeIdContainer())
     {
-      std::cerr << "WARNING: invalid shape offset in SeerShape::serialIn" << std::endl;
-      continue;
+      std::size_t offset = sRRecord.shapeOffset();
+      assert(offset < shapes.size());
+      if (offset >= shapes.size())
+      {
+        std::cerr << "WARNING: invalid shape offset in SeerShape::serialIn" << std::endl;
+        continue;
+      }
+      updateId(shapes.at(sRRecord.shapeOffset()), gu::stringToId(sRRecord.id()));
     }
-    updateId(shapes.at(sRRecord.shapeOffset()), gu::stringToId(sRRecord.id()));
   }
   
   stow->evolves.get<EvolveRecord::ByInId>().clear();
@@ -1654,6 +1754,7 @@ ShapeIdHelper SeerShape::buildHelper() const
   //that is the order the external viz generation will use.
   ShapeIdHelper out;
   occt::ShapeVector shapes = occt::mapShapes(getRootOCCTShape());
+  out.reserve(shapes.size());
   for (const auto &shape : shapes)
   {
     uuid id = findId(shape);
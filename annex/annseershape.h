@@ -21,6 +21,7 @@
 #define ANN_SEERSHAPE_H
 
 #include <memory>
+#include <functional>
 
 #include <boost/uuid/uuid.hpp>
 
@@ -77,6 +78,8 @@ namespace ann
     Type getType() override {return Type::SeerShape;}
     
     void setOCCTShape(const TopoDS_Shape& shapeIn, const boost::uuids::uuid &idIn);
+    void setOCCTShape(const std::function<TopoDS_Shape ()>&, const boost::uuids::uuid &idIn); //!< shape is read on first use.
+    bool isPending() const; //!< shape set with a reader hasn't been read yet.
     void reset(); //!< clears data and this isNull() == true;
     
     const TopoDS_Shape& getRootOCCTShape() const;
@@ -243,7 +246,8 @@ namespace ann
     std::unique_ptr<ShapeStow> stow;
     BID::uuid rootShapeId;
     
-    void updateGraphs();
+    TopoDS_Shape buildShapeData(const TopoDS_Shape&, const boost::uuids::uuid&);
+    void updateGraphs(const TopoDS_Shape&);
   };
 }
 
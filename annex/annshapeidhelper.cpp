@@ -30,39 +30,47 @@ using boost::uuids::uuid;
 
 void ShapeIdHelper::add(const uuid &idIn, const TopoDS_Shape &shapeIn)
 {
+  std::size_t index = ids.size();
   ids.push_back(idIn);
   shapes.push_back(shapeIn);
+  shapeIndex.emplace(shapeIn, index);
+  idIndex.emplace(idIn, index);
+}
+
+void ShapeIdHelper::reserve(std::size_t count)
+{
+  ids.reserve(count);
+  shapes.reserve(count);
+  shapeIndex.reserve(count);
+  idIndex.reserve(count);
 }
 
 optional<uuid> ShapeIdHelper::find(const TopoDS_Shape &shapeIn) const
 {
   assert(ids.size() == shapes.size());
-  for (auto it = shapes.begin(); it != shapes.end(); ++it)
+  auto it = shapeIndex.find(shapeIn);
+  if (it == shapeIndex.end())
   {
-    if (shapeIn.IsEqual(*it))
-    {
-      std::size_t index = std::distance(shapes.begin(), it);
-      assert(index < shapes.size());
-      return ids.at(index);
-    }
+    //used by external lod generator, so can't use std::cout.
+//     std::cout << "Warning: no id for shape in ShapeIdHelper::find" << std::endl;
+    return boost::none;
   }
-  //used by external lod generator, so can't use std::cout.
-//   std::cout << "Warning: no id for shape in ShapeIdHelper::find" << std::endl;
-  return boost::none;
+  assert(it->second < ids.size());
+  return ids.at(it->second);
 }
 
 optional<const TopoDS_Shape&> ShapeIdHelper::find(const uuid &idIn) const
 {
   assert(ids.size() == shapes.size());
-  auto it = std::find(ids.begin(), ids.end(), idIn);
-  if (it == ids.end())
+  auto it = idIndex.find(idIn);
+  if (it == idIndex.end())
   {
     //used by external lod generator, so can't use std::cout.
 //     std::cout << "Warning: no shape for id in ShapeIdHelper::find" << std::endl;
     return boost::none;
   }
-  std::size_t index = std::distance(ids.begin(), it);
-  return shapes.at(index);
+  assert(it->second < shapes.size());
+  return shapes.at(it->second);
 }
 
 std::ostream& ann::operator<<(std::ostream &stream, const ShapeIdHelper &helperIn)
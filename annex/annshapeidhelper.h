@@ -21,9 +21,11 @@
 #define ANN_SHAPEIDHELPER_H
 
 #include <vector>
+#include <unordered_map>
 
 #include <boost/optional.hpp>
 #include <boost/uuid/uuid.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "tools/occtools.h"
 
@@ -36,6 +38,8 @@ namespace ann
   * 
   * This is lightweight matching used for osg viz
   * generation for both internal and external programs.
+  * Both finds are hashed. Shapes match with TopoDS_Shape::IsEqual,
+  * so location and orientation matter.
   */
   class ShapeIdHelper
   {
@@ -45,12 +49,34 @@ namespace ann
     boost::optional<const TopoDS_Shape&> find(const boost::uuids::uuid&) const;
     void write(const boost::filesystem::path&);
     static std::vector<boost::uuids::uuid> read(const boost::filesystem::path&);
+    const std::vector<boost::uuids::uuid>& getIds() const {return ids;}
+    void reserve(std::size_t);
   private:
     //@{
     //! parallel vectors. matches at offsets.
     std::vector<boost::uuids::uuid> ids;
     occt::ShapeVector shapes;
     //@}
+    
+    struct ShapeHash
+    {
+      std::size_t operator()(const TopoDS_Shape &shape) const
+      {
+        return static_cast<std::size_t>(occt::getShapeHash(shape));
+      }
+    };
+    struct ShapeEqual
+    {
+      bool operator()(const TopoDS_Shape &shape1, const TopoDS_Shape &shape2) const
+      {
+        return shape1.IsEqual(shape2);
+      }
+    };
+    //@{
+    //! offsets into the parallel vectors. first add wins on duplicates, like the old linear search.
+    std::unordered_map<TopoDS_Shape, std::size_t, ShapeHash, ShapeEqual> shapeIndex;
+    std::unordered_map<boost::uuids::uuid, std::size_t, boost::hash<boost::uuids::uuid>> idIndex;
+    //@}
     friend std::ostream& operator<<(std::ostream&, const ShapeIdHelper&);
   };
   
@@ -20,6 +20,13 @@
 #include <cassert>
 #include <functional>
 #include <cstddef> //null error from nglib
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+#include <boost/iostreams/device/mapped_file.hpp>
 
 #include <osg/Matrixd>
 
@@ -40,6 +47,21 @@
 
 using namespace ann;
 
+namespace
+{
+  //! layout of SurfaceMesh binary file header. no padding.
+  struct BinaryHeader
+  {
+    char magic[8] = {'C', 'S', 'M', 'E', 'S', 'H', 'B', 'N'};
+    std::uint32_t version = 1;
+    std::uint32_t reserved = 0;
+    std::uint64_t vertexCount = 0; //!< followed by vertexCount * 3 doubles.
+    std::uint64_t faceCount = 0; //!< followed by faceCount uint32 vertex counts.
+    std::uint64_t indexCount = 0; //!< followed by indexCount uint32 vertex indexes.
+  };
+  static_assert(sizeof(BinaryHeader) == 40, "unexpected padding in BinaryHeader");
+}
+
 SurfaceMesh::SurfaceMesh() : Base(), stow(new msh::srf::Stow()) {}
 
 SurfaceMesh::SurfaceMesh(const msh::srf::Stow &stowIn)
@@ -211,8 +233,172 @@ void SurfaceMesh::transform(const osg::Matrixd &mIn)
   }
 }
 
-prj::srl::mshs::Surface SurfaceMesh::serialOut()
+/*! @brief Write mesh to binary file.
+ * 
+ * @param file to write. overwritten if exists.
+ * @return success state of operation.
+ * @details Header followed by flat buffers so reading
+ * can map the file and copy straight out of it.
+ * Native byte order.
+ * @see BinaryHeader
+ */
+bool SurfaceMesh::writeBinary(const boost::filesystem::path &file) const
 {
+  msh::srf::Mesh m = stow->mesh;
+  m.collect_garbage(); //vertex index is now offset.
+  
+  std::vector<double> points;
+  points.reserve(m.number_of_vertices() * 3);
+  for (const msh::srf::Vertex &v : m.vertices())
+  {
+    const msh::srf::Point &p = m.point(v);
+    points.push_back(p.x());
+    points.push_back(p.y());
+    points.push_back(p.z());
+  }
+  
+  std::vector<std::uint32_t> faceSizes;
+  std::vector<std::uint32_t> indexes;
+  faceSizes.reserve(m.number_of_faces());
+  indexes.reserve(m.number_of_faces() * 3);
+  for (const msh::srf::Face &f : m.faces())
+  {
+    std::uint32_t size = 0;
+    for(const msh::srf::Vertex &vd : vertices_around_face(m.halfedge(f), m))
+    {
+      indexes.push_back(static_cast<std::uint32_t>(vd));
+      size++;
+    }
+    faceSizes.push_back(size);
+  }
+  
+  BinaryHeader header;
+  header.vertexCount = m.number_of_vertices();
+  header.faceCount = faceSizes.size();
+  header.indexCount = indexes.size();
+  
+  std::ofstream stream(file.string(), std::ios_base::out | std::ios_base::trunc | std::ios_base::binary);
+  if (!stream.is_open())
+    return false;
+  stream.write(reinterpret_cast<const char*>(&header), sizeof(BinaryHeader));
+  stream.write(reinterpret_cast<const char*>(points.data()), points.size() * sizeof(double));
+  stream.write(reinterpret_cast<const char*>(faceSizes.data()), faceSizes.size() * sizeof(std::uint32_t));
+  stream.write(reinterpret_cast<const char*>(indexes.data()), indexes.size() * sizeof(std::uint32_t));
+  return stream.good();
+}
+
+/*! @brief Add a mesh from a binary file.
+ * 
+ * @param file binary file from writeBinary.
+ * @return success state of operation.
+ * @note does not clear any existing mesh data
+ */
+bool SurfaceMesh::readBinary(const boost::filesystem::path &file)
+{
+  if (!boost::filesystem::exists(file))
+    return false;
+  boost::iostreams::mapped_file_source mapped;
+  try
+  {
+    mapped.open(file.string());
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "WARNING: couldn't map file in SurfaceMesh::readBinary: " << e.what() << std::endl;
+    return false;
+  }
+  if (!mapped.is_open() || mapped.size() < sizeof(BinaryHeader))
+    return false;
+  
+  BinaryHeader header;
+  std::memcpy(&header, mapped.data(), sizeof(BinaryHeader));
+  if
+  (
+    std::memcmp(header.magic, BinaryHeader().magic, sizeof(header.magic)) != 0
+    || header.version != BinaryHeader().version
+  )
+    return false;
+  //bound the counts by the file size so the products below can't overflow.
+  std::size_t body = mapped.size() - sizeof(BinaryHeader);
+  if
+  (
+    header.vertexCount > body / (3 * sizeof(double))
+    || header.faceCount > body / sizeof(std::uint32_t)
+    || header.indexCount > body / sizeof(std::uint32_t)
+  )
+    return false;
+  std::size_t expected = sizeof(BinaryHeader)
+    + header.vertexCount * 3 * sizeof(double)
+    + (header.faceCount + header.indexCount) * sizeof(std::uint32_t);
+  if (mapped.size() != expected)
+    return false;
+  
+  //copy out of map. map has no alignment guarantee past header.
+  const char *cursor = mapped.data() + sizeof(BinaryHeader);
+  auto readValue = [&](auto &value)
+  {
+    std::memcpy(&value, cursor, sizeof(value));
+    cursor += sizeof(value);
+  };
+  
+  msh::srf::Mesh &m = stow->mesh;
+  std::size_t offset = m.number_of_vertices();
+  m.reserve(offset + header.vertexCount, m.number_of_edges() + header.indexCount / 2, m.number_of_faces() + header.faceCount);
+  for (std::uint64_t index = 0; index < header.vertexCount; ++index)
+  {
+    double x, y, z;
+    readValue(x);
+    readValue(y);
+    readValue(z);
+    m.add_vertex(msh::srf::Point(x, y, z));
+  }
+  
+  //face sizes must add up to indexCount or indexCursor walks off the map.
+  const char *indexCursor = cursor + header.faceCount * sizeof(std::uint32_t);
+  std::uint64_t remaining = header.indexCount;
+  msh::srf::Vertices vertices;
+  for (std::uint64_t face = 0; face < header.faceCount; ++face)
+  {
+    std::uint32_t size;
+    readValue(size);
+    if (size > remaining)
+      return false;
+    remaining -= size;
+    vertices.clear();
+    for (std::uint32_t index = 0; index < size; ++index)
+    {
+      std::uint32_t vi;
+      std::memcpy(&vi, indexCursor, sizeof(vi));
+      indexCursor += sizeof(vi);
+      if (vi >= header.vertexCount)
+        return false;
+      vertices.push_back(static_cast<msh::srf::Vertex>(vi + offset));
+    }
+    m.add_face(vertices);
+  }
+  if (remaining != 0)
+    return false;
+  
+  return true;
+}
+
+/*! @brief Serialize mesh.
+ * 
+ * @param file path for binary mesh data. Should be in project directory.
+ * @return serial object only referencing binary file by name.
+ * @details Inline xml points and faces were too big and too slow for
+ * large meshes. If binary write fails, we fall back to inline.
+ */
+prj::srl::mshs::Surface SurfaceMesh::serialOut(const boost::filesystem::path &file)
+{
+  prj::srl::mshs::Surface out;
+  if (writeBinary(file))
+  {
+    out.binary() = file.filename().string();
+    return out;
+  }
+  std::cout << "WARNING: couldn't write binary mesh file in SurfaceMesh::serialOut" << std::endl;
+  
   msh::srf::Mesh m = stow->mesh;
   m.collect_garbage();
   
@@ -222,7 +408,6 @@ prj::srl::mshs::Surface SurfaceMesh::serialOut()
     return prj::srl::spt::Vec3d(p.x(), p.y(), p.z());
   };
   
-  prj::srl::mshs::Surface out;
   for (const msh::srf::Vertex &v : m.vertices())
     out.points().push_back(convertOut(v));
   
@@ -237,10 +422,25 @@ prj::srl::mshs::Surface SurfaceMesh::serialOut()
   return out;
 }
 
-void SurfaceMesh::serialIn(const prj::srl::mshs::Surface &smIn)
+/*! @brief Restore mesh.
+ * 
+ * @param smIn serial object.
+ * @param directory to find binary file referenced by smIn.
+ * @details Older projects have inline points and faces. They
+ * will be converted to binary on next save.
+ */
+void SurfaceMesh::serialIn(const prj::srl::mshs::Surface &smIn, const boost::filesystem::path &directory)
 {
   msh::srf::Mesh &m = stow->mesh;
   
+  if (smIn.binary())
+  {
+    if (readBinary(directory / smIn.binary().get()))
+      return;
+    std::cout << "WARNING: couldn't read binary mesh file in SurfaceMesh::serialIn" << std::endl;
+    m.clear();
+  }
+  
   for (const auto &pIn : smIn.points())
     m.add_vertex(msh::srf::Point(pIn.x(), pIn.y(), pIn.z()));
   
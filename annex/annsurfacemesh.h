@@ -62,6 +62,8 @@ namespace ann
     bool writePLY(const boost::filesystem::path&) const;
     bool readSTL(const boost::filesystem::path&);
     bool writeSTL(const boost::filesystem::path&) const;
+    bool readBinary(const boost::filesystem::path&);
+    bool writeBinary(const boost::filesystem::path&) const;
     
     void remeshCGAL(double, int);
     void remeshPMPUniform(double, int);
@@ -71,8 +73,8 @@ namespace ann
     
     void transform(const osg::Matrixd&);
     
-    prj::srl::mshs::Surface serialOut();
-    void serialIn(const prj::srl::mshs::Surface&);
+    prj::srl::mshs::Surface serialOut(const boost::filesystem::path&);
+    void serialIn(const prj::srl::mshs::Surface&, const boost::filesystem::path&);
   private:
     std::unique_ptr<msh::srf::Stow> stow;
   };
@@ -44,6 +44,7 @@
 #include "menu/mnumanager.h"
 #include "command/cmdmanager.h"
 #include "lod/lodmanager.h"
+#include "feature/ftrshapecheck.h"
 #include "dialogs/dlgproject.h"
 #include "dialogs/dlgabout.h"
 
@@ -54,8 +55,9 @@
 
 using namespace app;
 
-Application::Application(int &argc, char **argv) :
+Application::Application(int &argc, char **argv, bool headlessIn) :
   QApplication(argc, argv)
+  , headless(headlessIn)
 {
     qRegisterMetaType<msg::Message>("msg::Message");
     
@@ -75,17 +77,26 @@ Application::Application(int &argc, char **argv) :
     //some day pass the preferences file from user home directory to the manager constructor.
     if (!prf::manager().isOk())
     {
-      QMessageBox::critical(0, tr("CadSeer"), tr("Preferences failed to load"));
+      if (headless)
+        std::cout << "ERROR: Preferences failed to load" << std::endl;
+      else
+        QMessageBox::critical(0, tr("CadSeer"), tr("Preferences failed to load"));
       QTimer::singleShot(0, this, SLOT(quit()));
       return;
     }
     
-    //menu manager has to be done after preferences
-    mnu::manager().loadMenu(prf::manager().getMenuConfigPath());
-    
-    mainWindow = std::make_unique<MainWindow>();
+    if (prf::manager().rootPtr->project().deferShapeChecks().get())
+      ftr::ShapeCheck::setMode(ftr::ShapeCheck::Mode::Deferred);
     
-    cmd::manager(); //just to construct the singleton and get it ready for messages.
+    if (!headless)
+    {
+      //menu manager has to be done after preferences
+      mnu::manager().loadMenu(prf::manager().getMenuConfigPath());
+      
+      mainWindow = std::make_unique<MainWindow>();
+      
+      cmd::manager(); //just to construct the singleton and get it ready for messages.
+    }
     
     lodManager = std::make_unique<lod::Manager>(arguments().at(0).toStdString());
     
@@ -328,7 +339,8 @@ void Application::openProject(const std::string &directoryIn)
   postMessage.mask = msg::Response | msg::Post | msg::Open | msg::Project;
   node->send(postMessage);
   
-  node->sendBlocked(msg::Message(msg::Request | msg::Project | msg::Update | msg::Visual));
+  if (!headless)
+    node->sendBlocked(msg::Message(msg::Request | msg::Project | msg::Update | msg::Visual));
 }
 
 void Application::closeProject()
@@ -352,7 +364,7 @@ void Application::closeProject()
 
 void Application::updateTitle()
 {
-  if (!project)
+  if (!project || !mainWindow)
     return;
   boost::filesystem::path path = project->getSaveDirectory();
   QString title = tr("CadSeer --") + QString::fromStdString(path.rbegin()->string()) + "--";
@@ -398,6 +410,12 @@ void Application::setupDispatcher()
 
 void Application::ProjectDialogRequestDispatched(const msg::Message&)
 {
+  if (project && project->isUpdating())
+  {
+    node->send(msg::buildStatusMessage(tr("Model update running. Escape in viewer cancels").toStdString(), 2.0));
+    return;
+  }
+  
   dlg::Project dialog(this->getMainWindow());
   if (dialog.exec() == QDialog::Accepted)
   {
@@ -417,6 +435,12 @@ void Application::ProjectDialogRequestDispatched(const msg::Message&)
 
 void Application::newProjectRequestDispatched(const msg::Message &messageIn)
 {
+  if (project && project->isUpdating())
+  {
+    node->send(msg::buildStatusMessage(tr("Model update running. Escape in viewer cancels").toStdString(), 2.0));
+    return;
+  }
+  
   prj::Message pMessage = messageIn.getPRJ();
   
   boost::filesystem::path path = pMessage.directory;
@@ -434,6 +458,12 @@ void Application::newProjectRequestDispatched(const msg::Message &messageIn)
 
 void Application::openProjectRequestDispatched(const msg::Message &messageIn)
 {
+  if (project && project->isUpdating())
+  {
+    node->send(msg::buildStatusMessage(tr("Model update running. Escape in viewer cancels").toStdString(), 2.0));
+    return;
+  }
+  
   prj::Message pMessage = messageIn.getPRJ();
   
   boost::filesystem::path path = pMessage.directory;
@@ -451,6 +481,12 @@ void Application::openProjectRequestDispatched(const msg::Message &messageIn)
 
 void Application::closeProjectRequestDispatched(const msg::Message&)
 {
+  if (project && project->isUpdating())
+  {
+    node->send(msg::buildStatusMessage(tr("Model update running. Escape in viewer cancels").toStdString(), 2.0));
+    return;
+  }
+  
   if (project)
     closeProject();
 }
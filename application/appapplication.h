@@ -42,15 +42,19 @@ class Application : public QApplication
 {
     Q_OBJECT
 public:
-    explicit Application(int &argc, char **argv);
+    explicit Application(int &argc, char **argv, bool headlessIn = false); //!< headless has no main window or commands.
     ~Application();
     bool notify(QObject * receiver, QEvent * e) override;
     void initializeSpaceball();
     prj::Project* getProject(){return project.get();}
     MainWindow* getMainWindow(){return mainWindow.get();}
+    lod::Manager* getLODManager(){return lodManager.get();}
+    bool isHeadless() const {return headless;}
     boost::filesystem::path getApplicationDirectory();
     QSettings& getUserSettings();
     void queuedMessage(const msg::Message&); //queue message into qt event loop
+    void openProject(const std::string &);
+    void closeProject();
     
 public Q_SLOTS:
     void quittingSlot();
@@ -63,10 +67,9 @@ private:
     std::unique_ptr<lod::Manager> lodManager;
     bool spaceballPresent = false;
     bool firstRun = false;
+    bool headless = false;
     
     void createNewProject(const std::string &);
-    void openProject(const std::string &);
-    void closeProject();
     void updateTitle();
     
     std::unique_ptr<msg::Node> node;
@@ -42,6 +42,7 @@
 #include "message/msgsift.h"
 #include "commandview/cmvmessage.h"
 #include "application/appincrementwidget.h"
+#include "project/prjproject.h"
 #include "commandview/cmvpane.h"
 #include "preferences/preferencesXML.h"
 #include "preferences/prfmanager.h"
@@ -402,6 +403,15 @@ slc::Manager* MainWindow::getSelectionManager()
 
 void MainWindow::closeEvent (QCloseEvent *event)
 {
+  //project can't go away under a running model update. cancel it and let the user close again.
+  prj::Project *project = app::instance()->getProject();
+  if (project && project->isUpdating())
+  {
+    project->cancelUpdate();
+    event->ignore();
+    return;
+  }
+  
   stow->node.send(msg::Message(msg::Request | msg::Command | msg::Clear));
   QMainWindow::closeEvent(event);
 }
@@ -0,0 +1,347 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* this is a program for regenerating projects without a window.
+ *
+ * batchregen [options] projectDirectory
+ *   --visual          also update visuals.
+ *   --defer-checks    skip shape analysis during update and run a
+ *                     validation pass afterwards.
+ *   --threads N       max threads for model update. 0 = all cores.
+ *   --format csv|json report format. default csv.
+ *   --output file     report file. default standard out.
+ *
+ * Every feature is made dirty and the whole model is updated. An update
+ * rewrites project files, so the project, git repo included, is copied
+ * to a temporary directory and regenerated there. The project directory
+ * is never written. No git commits are made.
+ *
+ * exit codes: 0 success, 1 bad arguments or project, 2 a feature failed
+ * or failed validation.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+#include <boost/filesystem.hpp>
+
+#include <QtGlobal>
+
+#include "application/appapplication.h"
+#include "tools/idtools.h"
+#include "feature/ftrbase.h"
+#include "feature/ftrshapecheck.h"
+#include "project/prjgitmanager.h"
+#include "project/prjupdatejob.h"
+#include "project/prjproject.h"
+
+namespace bfs = boost::filesystem;
+
+namespace
+{
+  struct Options
+  {
+    bfs::path projectDirectory;
+    bfs::path output;
+    std::string format = "csv";
+    std::size_t threads = 0;
+    bool visual = false;
+    bool deferChecks = false;
+  };
+
+  /*! @brief Copy of a project directory, removed on destruction.
+   * 
+   * @details Empty path on failure.
+   */
+  struct Scratch
+  {
+    bfs::path directory;
+    
+    explicit Scratch(const bfs::path &source)
+    {
+      boost::system::error_code ec;
+      bfs::path temp = bfs::temp_directory_path(ec) / bfs::unique_path("batchregen-%%%%-%%%%-%%%%");
+      if (ec || !copy(source, temp))
+      {
+        bfs::remove_all(temp, ec);
+        return;
+      }
+      directory = temp;
+    }
+    ~Scratch()
+    {
+      boost::system::error_code ec;
+      if (!directory.empty())
+        bfs::remove_all(directory, ec);
+    }
+    Scratch(const Scratch&) = delete;
+    Scratch& operator=(const Scratch&) = delete;
+    
+    static bool copy(const bfs::path &source, const bfs::path &destination)
+    {
+      boost::system::error_code ec;
+      bfs::create_directories(destination, ec);
+      if (ec)
+        return false;
+      for (bfs::recursive_directory_iterator it(source, ec), end; it != end && !ec; it.increment(ec))
+      {
+        bfs::path target = destination / bfs::relative(it->path(), source, ec);
+        if (ec)
+          return false;
+        if (bfs::is_directory(it->path()))
+          bfs::create_directories(target, ec);
+        else
+          bfs::copy_file(it->path(), target, ec);
+        if (ec)
+          return false;
+      }
+      return !ec;
+    }
+  };
+
+  void usage()
+  {
+    std::cerr << "usage: batchregen [--visual] [--defer-checks] [--threads N] [--format csv|json] [--output file] projectDirectory" << std::endl;
+  }
+
+  bool parse(int argc, char **argv, Options &options)
+  {
+    for (int index = 1; index < argc; ++index)
+    {
+      std::string arg(argv[index]);
+      bool hasNext = index + 1 < argc;
+      if (arg == "--visual")
+        options.visual = true;
+      else if (arg == "--defer-checks")
+        options.deferChecks = true;
+      else if (arg == "--threads" && hasNext)
+      {
+        try {options.threads = std::stoul(argv[++index]);}
+        catch (const std::exception&) {return false;}
+      }
+      else if (arg == "--format" && hasNext)
+        options.format = argv[++index];
+      else if (arg == "--output" && hasNext)
+        options.output = argv[++index];
+      else if (!arg.empty() && arg.front() != '-' && options.projectDirectory.empty())
+        options.projectDirectory = arg;
+      else
+        return false;
+    }
+    if (options.format != "csv" && options.format != "json")
+      return false;
+    return !options.projectDirectory.empty();
+  }
+
+  std::string csvEscape(const std::string &in)
+  {
+    if (in.find_first_of(",\"\n") == std::string::npos)
+      return in;
+    std::string out = "\"";
+    for (auto c : in)
+    {
+      if (c == '"')
+        out += '"';
+      out += c;
+    }
+    out += '"';
+    return out;
+  }
+
+  std::string jsonEscape(const std::string &in)
+  {
+    std::ostringstream out;
+    for (auto c : in)
+    {
+      switch (c)
+      {
+        case '"': out << "\\\""; break;
+        case '\\': out << "\\\\"; break;
+        case '\n': out << "\\n"; break;
+        case '\t': out << "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20)
+            out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+          else
+            out << c;
+      }
+    }
+    return out.str();
+  }
+
+  struct Row
+  {
+    std::string name;
+    std::string type;
+    std::string id;
+    prj::FeatureTiming timing;
+    bool success;
+    bool valid;
+  };
+
+  void writeCsv(std::ostream &stream, const std::vector<Row> &rows)
+  {
+    stream << "name,type,id,wave,model_ms,visual_ms,success,valid" << std::endl;
+    for (const auto &row : rows)
+    {
+      stream << csvEscape(row.name)
+      << ',' << csvEscape(row.type)
+      << ',' << row.id
+      << ',' << row.timing.wave
+      << ',' << row.timing.modelMilliseconds
+      << ',' << row.timing.visualMilliseconds
+      << ',' << ((row.success) ? "true" : "false")
+      << ',' << ((row.valid) ? "true" : "false")
+      << std::endl;
+    }
+  }
+
+  void writeJson(std::ostream &stream, const std::vector<Row> &rows, const Options &options, double model, double visual, double validate)
+  {
+    stream << "{" << std::endl
+    << "  \"project\": \"" << jsonEscape(options.projectDirectory.string()) << "\"," << std::endl
+    << "  \"threads\": " << options.threads << "," << std::endl
+    << "  \"deferred_checks\": " << ((options.deferChecks) ? "true" : "false") << "," << std::endl
+    << "  \"model_ms\": " << model << "," << std::endl
+    << "  \"visual_ms\": " << visual << "," << std::endl
+    << "  \"validate_ms\": " << validate << "," << std::endl
+    << "  \"features\": [" << std::endl;
+    for (std::size_t index = 0; index < rows.size(); ++index)
+    {
+      const Row &row = rows.at(index);
+      stream << "    {"
+      << "\"name\": \"" << jsonEscape(row.name) << "\""
+      << ", \"type\": \"" << jsonEscape(row.type) << "\""
+      << ", \"id\": \"" << row.id << "\""
+      << ", \"wave\": " << row.timing.wave
+      << ", \"model_ms\": " << row.timing.modelMilliseconds
+      << ", \"visual_ms\": " << row.timing.visualMilliseconds
+      << ", \"success\": " << ((row.success) ? "true" : "false")
+      << ", \"valid\": " << ((row.valid) ? "true" : "false")
+      << "}" << ((index + 1 < rows.size()) ? "," : "") << std::endl;
+    }
+    stream << "  ]" << std::endl << "}" << std::endl;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  Options options;
+  if (!parse(argc, argv, options))
+  {
+    usage();
+    return 1;
+  }
+  if (!bfs::exists(options.projectDirectory / "project.prjt"))
+  {
+    std::cerr << "no project found in: " << options.projectDirectory.string() << std::endl;
+    return 1;
+  }
+
+  Scratch scratch(bfs::canonical(options.projectDirectory));
+  if (scratch.directory.empty())
+  {
+    std::cerr << "failed copying project: " << options.projectDirectory.string() << std::endl;
+    return 1;
+  }
+
+  //features need a gui application for fonts, icons etc. but no display.
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+  app::Application application(argc, argv, true);
+
+  application.openProject(scratch.directory.string());
+  prj::Project *project = application.getProject();
+  if (!project)
+  {
+    std::cerr << "failed opening project: " << options.projectDirectory.string() << std::endl;
+    return 1;
+  }
+  project->getGitManager().disableCommits();
+  project->setUpdateThreadCount(options.threads);
+
+  //command line wins over the preference.
+  ftr::ShapeCheck::setMode((options.deferChecks) ? ftr::ShapeCheck::Mode::Deferred : ftr::ShapeCheck::Mode::Full);
+  
+  project->setAllModelDirty();
+  auto modelStart = std::chrono::steady_clock::now();
+  project->updateModel();
+  std::chrono::duration<double, std::milli> modelTime = std::chrono::steady_clock::now() - modelStart;
+
+  std::chrono::duration<double, std::milli> visualTime(0.0);
+  if (options.visual)
+  {
+    auto visualStart = std::chrono::steady_clock::now();
+    project->updateVisual();
+    visualTime = std::chrono::steady_clock::now() - visualStart;
+  }
+
+  //stats are reset by the next update, so grab them before validation.
+  ftr::ShapeCheck::Stats checkStats = ftr::ShapeCheck::getStats();
+  std::chrono::duration<double, std::milli> validateTime(0.0);
+  std::vector<boost::uuids::uuid> invalids;
+  if (options.deferChecks)
+  {
+    auto validateStart = std::chrono::steady_clock::now();
+    invalids = project->validateShapes();
+    validateTime = std::chrono::steady_clock::now() - validateStart;
+  }
+  
+  bool failed = false;
+  std::vector<Row> rows;
+  for (const auto &timing : project->getTimings())
+  {
+    const ftr::Base *feature = project->findFeature(timing.featureId);
+    bool valid = std::find(invalids.begin(), invalids.end(), timing.featureId) == invalids.end();
+    rows.push_back({feature->getName().toStdString(), feature->getTypeString(), gu::idToString(timing.featureId), timing, feature->isSuccess(), valid});
+    failed = failed || !feature->isSuccess() || !valid;
+  }
+
+  std::ofstream fileStream;
+  if (!options.output.empty())
+  {
+    fileStream.open(options.output.string());
+    if (!fileStream.is_open())
+    {
+      std::cerr << "failed opening output file: " << options.output.string() << std::endl;
+      return 1;
+    }
+  }
+  std::ostream &stream = (fileStream.is_open()) ? static_cast<std::ostream&>(fileStream) : std::cout;
+  stream << std::fixed << std::setprecision(3);
+  if (options.format == "json")
+    writeJson(stream, rows, options, modelTime.count(), visualTime.count(), validateTime.count());
+  else
+    writeCsv(stream, rows);
+
+  std::cerr << "model update: " << modelTime.count() << " ms, visual update: " << visualTime.count() << " ms" << std::endl;
+  std::cerr << "shape checks: " << checkStats.checks << ", deferred: " << checkStats.deferred
+  << ", sub shapes analyzed: " << checkStats.analyzed << ", reused: " << checkStats.cacheHits;
+  if (options.deferChecks)
+    std::cerr << ", validation: " << validateTime.count() << " ms, invalid: " << invalids.size();
+  std::cerr << std::endl;
+
+  application.closeProject();
+  return (failed) ? 2 : 0;
+}
@@ -0,0 +1,181 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* memory and lookup benchmark for the primitive to primitive set map
+ * of mdv::ShapeGeometry. Compares the range table in use with the
+ * per primitive multi_index records it replaced.
+ *
+ * bmkpsetprimitive [primitiveCount] [primitiveSetCount]
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <random>
+#include <chrono>
+
+#include <boost/multi_index_container.hpp>
+#include <boost/multi_index/member.hpp>
+#include <boost/multi_index/ordered_index.hpp>
+
+#include "modelviz/mdvshapegeometryprivate.h"
+
+namespace
+{
+  std::size_t allocated = 0; //!< bytes currently allocated through CountingAllocator.
+
+  template <typename T>
+  struct CountingAllocator
+  {
+    typedef T value_type;
+    CountingAllocator() = default;
+    template <typename U> CountingAllocator(const CountingAllocator<U>&) {}
+    T* allocate(std::size_t count)
+    {
+      allocated += count * sizeof(T);
+      return std::allocator<T>().allocate(count);
+    }
+    void deallocate(T *pointer, std::size_t count)
+    {
+      allocated -= count * sizeof(T);
+      std::allocator<T>().deallocate(pointer, count);
+    }
+    template <typename U> bool operator==(const CountingAllocator<U>&) const {return true;}
+    template <typename U> bool operator!=(const CountingAllocator<U>&) const {return false;}
+  };
+
+  //! the record layout before the range table.
+  struct LegacyRecord
+  {
+    std::size_t primitiveSetIndex = 0;
+    std::size_t primitiveIndex = 0;
+    struct ByPSet{};
+    struct ByPrimitive{};
+  };
+
+  namespace BMI = boost::multi_index;
+  typedef boost::multi_index_container
+  <
+    LegacyRecord,
+    BMI::indexed_by
+    <
+      BMI::ordered_non_unique
+      <
+        BMI::tag<LegacyRecord::ByPSet>,
+        BMI::member<LegacyRecord, std::size_t, &LegacyRecord::primitiveSetIndex>
+      >,
+      BMI::ordered_unique
+      <
+        BMI::tag<LegacyRecord::ByPrimitive>,
+        BMI::member<LegacyRecord, std::size_t, &LegacyRecord::primitiveIndex>
+      >
+    >,
+    CountingAllocator<LegacyRecord>
+  > LegacyContainer;
+
+  typedef std::chrono::duration<double, std::milli> Milliseconds;
+}
+
+int main(int argc, char **argv)
+{
+  std::size_t primitiveCount = 1000000;
+  std::size_t pSetCount = 10000;
+  if (argc > 1)
+    primitiveCount = std::stoul(argv[1]);
+  if (argc > 2)
+    pSetCount = std::stoul(argv[2]);
+  if (pSetCount == 0 || pSetCount > primitiveCount)
+  {
+    std::cerr << "need 0 < primitiveSetCount <= primitiveCount" << std::endl;
+    return 1;
+  }
+
+  //uneven primitive counts per set, like faces of a real body.
+  std::mt19937 generator(42);
+  std::vector<std::size_t> counts(pSetCount, 1);
+  std::uniform_int_distribution<std::size_t> pick(0, pSetCount - 1);
+  for (std::size_t index = pSetCount; index < primitiveCount; ++index)
+    counts[pick(generator)]++;
+
+  std::size_t legacyBytes = 0;
+  LegacyContainer legacy;
+  auto legacyStart = std::chrono::steady_clock::now();
+  std::size_t primitive = 0;
+  for (std::size_t pSet = 0; pSet < pSetCount; ++pSet)
+  {
+    for (std::size_t index = 0; index < counts[pSet]; ++index)
+    {
+      LegacyRecord record;
+      record.primitiveSetIndex = pSet;
+      record.primitiveIndex = primitive++;
+      legacy.insert(record);
+    }
+  }
+  Milliseconds legacyBuild = std::chrono::steady_clock::now() - legacyStart;
+  legacyBytes = allocated;
+
+  mdv::PSetPrimitiveWrapper ranges;
+  auto rangeStart = std::chrono::steady_clock::now();
+  for (std::size_t pSet = 0; pSet < pSetCount; ++pSet)
+    ranges.append(pSet, counts[pSet]);
+  Milliseconds rangeBuild = std::chrono::steady_clock::now() - rangeStart;
+  std::size_t rangeBytes = (ranges.starts.capacity() + ranges.pSets.capacity()) * sizeof(std::size_t);
+
+  //random picks.
+  std::size_t lookupCount = 1000000;
+  std::vector<std::size_t> lookups(lookupCount);
+  std::uniform_int_distribution<std::size_t> pickPrimitive(0, primitiveCount - 1);
+  for (auto &lookup : lookups)
+    lookup = pickPrimitive(generator);
+
+  std::size_t legacySum = 0;
+  const auto &byPrimitive = legacy.get<LegacyRecord::ByPrimitive>();
+  auto legacyLookupStart = std::chrono::steady_clock::now();
+  for (auto lookup : lookups)
+    legacySum += byPrimitive.find(lookup)->primitiveSetIndex;
+  Milliseconds legacyLookup = std::chrono::steady_clock::now() - legacyLookupStart;
+
+  std::size_t rangeSum = 0;
+  auto rangeLookupStart = std::chrono::steady_clock::now();
+  for (auto lookup : lookups)
+    rangeSum += ranges.findPSetFromPrimitive(lookup);
+  Milliseconds rangeLookup = std::chrono::steady_clock::now() - rangeLookupStart;
+
+  if (legacySum != rangeSum)
+  {
+    std::cerr << "lookup mismatch" << std::endl;
+    return 1;
+  }
+
+  //serialized size. legacy wrote 2 size_t per primitive, ranges write 2 uint32 per set.
+  std::size_t legacySerial = primitiveCount * 2 * sizeof(std::size_t);
+  std::size_t rangeSerial = (pSetCount * 2 + 2) * sizeof(std::uint32_t);
+
+  std::cout << std::fixed << std::setprecision(3)
+  << "primitives: " << primitiveCount << "    primitive sets: " << pSetCount << std::endl
+  << std::setw(12) << "" << std::setw(16) << "memory bytes" << std::setw(16) << "osgb bytes"
+  << std::setw(16) << "build ms" << std::setw(16) << "lookup ns" << std::endl
+  << std::setw(12) << "multi_index" << std::setw(16) << legacyBytes << std::setw(16) << legacySerial
+  << std::setw(16) << legacyBuild.count() << std::setw(16) << legacyLookup.count() * 1.0e6 / lookupCount << std::endl
+  << std::setw(12) << "ranges" << std::setw(16) << rangeBytes << std::setw(16) << rangeSerial
+  << std::setw(16) << rangeBuild.count() << std::setw(16) << rangeLookup.count() * 1.0e6 / lookupCount << std::endl
+  << "memory reduction: " << static_cast<double>(legacyBytes) / static_cast<double>(rangeBytes) << "x" << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* lookup benchmark for ann::ShapeIdHelper. Compares the hashed index
+ * in use with the linear search over parallel vectors it replaced.
+ * Lookups follow mdv::ShapeGeometryBuilder: every mapped shape once.
+ *
+ * bmkshapeidhelper [file.brep|file.step ...]
+ *
+ * Without files a generated part is used: a grid of distinct boxes and
+ * located instances of one cylinder, like an imported assembly.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <chrono>
+#include <algorithm>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/algorithm/string/case_conv.hpp>
+
+#include <gp_Trsf.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopoDS_Compound.hxx>
+#include <BRep_Builder.hxx>
+#include <BRepTools.hxx>
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <STEPControl_Reader.hxx>
+
+#include "tools/idtools.h"
+#include "tools/occtools.h"
+#include "annex/annshapeidhelper.h"
+
+namespace
+{
+  typedef std::chrono::duration<double, std::milli> Milliseconds;
+
+  //! the parallel vector search before the hashed index.
+  struct LegacyHelper
+  {
+    std::vector<boost::uuids::uuid> ids;
+    occt::ShapeVector shapes;
+    void add(const boost::uuids::uuid &idIn, const TopoDS_Shape &shapeIn)
+    {
+      ids.push_back(idIn);
+      shapes.push_back(shapeIn);
+    }
+    boost::optional<boost::uuids::uuid> find(const TopoDS_Shape &shapeIn) const
+    {
+      for (std::size_t index = 0; index < shapes.size(); ++index)
+      {
+        if (shapeIn.IsEqual(shapes[index]))
+          return ids[index];
+      }
+      return boost::none;
+    }
+    boost::optional<const TopoDS_Shape&> find(const boost::uuids::uuid &idIn) const
+    {
+      auto it = std::find(ids.begin(), ids.end(), idIn);
+      if (it == ids.end())
+        return boost::none;
+      return shapes.at(std::distance(ids.begin(), it));
+    }
+  };
+
+  TopoDS_Shape generate()
+  {
+    BRep_Builder builder;
+    TopoDS_Compound out;
+    builder.MakeCompound(out);
+    TopoDS_Shape cylinder = BRepPrimAPI_MakeCylinder(2.0, 8.0).Shape();
+    for (int x = 0; x < 20; ++x)
+    {
+      for (int y = 0; y < 20; ++y)
+      {
+        if ((x + y) % 2)
+          builder.Add(out, BRepPrimAPI_MakeBox(gp_Pnt(x * 10.0, y * 10.0, 0.0), 8.0, 8.0, 8.0 + x).Shape());
+        else
+        {
+          gp_Trsf move;
+          move.SetTranslation(gp_Vec(x * 10.0, y * 10.0, 0.0));
+          builder.Add(out, cylinder.Located(TopLoc_Location(move)));
+        }
+      }
+    }
+    return out;
+  }
+
+  TopoDS_Shape read(const boost::filesystem::path &path)
+  {
+    std::string extension = boost::algorithm::to_lower_copy(path.extension().string());
+    if (extension == ".step" || extension == ".stp")
+    {
+      STEPControl_Reader reader;
+      if (reader.ReadFile(path.string().c_str()) != IFSelect_RetDone)
+        return TopoDS_Shape();
+      reader.TransferRoots();
+      return reader.OneShape();
+    }
+    TopoDS_Shape out;
+    BRep_Builder junk;
+    std::ifstream file(path.string());
+    BRepTools::Read(out, file, junk);
+    return out;
+  }
+
+  bool run(const std::string &name, const TopoDS_Shape &shape)
+  {
+    //same order as SeerShape::buildHelper.
+    occt::ShapeVector shapes = occt::mapShapes(shape);
+    std::vector<boost::uuids::uuid> ids;
+    for (std::size_t index = 0; index < shapes.size(); ++index)
+      ids.push_back(gu::createRandomId());
+
+    LegacyHelper legacy;
+    auto legacyStart = std::chrono::steady_clock::now();
+    for (std::size_t index = 0; index < shapes.size(); ++index)
+      legacy.add(ids[index], shapes[index]);
+    Milliseconds legacyBuild = std::chrono::steady_clock::now() - legacyStart;
+
+    ann::ShapeIdHelper hashed;
+    auto hashedStart = std::chrono::steady_clock::now();
+    hashed.reserve(shapes.size());
+    for (std::size_t index = 0; index < shapes.size(); ++index)
+      hashed.add(ids[index], shapes[index]);
+    Milliseconds hashedBuild = std::chrono::steady_clock::now() - hashedStart;
+
+    std::size_t legacyHits = 0;
+    auto legacyShapeStart = std::chrono::steady_clock::now();
+    for (const auto &s : shapes)
+      legacyHits += (legacy.find(s) ? 1 : 0);
+    Milliseconds legacyShape = std::chrono::steady_clock::now() - legacyShapeStart;
+
+    auto legacyIdStart = std::chrono::steady_clock::now();
+    for (const auto &id : ids)
+      legacyHits += (legacy.find(id) ? 1 : 0);
+    Milliseconds legacyId = std::chrono::steady_clock::now() - legacyIdStart;
+
+    std::size_t hashedHits = 0;
+    bool mismatch = false;
+    auto hashedShapeStart = std::chrono::steady_clock::now();
+    for (const auto &s : shapes)
+      hashedHits += (hashed.find(s) ? 1 : 0);
+    Milliseconds hashedShape = std::chrono::steady_clock::now() - hashedShapeStart;
+
+    auto hashedIdStart = std::chrono::steady_clock::now();
+    for (const auto &id : ids)
+      hashedHits += (hashed.find(id) ? 1 : 0);
+    Milliseconds hashedId = std::chrono::steady_clock::now() - hashedIdStart;
+
+    for (const auto &s : shapes)
+      mismatch = mismatch || (*legacy.find(s) != *hashed.find(s));
+
+    if (legacyHits != hashedHits || mismatch)
+    {
+      std::cerr << name << ": lookup mismatch" << std::endl;
+      return false;
+    }
+
+    auto perLookup = [&](const Milliseconds &m) -> double
+    {
+      return (shapes.empty()) ? 0.0 : m.count() * 1.0e6 / static_cast<double>(shapes.size());
+    };
+
+    std::cout << std::fixed << std::setprecision(3)
+    << name << "    shapes: " << shapes.size() << std::endl
+    << std::setw(12) << "" << std::setw(16) << "build ms" << std::setw(16) << "shape find ns"
+    << std::setw(16) << "id find ns" << std::endl
+    << std::setw(12) << "linear" << std::setw(16) << legacyBuild.count()
+    << std::setw(16) << perLookup(legacyShape) << std::setw(16) << perLookup(legacyId) << std::endl
+    << std::setw(12) << "hashed" << std::setw(16) << hashedBuild.count()
+    << std::setw(16) << perLookup(hashedShape) << std::setw(16) << perLookup(hashedId) << std::endl
+    << "shape find speedup: " << legacyShape.count() / std::max(hashedShape.count(), 1.0e-6) << "x" << std::endl
+    << std::endl;
+
+    return true;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  bool success = true;
+  if (argc < 2)
+    success = run("generated", generate());
+  for (int index = 1; index < argc; ++index)
+  {
+    boost::filesystem::path path(argv[index]);
+    TopoDS_Shape shape = read(path);
+    if (shape.IsNull())
+    {
+      std::cerr << "failed reading: " << path.string() << std::endl;
+      success = false;
+      continue;
+    }
+    success = run(path.filename().string(), shape) && success;
+  }
+
+  return (success) ? 0 : 1;
+}
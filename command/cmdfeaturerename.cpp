@@ -28,6 +28,7 @@
 #include "message/msgsift.h"
 #include "selection/slceventhandler.h"
 #include "project/prjproject.h"
+#include "project/prjgitmanager.h"
 #include "feature/ftrmessage.h"
 #include "feature/ftrbase.h"
 #include "command/cmdfeaturerename.h"
@@ -127,6 +128,7 @@ void FeatureRename::goRename()
   //serialize it. Here we force a serialization so rename is in sync
   //with git, but doesn't trigger an unneeded update.
   feature->serialWrite(project->getSaveDirectory());
+  project->getGitManager().touchFeature(feature->getId());
   
   std::ostringstream gitStream;
   gitStream << "Rename feature id: " << gu::idToShortString(feature->getId())
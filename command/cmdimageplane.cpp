@@ -26,6 +26,7 @@
 #include "application/appmainwindow.h"
 #include "application/appapplication.h"
 #include "project/prjproject.h"
+#include "project/prjgitmanager.h"
 #include "viewer/vwrwidget.h"
 #include "message/msgnode.h"
 #include "feature/ftrimageplane.h"
@@ -83,6 +84,7 @@ void ImagePlane::go()
     try
     {
       boost::filesystem::copy_file(source, copy, boost::filesystem::copy_option::overwrite_if_exists);
+      app::instance()->getProject()->getGitManager().touch(source.filename().string());
     }
     catch (const boost::filesystem::filesystem_error &e)
     {
@@ -32,6 +32,8 @@
 // #include "annex/annseershape.h"
 // #include "feature/ftrinputtype.h"
 #include "application/appmessage.h"
+#include "application/appapplication.h"
+#include "lod/lodmanager.h"
 #include "annex/annseershape.h"
 #include "feature/ftrbase.h"
 #include "command/cmdinfo.h"
@@ -103,6 +105,7 @@ void Info::go()
     //TODO get git hash for application version.
     project->getInfo(stream);
     viewer->getInfo(stream);
+    app::instance()->getLODManager()->getInfo(stream);
   }
   else
   {
@@ -87,6 +87,7 @@ struct ParameterEdit::Stow
     , std::bind(&Stow::activeChanged, this)
   )
   {
+    pObserver.setDeferrable();
     parameter->connect(pObserver);
     QTimer::singleShot(0, [this](){constantChanged();});
     QTimer::singleShot(0, [this](){activeChanged();});
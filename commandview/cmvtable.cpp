@@ -341,6 +341,7 @@ struct Model::Stow
     observer.valueHandler = std::bind(&Stow::valueChanged, this);
     observer.constantHandler = std::bind(&Stow::constantChanged, this);
     observer.activeHandler = std::bind(&Stow::activeChanged, this);
+    observer.setDeferrable(); //features change parameters during threaded updates.
     
     for (auto *p : parameters)
     {
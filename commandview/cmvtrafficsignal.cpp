@@ -86,6 +86,7 @@ struct Signal::Stow
     {
       pObserver.constantHandler = std::bind(&Stow::constantChanged, this);
       pObserver.activeHandler = std::bind(&Stow::activeChanged, this);
+      pObserver.setDeferrable();
       parameter->connect(pObserver);
       
       unlinkAction = new QAction(tr("unlink"), parent);
@@ -19,6 +19,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <cmath>
 
 #include <boost/graph/topological_sort.hpp>
 
@@ -238,7 +239,8 @@ void Model::featureAddedDispatched(const msg::Message &messageIn)
   stow->graph[virginVertex].textShared->setText(message.feature->getName());
   stow->graph[virginVertex].textShared->setFont(this->font());
   
-  addItemsToScene(stow->getAllSceneItems(virginVertex));
+  //items go into the scene when the row is laid out near the viewport.
+  layoutDirty = true;
   this->invalidate(); //temp.
 }
 
@@ -249,11 +251,13 @@ void Model::featureRemovedDispatched(const msg::Message &messageIn)
   Vertex vertex = stow->findVertex(message.feature->getId());
   if (vertex == NullVertex())
     return;
-  removeItemsFromScene(stow->getAllSceneItems(vertex));
+  detachRow(vertex);
   //connections should already removed
   assert(boost::in_degree(vertex, stow->graph) == 0);
   assert(boost::out_degree(vertex, stow->graph) == 0);
   stow->graph[vertex].alive = false;
+  stow->graph[vertex].laidIndex = NullRow();
+  layoutDirty = true;
 }
 
 
@@ -288,9 +292,7 @@ void Model::connectionAddedDispatched(const msg::Message &messageIn)
   path.moveTo(0.0, 0.0);
   path.lineTo(0.0, 1.0);
   stow->graph[edge].connector->setPath(path);
-  
-  if (!stow->graph[edge].connector->scene())
-    this->addItem(stow->graph[edge].connector.get());
+  layoutDirty = true;
 }
 
 void Model::connectionRemovedDispatched(const msg::Message &messageIn)
@@ -313,6 +315,7 @@ void Model::connectionRemovedDispatched(const msg::Message &messageIn)
   if (stow->graph[edge].connector->scene())
     this->removeItem(stow->graph[edge].connector.get());
   boost::remove_edge(edge, stow->graph);
+  layoutDirty = true;
 }
 
 void Model::setupDispatcher()
@@ -403,7 +406,7 @@ void Model::setupDispatcher()
       , std::make_pair
       (
         msg::Request | msg::DAG | msg::View | msg::Update
-      , std::bind(&Model::projectUpdatedDispatched, this, std::placeholders::_1)
+      , std::bind(&Model::dagViewUpdateDispatched, this, std::placeholders::_1)
       )
       , std::make_pair
       (
@@ -492,20 +495,9 @@ void Model::stateUpdate(Vertex vIn)
   else
     stow->graph[vIn].stateIconShared->setPixmap(passPixmap);
 
-  if (cState.test(ftr::StateOffset::NonLeaf) && (!cState.test(ftr::StateOffset::Editing)))
-  {
-    if (stow->graph[vIn].visibleIconShared->scene())
-      removeItem(stow->graph[vIn].visibleIconShared.get());
-    if (stow->graph[vIn].selectableIconShared->scene())
-      removeItem(stow->graph[vIn].selectableIconShared.get());
-  }
-  else
-  {
-    if (!stow->graph[vIn].visibleIconShared->scene())
-      addItem(stow->graph[vIn].visibleIconShared.get());
-    if (!stow->graph[vIn].selectableIconShared->scene())
-      addItem(stow->graph[vIn].selectableIconShared.get());
-  }
+  //detached rows get their icons sorted out by attachRow.
+  if (stow->graph[vIn].attached)
+    updateLeafIcons(vIn);
   
   //set tool tip to current state.
   QString ts = tr("True");
@@ -531,6 +523,26 @@ void Model::stateUpdate(Vertex vIn)
   stow->graph[vIn].stateIconShared->setToolTip(toolTip);
 }
 
+//! visible and selectable icons are only shown for leaf features and the feature being edited.
+void Model::updateLeafIcons(Vertex vIn)
+{
+  ftr::State cState = stow->graph[vIn].state;
+  if (cState.test(ftr::StateOffset::NonLeaf) && (!cState.test(ftr::StateOffset::Editing)))
+  {
+    if (stow->graph[vIn].visibleIconShared->scene())
+      removeItem(stow->graph[vIn].visibleIconShared.get());
+    if (stow->graph[vIn].selectableIconShared->scene())
+      removeItem(stow->graph[vIn].selectableIconShared.get());
+  }
+  else
+  {
+    if (!stow->graph[vIn].visibleIconShared->scene())
+      addItem(stow->graph[vIn].visibleIconShared.get());
+    if (!stow->graph[vIn].selectableIconShared->scene())
+      addItem(stow->graph[vIn].selectableIconShared.get());
+  }
+}
+
 void Model::featureRenamedDispatched(const msg::Message &messageIn)
 {
   ftr::Message fMessage = messageIn.getFTR();
@@ -538,6 +550,13 @@ void Model::featureRenamedDispatched(const msg::Message &messageIn)
   if (vertex == NullVertex())
     return;
   stow->graph[vertex].textShared->setText(fMessage.string);
+  
+  //text width can change the background rects.
+  if (stow->graph[vertex].laidIndex != NullRow())
+  {
+    layoutDirty = true;
+    layout(false);
+  }
 }
 
 void Model::preselectionAdditionDispatched(const msg::Message &messageIn)
@@ -618,11 +637,34 @@ void Model::closeProjectDispatched(const msg::Message&)
 {
   removeAllItems();
   stow->graph.clear();
+  rows.clear();
+  layoutDirty = true;
   invalidate();
 }
 
 void Model::projectUpdatedDispatched(const msg::Message &)
 {
+  //state changes come through stateUpdate. only structure changes need a layout.
+  layout(false);
+}
+
+void Model::dagViewUpdateDispatched(const msg::Message &)
+{
+  layout(true);
+}
+
+/*! @brief Position rows and connectors.
+ * 
+ * @param force reposition every row. Otherwise nothing happens unless
+ * vertices or connections changed and then only rows that moved are touched.
+ * @details Items are only in the scene for rows near the viewport. @see updateAttached
+ */
+void Model::layout(bool force)
+{
+  if (!force && !layoutDirty)
+    return;
+  layoutDirty = false;
+  
   //create a filtered graph on what is alive and visible.
   std::vector<Vertex> filterVertices;
   for (auto its = boost::vertices(stow->graph); its.first != its.second; ++its.first)
@@ -638,45 +680,67 @@ void Model::projectUpdatedDispatched(const msg::Message &)
   boost::topological_sort(filteredGraph, std::back_inserter(sorted));
   std::reverse(sorted.begin(), sorted.end()); //topo sort is reversed.
   
+  //take out rows that are no longer laid out.
+  std::vector<bool> inSorted(boost::num_vertices(stow->graph), false);
+  for (auto v : sorted)
+    inSorted[v] = true;
+  for (auto v : rows)
+  {
+    if (v < inSorted.size() && !inSorted[v])
+    {
+      detachRow(v);
+      stow->graph[v].laidIndex = NullRow();
+    }
+  }
+  rows = sorted;
   
   /* I see no other way:
    * I have to loop vertices to set the sorted index on the vertices.
    * Then I have to loop edges to set the distance on the edges.
    * Then I have to loop vertices to set the receptacle offsets, so I can ignore edges with a distance of 1.
    * Then I have to loop vertices to set the background rectangle.
-   * Hope it scales. 
+   * Only rows whose index changed get their items moved. The loops are cheap
+   * compared to touching graphics items.
    */
   
   //layout constant items
   std::size_t currentRow = 0;
+  std::vector<bool> movedRows(sorted.size(), false);
   QRectF maxTextRect;
   QRectF maxConnectorRect;
   for (auto currentVertex : sorted)
   {
     //I can't calculate receptacle locations here. See note above.
     stow->graph[currentVertex].sortedIndex = currentRow;
-    QBrush currentBrush(forgroundBrushes.at(currentRow % forgroundBrushes.size()));
-    
     auto point = stow->graph[currentVertex].pointShared;
-    point->setRect(pointSize / -2.0, 0, pointSize, pointSize);
-    point->setTransform(QTransform::fromTranslate(0, rowHeight * currentRow + rowHeight / 2.0 - pointSize / 2.0));
-    point->setBrush(currentBrush);
-    
-    float cheat = 0.0;
-    if (direction == -1)
-      cheat = rowHeight;
+    auto text = stow->graph[currentVertex].textShared;
     
-    float yValue = rowHeight * currentRow + cheat;
-    stow->graph[currentVertex].visibleIconShared->setTransform(QTransform::fromTranslate(pointToIcon, yValue));
-    stow->graph[currentVertex].overlayIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon, yValue));
-    stow->graph[currentVertex].selectableIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon * 2, yValue));
-    stow->graph[currentVertex].stateIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon * 3, yValue));
-    stow->graph[currentVertex].featureIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon * 4, yValue));
+    if (force || stow->graph[currentVertex].laidIndex != currentRow)
+    {
+      movedRows[currentRow] = true;
+      stow->graph[currentVertex].laidIndex = currentRow;
+      QBrush currentBrush(forgroundBrushes.at(currentRow % forgroundBrushes.size()));
+      
+      point->setRect(pointSize / -2.0, 0, pointSize, pointSize);
+      point->setTransform(QTransform::fromTranslate(0, rowHeight * currentRow + rowHeight / 2.0 - pointSize / 2.0));
+      point->setBrush(currentBrush);
+      
+      float cheat = 0.0;
+      if (direction == -1)
+        cheat = rowHeight;
+      
+      float yValue = rowHeight * currentRow + cheat;
+      stow->graph[currentVertex].visibleIconShared->setTransform(QTransform::fromTranslate(pointToIcon, yValue));
+      stow->graph[currentVertex].overlayIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon, yValue));
+      stow->graph[currentVertex].selectableIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon * 2, yValue));
+      stow->graph[currentVertex].stateIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon * 3, yValue));
+      stow->graph[currentVertex].featureIconShared->setTransform(QTransform::fromTranslate(pointToIcon + iconToIcon * 4, yValue));
+      
+      text->setBrush(currentBrush.color());
+      text->setTransform(QTransform::fromTranslate (pointToIcon + iconToIcon * 4 + iconToText, rowHeight * currentRow - verticalSpacing * 2.0 + cheat));
+    }
     
-    auto text = stow->graph[currentVertex].textShared;
-    text->setBrush(currentBrush.color());
     maxTextLength = std::max(maxTextLength, static_cast<float>(text->boundingRect().width()));
-    text->setTransform(QTransform::fromTranslate (pointToIcon + iconToIcon * 4 + iconToText, rowHeight * currentRow - verticalSpacing * 2.0 + cheat));
     QRectF textRect = text->boundingRect();
     textRect.translate(text->transform().dx(), text->transform().dy());
     
@@ -785,15 +849,19 @@ void Model::projectUpdatedDispatched(const msg::Message &)
     }
   }
   
+  //vertex states are in sorted order.
   auto findStateVertex = [&](Vertex vIn) -> std::vector<VertexState>::iterator
   {
-    for (auto it = vertexStates.begin(); it != vertexStates.end(); ++it)
-    {
-      if (vIn == it->vertex)
-        return it;
-    }
-    assert(0); //couldn't find vertex state
-    return vertexStates.end();
+    std::size_t index = filteredGraph[vIn].sortedIndex;
+    assert(index < vertexStates.size() && vertexStates[index].vertex == vIn);
+    return vertexStates.begin() + index;
+  };
+  
+  //only touch connectors whose path changed.
+  auto setPath = [](QGraphicsPathItem *pathItem, const QPainterPath &path)
+  {
+    if (pathItem->path() != path)
+      pathItem->setPath(path);
   };
 
   for (auto edge : sortedEdges)
@@ -809,7 +877,7 @@ void Model::projectUpdatedDispatched(const msg::Message &)
       //update with straight line in y at x 0, but don't count against vertex and edge states
       path.moveTo(0.0, filteredGraph[sv].pointShared->transform().dy() + pointSize / 2.0);
       path.lineTo(0.0, filteredGraph[tv].pointShared->transform().dy() + pointSize / 2.0);
-      pathItem->setPath(path);
+      setPath(pathItem, path);
       if (pathItem->boundingRect().width() > maxConnectorRect.width())
         maxConnectorRect = pathItem->boundingRect();
       continue;
@@ -861,7 +929,7 @@ void Model::projectUpdatedDispatched(const msg::Message &)
     path.lineTo(-xPosition, yOut);
     path.lineTo(-xPosition, yIn);
     path.lineTo(0.0, yIn);
-    pathItem->setPath(path);
+    setPath(pathItem, path);
     if (pathItem->boundingRect().width() > maxConnectorRect.width())
         maxConnectorRect = pathItem->boundingRect();
   }
@@ -870,15 +938,79 @@ void Model::projectUpdatedDispatched(const msg::Message &)
   QRectF rowSizeRect = maxTextRect | maxConnectorRect;
   qreal rowWidth = rowSizeRect.width() + 2 * rowPadding;
   qreal rowX = -maxConnectorRect.width() - rowPadding;
+  bool resized = force || rowWidth != lastRowWidth || rowX != lastRowX;
+  lastRowWidth = rowWidth;
+  lastRowX = rowX;
   for (auto v : sorted)
   {
+    if (!resized && !movedRows[filteredGraph[v].sortedIndex])
+      continue;
     qreal yStart = rowHeight * filteredGraph[v].sortedIndex;
     auto rectangle = filteredGraph[v].rectShared;
     rectangle->setRect(rowX, yStart, rowWidth, rowHeight); //calculate actual size later.
     rectangle->setBackgroundBrush(backgroundBrushes[filteredGraph[v].sortedIndex % backgroundBrushes.size()]);
   }
   
-  this->setSceneRect(this->itemsBoundingRect());
+  //most items aren't in the scene, so itemsBoundingRect won't do.
+  this->setSceneRect(QRectF(rowX, 0.0, rowWidth, rowHeight * sorted.size()).normalized());
+  updateAttached();
+}
+
+void Model::viewportChanged()
+{
+  updateAttached();
+}
+
+/*! @brief Put items in the scene for rows near the viewport and take out the rest.
+ * 
+ * @details A connector is in the scene when any row it spans is.
+ * With no views, everything is attached.
+ */
+void Model::updateAttached()
+{
+  std::size_t first = 0;
+  std::size_t last = rows.size(); //one past.
+  QRectF visible;
+  for (const auto *view : views())
+    visible |= view->mapToScene(view->viewport()->rect()).boundingRect();
+  if (!visible.isEmpty())
+  {
+    qreal row0 = visible.top() / rowHeight;
+    qreal row1 = visible.bottom() / rowHeight;
+    qreal low = std::floor(std::min(row0, row1)) - rowMargin;
+    qreal high = std::ceil(std::max(row0, row1)) + rowMargin;
+    first = static_cast<std::size_t>(std::max(low, 0.0));
+    last = static_cast<std::size_t>(std::max(std::min(high, static_cast<qreal>(rows.size())), 0.0));
+  }
+  
+  for (std::size_t index = 0; index < rows.size(); ++index)
+  {
+    //removed since the last layout.
+    if (stow->graph[rows[index]].laidIndex == NullRow())
+      detachRow(rows[index]);
+    else if (index >= first && index < last)
+      attachRow(rows[index]);
+    else
+      detachRow(rows[index]);
+  }
+  
+  for (auto its = boost::edges(stow->graph); its.first != its.second; ++its.first)
+  {
+    const auto &sp = stow->graph[boost::source(*its.first, stow->graph)];
+    const auto &tp = stow->graph[boost::target(*its.first, stow->graph)];
+    bool want = false;
+    if (sp.laidIndex != NullRow() && tp.laidIndex != NullRow())
+    {
+      std::size_t low = std::min(sp.sortedIndex, tp.sortedIndex);
+      std::size_t high = std::max(sp.sortedIndex, tp.sortedIndex);
+      want = high >= first && low < last;
+    }
+    QGraphicsPathItem *connector = stow->graph[*its.first].connector.get();
+    if (want && !connector->scene())
+      this->addItem(connector);
+    else if (!want && connector->scene())
+      this->removeItem(connector);
+  }
 }
 
 void Model::dumpDAGViewGraphDispatched(const msg::Message &)
@@ -957,7 +1089,7 @@ void Model::removeAllItems()
   {
     if (!stow->graph[*its.first].alive)
       continue;
-    removeItemsFromScene(stow->getAllSceneItems(*its.first));
+    detachRow(*its.first);
   }
   
   for (auto its = boost::edges(stow->graph); its.first != its.second; ++its.first)
@@ -967,6 +1099,23 @@ void Model::removeAllItems()
   }
 }
 
+void Model::attachRow(Vertex v)
+{
+  if (stow->graph[v].attached)
+    return;
+  stow->graph[v].attached = true;
+  addItemsToScene(stow->getAllSceneItems(v));
+  updateLeafIcons(v);
+}
+
+void Model::detachRow(Vertex v)
+{
+  if (!stow->graph[v].attached)
+    return;
+  stow->graph[v].attached = false;
+  removeItemsFromScene(stow->getAllSceneItems(v));
+}
+
 void Model::addItemsToScene(std::vector<QGraphicsItem*> items)
 {
   for (auto *item : items)
@@ -1329,7 +1478,14 @@ void Model::mouseReleaseEvent(QGraphicsSceneMouseEvent *e)
     }
     
     if (!sentMessage)
-      projectUpdatedDispatched(msg::Message());
+    {
+      //put the dragged point back.
+      Vertex dv = stow->findVertex(dragData->featureId);
+      if (dv != NullVertex())
+        stow->graph[dv].laidIndex = NullRow();
+      layoutDirty = true;
+      layout(false);
+    }
     
     //take action.
     QGraphicsView *qgv = this->views().front();
@@ -1570,8 +1726,7 @@ void Model::editRenameSlot()
   {
     ftr::Message fm(stow->graph[selections.front()].featureId, freshName);
     msg::Message m(msg::Request | msg::Edit | msg::Feature | msg::Name, fm);
-    node->send(m); //don't block rename makes it back here.
-    projectUpdatedDispatched(msg::Message()); //this will size the background rects to match.
+    node->send(m); //don't block rename makes it back here. featureRenamedDispatched sizes the background rects.
   }
 }
 
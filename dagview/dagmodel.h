@@ -64,6 +64,8 @@ namespace dag
     Model(QObject *parentIn);
     virtual ~Model() override;
     
+    void viewportChanged(); //!< views call this when scrolled or resized.
+    
   protected:
     virtual void mouseMoveEvent(QGraphicsSceneMouseEvent* event) override;
     virtual void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
@@ -94,6 +96,7 @@ namespace dag
     void connectionAddedDispatched(const msg::Message &);
     void connectionRemovedDispatched(const msg::Message &);
     void projectUpdatedDispatched(const msg::Message &); //!< don't use message but need for function signature.
+    void dagViewUpdateDispatched(const msg::Message &);
     void preselectionAdditionDispatched(const msg::Message &);
     void preselectionSubtractionDispatched(const msg::Message &);
     void selectionAdditionDispatched(const msg::Message &);
@@ -117,6 +120,16 @@ namespace dag
     
     void removeAllItems();
     void stateUpdate(Vertex);
+    void updateLeafIcons(Vertex);
+    void layout(bool);
+    void updateAttached();
+    void attachRow(Vertex);
+    void detachRow(Vertex);
+    std::vector<Vertex> rows; //!< laid out vertices in sorted order.
+    bool layoutDirty = true; //!< vertices or connections changed since the last layout.
+    qreal lastRowWidth = 0.0; //!< background rects were sized for this.
+    qreal lastRowX = 0.0; //!< background rects were placed at this.
+    const static std::size_t rowMargin = 20; //!< rows attached beyond each edge of the viewport.
     void addItemsToScene(std::vector<QGraphicsItem*>);
     void removeItemsFromScene(std::vector<QGraphicsItem*>);
 //     
@@ -37,6 +37,8 @@ state(),
 dagVisible(true),
 alive(true),
 hasSeerShape(false),
+laidIndex(NullRow()),
+attached(false),
 rectShared(new RectItem()),
 pointShared(new QGraphicsEllipseItem()), 
 visibleIconShared(new QGraphicsPixmapItem()),
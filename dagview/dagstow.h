@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <bitset>
+#include <limits>
 
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/graphviz.hpp>
@@ -61,6 +62,8 @@ namespace dag
     bool dagVisible; //!< should entry be visible in the DAG view.
     bool alive;
     bool hasSeerShape; //!< to show check geometry context menu entry.
+    std::size_t laidIndex; //!< row the items were last positioned for. NullRow when not laid out.
+    bool attached; //!< items are in the scene. only rows near the viewport are.
     
     std::shared_ptr<RectItem> rectShared;
     std::shared_ptr<QGraphicsEllipseItem> pointShared;
@@ -96,6 +99,7 @@ namespace dag
   typedef boost::reverse_graph<Graph, Graph&> GraphReversed;
   typedef std::vector<Vertex> Path; //!< a path or any array of vertices
   inline Vertex NullVertex(){return boost::graph_traits<Graph>::null_vertex();}
+  inline std::size_t NullRow(){return std::numeric_limits<std::size_t>::max();}
   
   template <class GraphEW>
   class Edge_writer {
@@ -17,6 +17,7 @@
  *
  */
 
+#include "dagview/dagmodel.h"
 #include "dagview/dagview.h"
 
 using namespace dag;
@@ -36,4 +37,19 @@ View::~View()
 {
 }
 
+//model only keeps rows near the viewport in the scene.
+void View::scrollContentsBy(int dx, int dy)
+{
+  QGraphicsView::scrollContentsBy(dx, dy);
+  if (auto *model = dynamic_cast<Model*>(this->scene()))
+    model->viewportChanged();
+}
+
+void View::resizeEvent(QResizeEvent *event)
+{
+  QGraphicsView::resizeEvent(event);
+  if (auto *model = dynamic_cast<Model*>(this->scene()))
+    model->viewportChanged();
+}
+
 // #include "dagview/moc_dagview.cxx"
@@ -31,6 +31,9 @@ namespace dag
   public:
     View(QWidget *parentIn = 0);
     virtual ~View() override;
+  protected:
+    virtual void scrollContentsBy(int, int) override;
+    virtual void resizeEvent(QResizeEvent*) override;
   };
 }
 
@@ -59,6 +59,7 @@ struct Parameter::Stow
     parameters.push_back(parameter);
     
     pObserver.activeHandler = std::bind(&Stow::activeHasChanged, this);
+    pObserver.setDeferrable();
     pIn->connect(pObserver);
     
     node.connect(msg::hub());
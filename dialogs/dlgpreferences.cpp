@@ -33,6 +33,7 @@
 #include "dialogs/dlgwidgetgeometry.h"
 #include "dialogs/dlgpreferences.h"
 #include "dialogs/dlgsplitterdecorated.h"
+#include "feature/ftrshapecheck.h"
 #include "ui_dlgpreferences.h" //in build directory
 
 using namespace dlg;
@@ -124,6 +125,10 @@ void Preferences::initialize()
   ui->basePathEdit->setText(QString::fromStdString(manager->rootPtr->project().basePath()));
   ui->gitNameEdit->setText(QString::fromStdString(manager->rootPtr->project().gitName()));
   ui->gitEmailEdit->setText(QString::fromStdString(manager->rootPtr->project().gitEmail()));
+  if (manager->rootPtr->project().deferShapeChecks().get())
+    ui->deferShapeChecksCombo->setCurrentIndex(0);
+  else
+    ui->deferShapeChecksCombo->setCurrentIndex(1);
   
   ui->gestureTimeEdit->setValidator(positiveDouble);
   ui->gestureTimeEdit->setText(QString().setNum(manager->rootPtr->gesture().animationSeconds()));
@@ -404,6 +409,10 @@ void Preferences::updateProject()
   manager->rootPtr->project().basePath() = ui->basePathEdit->text().toStdString();
   manager->rootPtr->project().gitName() = ui->gitNameEdit->text().toStdString();
   manager->rootPtr->project().gitEmail() = ui->gitEmailEdit->text().toStdString();
+  
+  bool defer = ui->deferShapeChecksCombo->currentIndex() == 0;
+  manager->rootPtr->project().deferShapeChecks() = defer;
+  ftr::ShapeCheck::setMode((defer) ? ftr::ShapeCheck::Mode::Deferred : ftr::ShapeCheck::Mode::Full);
 }
 
 void Preferences::updateGesture()
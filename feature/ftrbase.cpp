@@ -18,11 +18,15 @@
  */
 
 #include <limits.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
 
 #include <QTextStream>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/filesystem.hpp>
 
 #include <BRep_Builder.hxx>
 #include <TopoDS_Compound.hxx>
@@ -31,6 +35,7 @@
 #include <TopExp.hxx>
 #include <Precision.hxx>
 #include <BinTools.hxx>
+#include <BRepTools.hxx>
 
 #include <osg/Switch>
 #include <osg/MatrixTransform>
@@ -50,9 +55,11 @@
 #include "preferences/prfmanager.h"
 #include "modelviz/mdvnodemaskdefs.h"
 #include "modelviz/mdvshapegeometry.h"
+#include "modelviz/mdvtessellationcache.h"
 #include "globalutilities.h"
 #include "message/msgnode.h"
 #include "lod/lodmessage.h"
+#include "lod/lodshared.h"
 #include "annex/annshapeidhelper.h"
 #include "annex/annseershape.h"
 #include "parameter/prmparameter.h"
@@ -65,13 +72,12 @@
 
 using namespace ftr;
 
-std::size_t Base::nextConstructionIndex = 0;
+std::atomic<std::size_t> Base::nextConstructionIndex(0);
 
 Base::Base()
 {
   id = gu::createRandomId();
-  constructionIndex = nextConstructionIndex;
-  nextConstructionIndex++;
+  constructionIndex = nextConstructionIndex++;
   
   name = QObject::tr("Empty");
   
@@ -249,21 +255,40 @@ void Base::updateVisual()
   double angular = osg::DegreesToRadians(prf::manager().rootPtr->visual().mesh().angularDeflection());
   float screenHeight = osg::DisplaySettings::instance()->getScreenHeight(); 
   
-  ann::ShapeIdHelper helper = ss.buildHelper();
-  mdv::ShapeGeometryBuilder sBuilder(ss.getRootOCCTShape(), helper);
-  
-  sBuilder.go
-  (
-    linear * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry01().linearFactor(),
-    angular * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry01().angularFactor()
-  );
-  assert(sBuilder.success);
-  lod->setCenter(sBuilder.out->getBound().center());
-  lod->setRadius(sBuilder.out->getBound().radius());
-  
   boost::filesystem::path filePathBase;
   filePathBase = app::instance()->getProject()->getSaveDirectory();
   filePathBase /= ".scratch";
+  
+  ann::ShapeIdHelper helper = ss.buildHelper();
+  
+  //tessellation cache key is built from the binary shape. The builder cleans
+  //the shape anyway, so clean first and key off of bare geometry.
+  BRepTools::Clean(ss.getRootOCCTShape());
+  std::ostringstream shapeStream;
+  BinTools::Write(ss.getRootOCCTShape(), shapeStream);
+  std::string shapeBytes = shapeStream.str();
+  
+  double linear01 = linear * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry01().linearFactor();
+  double angular01 = angular * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry01().angularFactor();
+  mdv::TessellationCache &cache = mdv::tessellationCache();
+  cache.setDirectory(filePathBase);
+  std::string cacheKey = mdv::TessellationCache::buildKey(shapeBytes, helper.getIds(), linear01, angular01);
+  osg::ref_ptr<osg::Switch> visual = cache.find(cacheKey);
+  if (!visual)
+  {
+    mdv::ShapeGeometryBuilder sBuilder(ss.getRootOCCTShape(), helper);
+    sBuilder.go(linear01, angular01);
+    assert(sBuilder.success);
+    visual = sBuilder.out;
+    if (sBuilder.success)
+      cache.insert(cacheKey, *visual);
+  }
+  lod->setCenter(visual->getBound().center());
+  lod->setRadius(visual->getBound().radius());
+  //lod manager hands out requests for features near the eye first.
+  osg::Vec3d lodCenter = osg::Vec3d(visual->getBound().center()) * mainTransform->getMatrix();
+  double lodRadius = visual->getBound().radius();
+  
   boost::filesystem::path filePath00 = filePathBase / (gu::idToString(id) + "_00.osgb");
   boost::filesystem::path filePath01 = filePathBase / (gu::idToString(id) + "_01.osgb");
   boost::filesystem::path filePath02 = filePathBase / (gu::idToString(id) + "_02.osgb");
@@ -274,51 +299,59 @@ void Base::updateVisual()
   
   double partition00 = screenHeight * prf::manager().rootPtr->visual().mesh().lod().get().partition00();
   double partition01 = screenHeight * prf::manager().rootPtr->visual().mesh().lod().get().partition01();
-  lod->addChild(sBuilder.out, partition00, partition01, filePath00.string());
+  lod->addChild(visual, partition00, partition01, filePath00.string());
   
-  //each subsequent meshing operation will take linear deflection / 10.
-  //but we don't that here. that will be done in another process.
-  //for now we will just copy the course mesh file to the other filenames.
-  //hopefully other process can overwrite the files and pagedlod will figure it out.
-  //follow up: that didn't work. going to have to generate and update pagedlod node.
-
-  //the binary format seems to be a bit of a black box.
-  //I just chose to use the brp extension. Couldn't find the accepted binary file extension.
-  boost::filesystem::path filePathOCCT = filePathBase / (gu::idToString(id) + ".brp");
-  BinTools::Write(getAnnex<ann::SeerShape>().getRootOCCTShape(), filePathOCCT.string().c_str());
-  
-  boost::filesystem::path filePathIds = filePathBase / (gu::idToString(id) + ".ids");
-  helper.write(filePathIds);
+  //finer lods are generated in child processes. The shape and ids go to
+  //them once through shared memory and the results come back the same way,
+  //so paged lod never reads these files. Don't let it expire children.
+  lod->setNumChildrenThatCannotBeExpired(3);
+  std::shared_ptr<lod::SharedBuffer> lodInput;
+  try
+  {
+    lodInput = lod::writeInput(shapeBytes, helper.getIds());
+  }
+  catch (const std::exception &e)
+  {
+    std::cout << "Warning: no shared memory for lod generation: " << e.what() << std::endl;
+  }
 
   double partition02 = screenHeight * prf::manager().rootPtr->visual().mesh().lod().get().partition02();
-  lod::Message m1
-  (
-    id,
-    filePathOCCT,
-    filePath01,
-    filePathIds,
-    linear * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry02().linearFactor(),
-    angular * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry02().angularFactor(),
-    partition01,
-    partition02
-  );
-  msg::hub().sendBlocked(msg::Message(msg::Mask(msg::Request | msg::Construct | msg::LOD), m1));
-  lod->addChild(sBuilder.out, partition01, partition02, filePath00.string());
+  if (lodInput)
+  {
+    lod::Message m1
+    (
+      id,
+      lodInput,
+      filePath01,
+      linear * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry02().linearFactor(),
+      angular * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry02().angularFactor(),
+      partition01,
+      partition02
+    );
+    m1.center = lodCenter;
+    m1.radius = lodRadius;
+    msg::hub().sendBlocked(msg::Message(msg::Mask(msg::Request | msg::Construct | msg::LOD), m1));
+  }
+  lod->addChild(visual, partition01, partition02, filePath00.string());
   
   double partition03 = prf::manager().rootPtr->visual().mesh().lod().get().partition03();
-  lod::Message m2
-  (
-    id,
-    filePathOCCT,
-    filePath02,
-    filePathIds,
-    linear * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry03().linearFactor(),
-    angular * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry03().angularFactor(),
-    partition02,
-    partition03
-  );
-  msg::hub().sendBlocked(msg::Message(msg::Mask(msg::Request | msg::Construct | msg::LOD), m2));
-  lod->addChild(sBuilder.out, partition02, partition03, filePath00.string());
+  if (lodInput)
+  {
+    lod::Message m2
+    (
+      id,
+      lodInput,
+      filePath02,
+      linear * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry03().linearFactor(),
+      angular * prf::manager().rootPtr->visual().mesh().lod().get().LODEntry03().angularFactor(),
+      partition02,
+      partition03
+    );
+    m2.center = lodCenter;
+    m2.radius = lodRadius;
+    msg::hub().sendBlocked(msg::Message(msg::Mask(msg::Request | msg::Construct | msg::LOD), m2));
+  }
+  lod->addChild(visual, partition02, partition03, filePath00.string());
   
   osg::ref_ptr<osg::KdTreeBuilder> kdTreeBuilder = new osg::KdTreeBuilder();
   lod->accept(*kdTreeBuilder);
@@ -465,6 +498,25 @@ boost::filesystem::path Base::buildFilePathName(const boost::filesystem::path &d
   return dIn / getFileName();
 }
 
+boost::filesystem::path Base::buildFilePathName(const boost::filesystem::path &dIn, const std::string &extension) const
+{
+  return dIn / (gu::idToString(id) + "." + extension);
+}
+
+void Base::removeFiles(const boost::filesystem::path &dIn) const
+{
+  //side car files share the feature id stem.
+  std::string stem = gu::idToString(id);
+  std::vector<boost::filesystem::path> doomed;
+  for (const auto &entry : boost::filesystem::directory_iterator(dIn))
+  {
+    if (boost::filesystem::is_regular_file(entry.path()) && entry.path().stem().string() == stem)
+      doomed.push_back(entry.path());
+  }
+  for (const auto &p : doomed)
+    boost::filesystem::remove(p);
+}
+
 bool Base::hasParameter(const boost::uuids::uuid &idIn) const
 {
   for (const auto &p : parameters)
@@ -22,6 +22,7 @@
 #define FTR_BASE_H
 
 #include <memory>
+#include <atomic>
 
 #include <boost/uuid/uuid.hpp>
 
@@ -105,6 +106,7 @@ public:
   void setColor(const osg::Vec4 &);
   const osg::Vec4& getColor() const {return color;}
   virtual void updateModel(const UpdatePayload&) = 0;
+  virtual bool isConcurrentSafe() const {return true;} //!< false when updateModel uses a library with global state.
   virtual void updateVisual(); //called after update.
   virtual Type getType() const = 0;
   virtual const std::string& getTypeString() const = 0;
@@ -159,8 +161,10 @@ public:
   virtual void serialWrite(const boost::filesystem::path&); //!< override in leaf classes only.
   std::string getFileName() const; //!< used by git.
   boost::filesystem::path buildFilePathName(const boost::filesystem::path&) const; //!<generate complete path to file
+  boost::filesystem::path buildFilePathName(const boost::filesystem::path&, const std::string&) const; //!<path to side car file with extension
+  void removeFiles(const boost::filesystem::path&) const; //!< remove feature file and side car files.
   
-  static std::size_t nextConstructionIndex;
+  static std::atomic<std::size_t> nextConstructionIndex; //!< features are constructed concurrently on project open.
   
 protected:
   void setModelClean(); //!< clean can only set through virtual update.
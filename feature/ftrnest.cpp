@@ -17,9 +17,20 @@
  *
  */
 
+#include <limits>
+
+#include <BRepBuilderAPI_Copy.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
 #include <BRepExtrema_Poly.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <BRepGProp.hxx>
+#include <BRep_Tool.hxx>
+#include <GProp_GProps.hxx>
+#include <Precision.hxx>
+#include <TopLoc_Location.hxx>
+#include <TopExp_Explorer.hxx>
+#include <TopoDS.hxx>
+#include <gp_Ax1.hxx>
 
 #include <osg/Switch>
 
@@ -31,6 +42,7 @@
 #include "annex/annseershape.h"
 #include "feature/ftrshapecheck.h"
 #include "tools/occtools.h"
+#include "tools/tlsparallel.h"
 #include "project/serial/generated/prjsrlnstsnest.h"
 #include "feature/ftrupdatepayload.h"
 #include "feature/ftrinputtype.h"
@@ -47,6 +59,8 @@ Base(),
 pitch(std::make_unique<prm::Parameter>(QObject::tr("Pitch"), 1.0)),
 gap(std::make_unique<prm::Parameter>(QObject::tr("Gap"), prf::manager().rootPtr->features().nest().get().gap())),
 feedDirection(std::make_unique<prm::Parameter>(QObject::tr("Feed Direction"), osg::Vec3d(-1.0, 0.0, 0.0))),
+tolerance(std::make_unique<prm::Parameter>(QObject::tr("Tolerance"), 0.01)),
+angleCount(std::make_unique<prm::Parameter>(QObject::tr("Angle Count"), 0)),
 sShape(std::make_unique<ann::SeerShape>())
 
 {
@@ -64,6 +78,14 @@ sShape(std::make_unique<ann::SeerShape>())
   feedDirection->connectValue(std::bind(&Nest::setModelDirty, this));
   parameters.push_back(feedDirection.get());
   
+  tolerance->setConstraint(prm::Constraint::buildNonZeroPositive());
+  tolerance->connectValue(std::bind(&Nest::setModelDirty, this));
+  parameters.push_back(tolerance.get());
+  
+  angleCount->setConstraint(prm::Constraint::buildZeroPositive());
+  angleCount->connectValue(std::bind(&Nest::setModelDirty, this));
+  parameters.push_back(angleCount.get());
+  
   gapLabel = new lbr::PLabel(gap.get());
   overlaySwitch->addChild(gapLabel.get());
   
@@ -90,33 +112,188 @@ osg::Vec3d Nest::getFeedDirection() const
   return feedDirection->getVector();
 }
 
-double Nest::getDistance(const TopoDS_Shape &sIn1, const TopoDS_Shape &sIn2)
+namespace
 {
-  gp_Pnt p1, p2;
-  double distance;
-  if (BRepExtrema_Poly::Distance(sIn1, sIn2, p1, p2, distance))
+  struct Contact
+  {
+    double distance = -1.0; //!< negative means failure.
+    gp_Pnt p1;
+    gp_Pnt p2;
+  };
+  
+  //! true when every face has a triangulation, so poly extrema can be used.
+  bool isMeshed(const TopoDS_Shape &sIn)
   {
-    //position the gapLabel.
-    gp_Vec pos1(p1.XYZ());
-    gp_Vec pos2(p2.XYZ());
-    osg::Vec3d gapPosition = gu::toOsg(pos1 + ((pos2 - pos1) * 0.5));
-    gapLabel->setMatrix(osg::Matrixd::translate(gapPosition));
+    for (TopExp_Explorer it(sIn, TopAbs_FACE); it.More(); it.Next())
+    {
+      TopLoc_Location location;
+      if (BRep_Tool::Triangulation(TopoDS::Face(it.Current()), location).IsNull())
+        return false;
+    }
+    return true;
+  }
+  
+  //! doesn't touch any feature members so safe to call from multiple threads.
+  Contact getContact(const TopoDS_Shape &sIn1, const TopoDS_Shape &sIn2)
+  {
+    Contact out;
+    if (BRepExtrema_Poly::Distance(sIn1, sIn2, out.p1, out.p2, out.distance))
+      return out;
+    
+    //this shouldn't ever be run as we ensure the poly/mesh before calling.
+    //adding tolerance didn't make the 1 test I was using any faster.
+    //these parts have nothing but linear edges, so maybe once we have
+    //some non-linear edges this tolerance will be beneficial.
+    double tol = 0.1;
+    BRepExtrema_DistShapeShape dc(sIn1, sIn2, tol, Extrema_ExtFlag_MIN);
+    if (!dc.IsDone() || dc.NbSolution() < 1)
+    {
+      out.distance = -1.0;
+      return out;
+    }
+    out.distance = dc.Value();
+    out.p1 = dc.PointOnShape1(1);
+    out.p2 = dc.PointOnShape2(1);
+    return out;
+  }
+  
+  struct Solution
+  {
+    double pitch = 0.0;
+    Contact contact; //!< at pitch.
+    bool converged = false;
+  };
+  
+  /*! @brief Find pitch where distance between blank and its instance equals gap.
+   * 
+   * @param bIn blank shape.
+   * @param dir unit feed direction.
+   * @param start offset where instance is clear of the blank.
+   * @param gap wanted distance between blank and instance.
+   * @param tol convergence tolerance of pitch.
+   * @details Moving the instance by some distance can't change the
+   * shape distance by more than that distance. So from the start we
+   * can safely back up by the distance in excess of gap without
+   * jumping over the outermost contact. Once that stalls on oblique
+   * contacts, we bracket and finish with false position. Illinois
+   * variant, so a stuck end point doesn't stall convergence. Result
+   * always has a distance of at least gap.
+   */
+  Solution solvePitch(const TopoDS_Shape &bIn, const gp_Vec &dir, double start, double gap, double tol)
+  {
+    Solution out;
+    int iterations = 0;
+    const int maxIterations = 100;
+    auto evaluate = [&](double offset) -> Contact
+    {
+      iterations++;
+      Contact c = getContact(bIn, occt::instanceShape(bIn, dir, offset));
+      if (c.distance < 0.0)
+        throw std::runtime_error("couldn't get distance in Nest pitch solve");
+      return c;
+    };
+    
+    //make sure start is clear.
+    double hi = start;
+    Contact hiContact = evaluate(hi);
+    while (hiContact.distance < gap)
+    {
+      if (iterations >= maxIterations)
+        throw std::runtime_error("couldn't find clear start position in Nest pitch solve");
+      hi += std::max(hi, gap);
+      hiContact = evaluate(hi);
+    }
+    
+    //back up while it is paying off.
+    while (hiContact.distance - gap > tol && iterations < maxIterations)
+    {
+      double step = hiContact.distance - gap;
+      if (step < gap * 0.1)
+        break; //stalled on oblique contact. bracket instead.
+      double next = hi - step;
+      if (next <= 0.0)
+        break;
+      hi = next;
+      hiContact = evaluate(hi);
+    }
+    
+    //bracket. lo is overlap or closer than gap.
+    double lo = hi;
+    Contact loContact = hiContact;
+    while (loContact.distance >= gap)
+    {
+      if (iterations >= maxIterations)
+        break;
+      hi = lo;
+      hiContact = loContact;
+      lo = std::max(0.0, hi - gap);
+      loContact = evaluate(lo);
+      if (lo == 0.0)
+        break;
+    }
+    if (loContact.distance >= gap)
+    {
+      //never found an interference. use what we got.
+      out.pitch = hi;
+      out.contact = hiContact;
+      return out;
+    }
+    
+    double fLo = loContact.distance - gap; //negative
+    double fHi = hiContact.distance - gap; //non negative
+    int side = 0;
+    while (hi - lo > tol && fHi > tol)
+    {
+      if (iterations >= maxIterations)
+      {
+        out.pitch = hi;
+        out.contact = hiContact;
+        return out;
+      }
+      double x = hi - fHi * (hi - lo) / (fHi - fLo);
+      //keep away from ends. bisect when interpolation is useless.
+      if (!(x > lo && x < hi))
+        x = (lo + hi) * 0.5;
+      Contact c = evaluate(x);
+      double fx = c.distance - gap;
+      if (fx >= 0.0)
+      {
+        hi = x;
+        fHi = fx;
+        hiContact = c;
+        if (side == 1)
+          fLo *= 0.5;
+        side = 1;
+      }
+      else
+      {
+        lo = x;
+        fLo = fx;
+        if (side == -1)
+          fHi *= 0.5;
+        side = -1;
+      }
+    }
     
-    return distance;
+    out.pitch = hi;
+    out.contact = hiContact;
+    out.converged = true;
+    return out;
   }
   
-  //this shouldn't ever be run as we ensure the poly/mesh before calling.
-  //note this execution path doesn't set the gap label position.
-  //adding tolerance didn't make the 1 test I was using any faster.
-  //these parts have nothing but linear edges, so maybe once we have
-  //some non-linear edges this tolerance will be beneficial.
-  double tol = 0.1;
-  BRepExtrema_DistShapeShape dc(sIn1, sIn2, tol, Extrema_ExtFlag_MIN);
-  if (!dc.IsDone())
-    return -1.0;
-  if (dc.NbSolution() < 1)
-    return -1.0;
-  return dc.Value();
+  //! extent of box corners along vector.
+  double getExtent(occt::BoundingBox &box, const gp_Vec &v)
+  {
+    double min = std::numeric_limits<double>::max();
+    double max = std::numeric_limits<double>::lowest();
+    for (const auto &c : box.getCorners())
+    {
+      double d = gp_Vec(c.XYZ()).Dot(v);
+      min = std::min(min, d);
+      max = std::max(max, d);
+    }
+    return max - min;
+  }
 }
 
 TopoDS_Shape Nest::calcPitch(TopoDS_Shape &bIn, double guess)
@@ -125,53 +302,93 @@ TopoDS_Shape Nest::calcPitch(TopoDS_Shape &bIn, double guess)
   //dir is a unit vector.
   gp_Vec dir = gu::toOcc(feedDirection->getVector());
   double localGap = gap->getDouble();
-  double tol = localGap * 0.1;
-  TopoDS_Shape other = occt::instanceShape(bIn, dir, guess + localGap + tol);
   
-  double dist = getDistance(bIn, other);
-  if (dist == -1.0)
-    throw std::runtime_error("couldn't get start position in getPitch");
-  
-  int maxIter = 100;
-  int iter = 0;
-  while (dist > localGap)
+  Solution s = solvePitch(bIn, dir, guess + localGap, localGap, tolerance->getDouble());
+  if (!s.converged)
   {
-    occt::moveShape(other, -dir, localGap);
-    dist = getDistance(bIn, other);
-    
-    iter++;
-    if (iter >= maxIter)
-    {
-      //exception ?
-      std::ostringstream s; s << "warning: max iterations reached in Nest::calcPitch" << std::endl;
-      lastUpdateLog += s.str();
-      break;
-    }
+    std::ostringstream stream; stream << "warning: pitch solver didn't converge in Nest::calcPitch" << std::endl;
+    lastUpdateLog += stream.str();
   }
   
-  iter = 0;
-  while (dist < localGap)
+  //position the gapLabel.
+  gp_Vec pos1(s.contact.p1.XYZ());
+  gp_Vec pos2(s.contact.p2.XYZ());
+  osg::Vec3d gapPosition = gu::toOsg(pos1 + ((pos2 - pos1) * 0.5));
+  gapLabel->setMatrix(osg::Matrixd::translate(gapPosition));
+  
+  pitch->setValue(s.pitch);
+  return occt::instanceShape(bIn, dir, s.pitch);
+}
+
+/*! @brief Report pitch and material utilization for blank orientations.
+ * 
+ * @param bIn blank shape.
+ * @details Blank is rotated about global z through its bounding box
+ * center. Orientations are spread over 180 degrees as the pitch of a blank
+ * turned 180 degrees is the same. Utilization is the blank area over
+ * pitch times strip width. Blank is expected to be a face, like from squash.
+ * Only reports, resulting shape stays in the original orientation.
+ */
+void Nest::sweepAngles(const TopoDS_Shape &bIn)
+{
+  int count = angleCount->getInt();
+  if (count < 2)
+    return;
+  
+  gp_Vec dir = gu::toOcc(feedDirection->getVector());
+  gp_Vec across = gp_Vec(0.0, 0.0, 1.0).Crossed(dir);
+  if (across.Magnitude() < Precision::Confusion())
+    throw std::runtime_error("feed direction parallel to z, can't sweep angles");
+  across.Normalize();
+  double localGap = gap->getDouble();
+  double localTolerance = tolerance->getDouble();
+  gp_Ax1 axis(occt::BoundingBox(bIn).getCenter(), gp_Dir(0.0, 0.0, 1.0));
+  
+  GProp_GProps props;
+  BRepGProp::SurfaceProperties(bIn, props);
+  double area = props.Mass();
+  
+  struct Result
   {
-    occt::moveShape(other, dir, tol); //move back so we are greater than gap.
-    dist = getDistance(bIn, other);
-    
-    iter++;
-    if (iter >= maxIter)
+    double angle = 0.0; //!< degrees
+    double pitch = 0.0;
+    double width = 0.0;
+    bool valid = false;
+  };
+  std::vector<Result> results(count);
+  tls::parallelFor(count, [&](std::size_t index)
+  {
+    Result &r = results[index];
+    r.angle = 180.0 / count * index;
+    gp_Trsf rotation;
+    rotation.SetRotation(axis, osg::DegreesToRadians(r.angle));
+    TopoDS_Shape rotated = bIn.Moved(TopLoc_Location(rotation));
+    occt::BoundingBox box(rotated);
+    double length = getExtent(box, dir);
+    r.width = getExtent(box, across);
+    r.pitch = solvePitch(rotated, dir, length + localGap, localGap, localTolerance).pitch;
+    r.valid = true;
+  });
+  
+  std::ostringstream stream;
+  stream << "Nest angle sweep. Blank area: " << area << std::endl;
+  const Result *best = nullptr;
+  for (const auto &r : results)
+  {
+    if (!r.valid)
     {
-      //exception ?
-      std::ostringstream s; s << "warning: max iterations reached in Nest::calcPitch" << std::endl;
-      lastUpdateLog += s.str();
-      break;
+      stream << "    angle: " << r.angle << " failed" << std::endl;
+      continue;
     }
+    double utilization = area / (r.pitch * r.width) * 100.0;
+    stream << "    angle: " << r.angle << "    pitch: " << r.pitch
+    << "    width: " << r.width << "    utilization: " << utilization << "%" << std::endl;
+    if (!best || r.pitch < best->pitch)
+      best = &r;
   }
-  
-  //set pitch
-  gp_Vec pos1 = gp_Vec(bIn.Location().Transformation().TranslationPart());
-  gp_Vec pos2 = gp_Vec(other.Location().Transformation().TranslationPart());
-  double p = (pos1 - pos2).Magnitude();
-  pitch->setValue(p);
-  
-  return other;
+  if (best)
+    stream << "    minimum pitch at angle: " << best->angle << std::endl;
+  lastUpdateLog += stream.str();
 }
 
 void Nest::updateModel(const UpdatePayload &payloadIn)
@@ -189,26 +406,33 @@ void Nest::updateModel(const UpdatePayload &payloadIn)
     const ann::SeerShape &bss = bbf->getAnnex<ann::SeerShape>(); //part seer shape.
     if (bss.isNull())
       throw std::runtime_error("seer shape for blank is null");
-    TopoDS_Shape bs = occt::getFirstNonCompound(bss.getRootOCCTShape()); //blank shape. not const, might mesh.
+    TopoDS_Shape bs = occt::getFirstNonCompound(bss.getRootOCCTShape()); //blank shape.
     
     /* this is a little unusual. For performance reasons, we are using
      * poly extrema for calculating pitch. Therefore the shapes need
      * triangulation done before this or they will fall back onto normal
      * extrema(slow). When update is called on the project we go through
      * and calculate all the model and then the viz. Long story short, we
-     * don't have any triangulation in the blank shape. so manually call
-     * update viz on it so we can use the poly extrema.
+     * may not have any triangulation in the blank shape. A visual from
+     * the tessellation cache doesn't mesh the shape either, so check the
+     * shape itself and not the visual state. If needed mesh it here
+     * so we can use the poly extrema. The blank shape belongs to the parent
+     * and siblings in the same update wave may be reading it, so mesh a copy
+     * and never the shape itself.
      */
-    if (bbf->isVisualDirty())
+    TopoDS_Shape ms = bs; //meshed blank shape for extrema.
+    if (!isMeshed(bs))
     {
       double linear = prf::manager().rootPtr->visual().mesh().linearDeflection();
       double angular = prf::manager().rootPtr->visual().mesh().angularDeflection();
-      BRepMesh_IncrementalMesh(bs, linear, Standard_False, angular, Standard_True);
+      ms = BRepBuilderAPI_Copy(bs, Standard_False, Standard_False).Shape();
+      BRepMesh_IncrementalMesh(ms, linear, Standard_False, angular, Standard_True);
     }
     //right now we are not consider the feed direction and just go with box length.
     //of course when we make the feed direction a parameter we will have to adjust.
     occt::BoundingBox bbox(bs); //use for both pitch calc and label location.
-    TopoDS_Shape other = calcPitch(bs, bbox.getLength());
+    TopoDS_Shape other = calcPitch(ms, bbox.getLength());
+    sweepAngles(ms);
     
     occt::ShapeVector shapes;
     shapes.push_back(bs); //original part shape.
@@ -261,6 +485,9 @@ void Nest::serialWrite(const boost::filesystem::path &dIn)
     pitch->getDouble()
   );
   
+  so.tolerance() = tolerance->serialOut();
+  so.angleCount() = angleCount->serialOut();
+  
   xml_schema::NamespaceInfomap infoMap;
   std::ofstream stream(buildFilePathName(dIn).string());
   prj::srl::nsts::nest(stream, so, infoMap);
@@ -275,4 +502,8 @@ void Nest::serialRead(const prj::srl::nsts::Nest &sNestIn)
   gapLabel->serialIn(sNestIn.gapLabel());
   feedDirectionLabel->serialIn(sNestIn.feedDirectionLabel());
   pitch->setValue(sNestIn.pitch());
+  if (sNestIn.tolerance())
+    tolerance->serialIn(sNestIn.tolerance().get());
+  if (sNestIn.angleCount())
+    angleCount->serialIn(sNestIn.angleCount().get());
 }
@@ -57,6 +57,8 @@ namespace ftr
     std::unique_ptr<prm::Parameter> pitch; //!< not really a parameter. just using for convenience.
     std::unique_ptr<prm::Parameter> gap;
     std::unique_ptr<prm::Parameter> feedDirection;
+    std::unique_ptr<prm::Parameter> tolerance; //!< pitch solver convergence.
+    std::unique_ptr<prm::Parameter> angleCount; //!< orientations to report. 0 or 1 is off.
     
     std::unique_ptr<ann::SeerShape> sShape;
     
@@ -64,7 +66,7 @@ namespace ftr
     osg::ref_ptr<lbr::PLabel> feedDirectionLabel;
     
     TopoDS_Shape calcPitch(TopoDS_Shape &bIn, double guess);
-    double getDistance(const TopoDS_Shape &sIn1, const TopoDS_Shape &sIn2);
+    void sweepAngles(const TopoDS_Shape &bIn);
     
   private:
     static QIcon icon;
@@ -16,21 +16,126 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
+#include <mutex>
+#include <atomic>
+#include <map>
+#include <vector>
+#include <iostream>
 
 #include <TopoDS_Shape.hxx>
+#include <TopoDS_TShape.hxx>
+#include <TopoDS_Iterator.hxx>
+#include <TopLoc_Location.hxx>
 #include <BRepCheck_Analyzer.hxx>
+#include <Standard_Failure.hxx>
 
 #include "tools/occtools.h"
+#include "tools/tlsparallel.h"
 #include "feature/ftrshapecheck.h"
 
+namespace
+{
+  /*! @brief Verdicts per TShape shared by all checks.
+   * 
+   * Holds handles so a TShape can't be freed and its address reused
+   * by another while the entry exists. Cleared after model updates.
+   */
+  struct Cache
+  {
+    std::mutex mutex;
+    std::map<const TopoDS_TShape*, std::pair<Handle(TopoDS_TShape), bool>> verdicts;
+    std::atomic<ftr::ShapeCheck::Mode> mode{ftr::ShapeCheck::Mode::Full};
+    std::atomic<std::size_t> checks{0};
+    std::atomic<std::size_t> deferred{0};
+    std::atomic<std::size_t> analyzed{0};
+    std::atomic<std::size_t> cacheHits{0};
+  };
+  
+  Cache& cache()
+  {
+    static Cache c;
+    return c;
+  }
+  
+  //! collect the non compound sub shapes.
+  void gatherUnits(const TopoDS_Shape &shape, std::vector<TopoDS_Shape> &units)
+  {
+    if (shape.ShapeType() == TopAbs_COMPOUND || shape.ShapeType() == TopAbs_COMPSOLID)
+    {
+      for (TopoDS_Iterator it(shape); it.More(); it.Next())
+        gatherUnits(it.Value(), units);
+      return;
+    }
+    units.push_back(shape);
+  }
+  
+  //! analyze each distinct TShape once. false if any is invalid.
+  bool analyze(const TopoDS_Shape &shape)
+  {
+    std::vector<TopoDS_Shape> units;
+    gatherUnits(shape, units);
+    
+    Cache &c = cache();
+    std::vector<TopoDS_Shape> todo; //!< distinct and not in cache.
+    {
+      std::map<const TopoDS_TShape*, bool> seen;
+      std::lock_guard<std::mutex> lock(c.mutex);
+      for (const auto &u : units)
+      {
+        const TopoDS_TShape *key = u.TShape().get();
+        auto it = c.verdicts.find(key);
+        if (it != c.verdicts.end())
+        {
+          c.cacheHits++;
+          if (!it->second.second)
+            return false;
+          continue;
+        }
+        if (!seen.insert(std::make_pair(key, true)).second)
+        {
+          c.cacheHits++;
+          continue;
+        }
+        //located copies share the verdict, so check without location.
+        todo.push_back(u.Located(TopLoc_Location()));
+      }
+    }
+    
+    std::vector<char> results(todo.size(), 0);
+    auto work = [&](std::size_t index)
+    {
+      try
+      {
+        BRepCheck_Analyzer checker(todo[index]);
+        results[index] = checker.IsValid() ? 1 : 0;
+      }
+      catch (const Standard_Failure &e)
+      {
+        std::cout << std::endl << "OCCT Exception in ShapeCheck: " << e.GetMessageString() << std::endl;
+      }
+    };
+    tls::parallelFor(todo.size(), work);
+    c.analyzed += todo.size();
+    
+    bool out = true;
+    std::lock_guard<std::mutex> lock(c.mutex);
+    for (std::size_t index = 0; index < todo.size(); ++index)
+    {
+      bool valid = results[index] != 0;
+      c.verdicts.insert(std::make_pair(todo[index].TShape().get(), std::make_pair(todo[index].TShape(), valid)));
+      out = out && valid;
+    }
+    return out;
+  }
+}
+
 namespace ftr
 {
   class ShapeCheckPrivate
   {
   public:
     ShapeCheckPrivate(const TopoDS_Shape &shapeIn):
-      shape(shapeIn),
-      checker(shape)
+      shape(shapeIn)
     {}
     bool isEmpty()
     {
@@ -54,41 +159,31 @@ namespace ftr
       return !foundValid;
     }
     const TopoDS_Shape &shape;
-    BRepCheck_Analyzer checker;
+    std::unique_ptr<BRepCheck_Analyzer> checker; //!< only built for getChecker.
   };
 }
 
 using namespace ftr;
 
-ShapeCheck::ShapeCheck(const TopoDS_Shape &shapeIn)
+ShapeCheck::ShapeCheck(const TopoDS_Shape &shapeIn) : ShapeCheck(shapeIn, getMode()){}
+
+ShapeCheck::ShapeCheck(const TopoDS_Shape &shapeIn, Mode modeIn)
 : shapeCheckPrivate(std::make_unique<ShapeCheckPrivate>(shapeIn))
 {
+  cache().checks++;
   try
   {
     //defaults to invalid.
     if (shapeIn.IsNull())
       return;
     
-    if (!shapeCheckPrivate->checker.IsValid())
+    //look for something 'concrete' in the shape. cheap, so always done.
+    if (shapeCheckPrivate->isEmpty())
       return;
     
-    //look for something 'concrete' in the shape.
-    occt::ShapeVector ss = occt::mapShapes(shapeIn);
-    bool foundValid = false;
-    for (const auto &s : ss)
-    {
-      if
-      (
-        (s.ShapeType() != TopAbs_SHAPE)
-        && (s.ShapeType() != TopAbs_COMPOUND)
-        && (s.ShapeType() != TopAbs_COMPSOLID)
-      )
-      {
-        foundValid = true;
-        break;
-      }
-    }
-    if (!foundValid)
+    if (modeIn == Mode::Deferred)
+      cache().deferred++;
+    else if (!analyze(shapeIn))
       return;
     
     validity = true;
@@ -111,5 +206,44 @@ ShapeCheck::~ShapeCheck()
 
 const BRepCheck_Analyzer& ShapeCheck::getChecker()
 {
-  return shapeCheckPrivate->checker;
+  if (!shapeCheckPrivate->checker)
+    shapeCheckPrivate->checker = std::make_unique<BRepCheck_Analyzer>(shapeCheckPrivate->shape);
+  return *shapeCheckPrivate->checker;
+}
+
+void ShapeCheck::setMode(Mode modeIn)
+{
+  cache().mode = modeIn;
+}
+
+ShapeCheck::Mode ShapeCheck::getMode()
+{
+  return cache().mode;
+}
+
+void ShapeCheck::clearCache()
+{
+  Cache &c = cache();
+  std::lock_guard<std::mutex> lock(c.mutex);
+  c.verdicts.clear();
+}
+
+void ShapeCheck::resetStats()
+{
+  Cache &c = cache();
+  c.checks = 0;
+  c.deferred = 0;
+  c.analyzed = 0;
+  c.cacheHits = 0;
+}
+
+ShapeCheck::Stats ShapeCheck::getStats()
+{
+  const Cache &c = cache();
+  Stats out;
+  out.checks = c.checks;
+  out.deferred = c.deferred;
+  out.analyzed = c.analyzed;
+  out.cacheHits = c.cacheHits;
+  return out;
 }
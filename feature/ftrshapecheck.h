@@ -16,7 +16,6 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  *
  */
-
 #ifndef FTR_SHAPECHECK_H
 #define FTR_SHAPECHECK_H
 
@@ -33,14 +32,43 @@ namespace ftr
    * Wanted to abstract away the idea of what a valid shape
    * in cadseer is. Using regular check and bopargcheck and
    * possible more.
+   * 
+   * Compounds are split into their non compound sub shapes and
+   * each distinct TShape is analyzed once, in parallel. Located
+   * copies share a TShape, so a pattern of 200 instances costs 1
+   * analysis. Results are cached until clearCache. In deferred
+   * mode only the cheap tests are run and the full analysis is
+   * left to an explicit validation pass. @see prj::Project::validateShapes
    */
   class ShapeCheck
   {
   public:
-    ShapeCheck(const TopoDS_Shape&);
+    enum class Mode
+    {
+      Full //!< analyze every check.
+      , Deferred //!< null and empty tests only.
+    };
+    
+    //! @brief statistics since the last resetStats.
+    struct Stats
+    {
+      std::size_t checks = 0; //!< ShapeCheck objects constructed.
+      std::size_t deferred = 0; //!< checks that skipped analysis.
+      std::size_t analyzed = 0; //!< sub shapes run through BRepCheck_Analyzer.
+      std::size_t cacheHits = 0; //!< sub shapes answered by the cache or a duplicate TShape.
+    };
+    
+    ShapeCheck(const TopoDS_Shape&); //!< uses global mode.
+    ShapeCheck(const TopoDS_Shape&, Mode);
     ~ShapeCheck();
     bool isValid(){return validity;}
-    const BRepCheck_Analyzer& getChecker();
+    const BRepCheck_Analyzer& getChecker(); //!< analyzer of whole shape. built on first call.
+    
+    static void setMode(Mode); //!< thread safe.
+    static Mode getMode(); //!< thread safe.
+    static void clearCache(); //!< call when no checks are running. releases cached TShapes.
+    static void resetStats(); //!< thread safe.
+    static Stats getStats(); //!< thread safe.
   private:
     bool validity = false;
     std::unique_ptr<ShapeCheckPrivate> shapeCheckPrivate;
@@ -17,6 +17,10 @@
  *
  */
 
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
 #include <boost/uuid/uuid.hpp>
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/breadth_first_search.hpp>
@@ -29,6 +33,7 @@
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "globalutilities.h"
 #include "tools/idtools.h"
@@ -54,8 +59,21 @@ struct VertexProperty
   
   uuid featureId;
   uuid shapeId;
+  bool alive = true; //!< false after removeFeatures, until the graph is compacted.
+};
+struct EdgeProperty
+{
+  EdgeProperty() :
+  featureId(gu::createNilId())
+  {}
+  
+  EdgeProperty(const uuid &featureIdIn) :
+  featureId(featureIdIn)
+  {}
+  
+  uuid featureId; //!< feature that made the connection. not always the owner of the source vertex.
 };
-typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, VertexProperty> Graph;
+typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::bidirectionalS, VertexProperty, EdgeProperty> Graph;
 typedef boost::graph_traits<Graph>::vertex_descriptor Vertex;
 typedef boost::graph_traits<Graph>::edge_descriptor Edge;
 typedef boost::graph_traits<Graph>::vertex_iterator VertexIterator;
@@ -84,27 +102,32 @@ private:
 struct ShapeIdRecord
 {
   uuid shapeId;
+  uuid featureId;
   Vertex graphVertex;
   
   ShapeIdRecord() :
   shapeId(gu::createNilId()),
+  featureId(gu::createNilId()),
   graphVertex(boost::graph_traits<Graph>::null_vertex())
   {}
   
-  ShapeIdRecord(const uuid &shapeIdIn, const Vertex &vertexIn) :
+  ShapeIdRecord(const uuid &shapeIdIn, const uuid &featureIdIn, const Vertex &vertexIn) :
   shapeId(shapeIdIn),
+  featureId(featureIdIn),
   graphVertex(vertexIn)
   {}
   
   //@{
   //! for tags
   struct ByShapeId{};
+  struct ByFeatureId{};
   //@}
 };
 
 using boost::multi_index_container;
 using boost::multi_index::indexed_by;
 using boost::multi_index::ordered_unique;
+using boost::multi_index::ordered_non_unique;
 using boost::multi_index::tag;
 using boost::multi_index::member;
 typedef multi_index_container
@@ -116,6 +139,11 @@ typedef multi_index_container
     <
       tag<ShapeIdRecord::ByShapeId>,
       member<ShapeIdRecord, uuid, &ShapeIdRecord::shapeId>
+    >,
+    ordered_non_unique
+    <
+      tag<ShapeIdRecord::ByFeatureId>,
+      member<ShapeIdRecord, uuid, &ShapeIdRecord::featureId>
     >
   >
 > IdMap;
@@ -129,7 +157,10 @@ namespace ftr
   {
   public:
     Graph graph;
-    IdMap idMap;
+    IdMap idMap; //!< live vertices only.
+    //! connections by the feature that made them. may hold connections already gone.
+    std::unordered_multimap<uuid, std::pair<Vertex, Vertex>, boost::hash<uuid>> connectionMap;
+    std::size_t deadCount = 0; //!< vertices removed but still in graph.
     
     bool hasShape(const boost::uuids::uuid &shapeIdIn) const
     {
@@ -147,6 +178,54 @@ namespace ftr
       return it->graphVertex;
     }
     
+    bool hasFeature(const uuid &featureIdIn) const
+    {
+      typedef IdMap::index<ShapeIdRecord::ByFeatureId>::type List;
+      const List &list = idMap.get<ShapeIdRecord::ByFeatureId>();
+      return list.find(featureIdIn) != list.end();
+    }
+    
+    //! rebuilds id and connection maps from the graph.
+    void rebuildIdMap()
+    {
+      idMap.clear();
+      connectionMap.clear();
+      for (auto its = boost::vertices(graph); its.first != its.second; ++its.first)
+      {
+        if (graph[*its.first].alive)
+          idMap.insert(ShapeIdRecord(graph[*its.first].shapeId, graph[*its.first].featureId, *its.first));
+      }
+      for (auto its = boost::edges(graph); its.first != its.second; ++its.first)
+        connectionMap.emplace(graph[*its.first].featureId, std::make_pair(boost::source(*its.first, graph), boost::target(*its.first, graph)));
+    }
+    
+    /*! @brief Drop removed vertices from the graph.
+     * 
+     * @details Copies the live vertices and their edges into a new graph
+     * in their original order and rebuilds the maps. Linear in the graph, so
+     * only called when dead vertices outnumber live ones. Survivors keep their
+     * relative order, so the search functions don't change their answers.
+     */
+    void compact()
+    {
+      Graph fresh;
+      std::vector<Vertex> oldToNew(boost::num_vertices(graph), boost::graph_traits<Graph>::null_vertex());
+      for (auto its = boost::vertices(graph); its.first != its.second; ++its.first)
+      {
+        if (graph[*its.first].alive)
+          oldToNew[*its.first] = boost::add_vertex(graph[*its.first], fresh);
+      }
+      //dead vertices have no edges.
+      for (auto its = boost::vertices(graph); its.first != its.second; ++its.first)
+      {
+        for (auto eits = boost::out_edges(*its.first, graph); eits.first != eits.second; ++eits.first)
+          boost::add_edge(oldToNew[*its.first], oldToNew[boost::target(*eits.first, graph)], graph[*eits.first], fresh);
+      }
+      graph.swap(fresh);
+      deadCount = 0;
+      rebuildIdMap();
+    }
+    
     void dumpIdMap() const
     {
       std::cout << std::endl << std::endl << "Shape history id map:" << std::endl;
@@ -165,7 +244,10 @@ namespace ftr
       boost::topological_sort(graph, std::back_inserter(vertices));
       
       for (auto rIt = vertices.rbegin(); rIt != vertices.rend(); ++rIt)
-        out.push_back(graph[*rIt].shapeId);
+      {
+        if (graph[*rIt].alive)
+          out.push_back(graph[*rIt].shapeId);
+      }
       
       return out;
     }
@@ -187,17 +269,22 @@ void ShapeHistory::clear()
 {
   shapeHistoryStow->graph.clear();
   shapeHistoryStow->idMap.clear();
+  shapeHistoryStow->connectionMap.clear();
+  shapeHistoryStow->deadCount = 0;
 }
 
 bool ShapeHistory::isEmpty() const
 {
-  return boost::num_vertices(shapeHistoryStow->graph) == 0;
+  return boost::num_vertices(shapeHistoryStow->graph) == shapeHistoryStow->deadCount;
 }
 
 void ShapeHistory::writeGraphViz(const std::string &fileName) const
 {
+  const Graph &graph = shapeHistoryStow->graph;
+  auto isAlive = [&graph](Vertex v) -> bool {return graph[v].alive;};
+  boost::filtered_graph<Graph, boost::keep_all, std::function<bool (Vertex)>> liveGraph(graph, boost::keep_all(), isAlive);
   std::ofstream file(fileName.c_str());
-  boost::write_graphviz(file, shapeHistoryStow->graph, VertexWriter(shapeHistoryStow->graph));
+  boost::write_graphviz(file, liveGraph, VertexWriter(graph));
   
   shapeHistoryStow->dumpIdMap();
 }
@@ -207,20 +294,70 @@ void ShapeHistory::addShape(const uuid &featureIdIn, const uuid &shapeIdIn)
   Vertex v = boost::add_vertex(shapeHistoryStow->graph);
   shapeHistoryStow->graph[v] = VertexProperty(featureIdIn, shapeIdIn);
   
-  shapeHistoryStow->idMap.insert(ShapeIdRecord(shapeIdIn, v));
+  shapeHistoryStow->idMap.insert(ShapeIdRecord(shapeIdIn, featureIdIn, v));
 }
 
-void ShapeHistory::addConnection(const uuid &sourceShapeIdIn, const uuid &targetShapeIdIn)
+void ShapeHistory::addConnection(const uuid &featureIdIn, const uuid &sourceShapeIdIn, const uuid &targetShapeIdIn)
 {
   assert(shapeHistoryStow->hasShape(sourceShapeIdIn));
   assert(shapeHistoryStow->hasShape(targetShapeIdIn));
   
-  boost::add_edge
-  (
-    shapeHistoryStow->findVertex(sourceShapeIdIn),
-    shapeHistoryStow->findVertex(targetShapeIdIn),
-    shapeHistoryStow->graph
-  );
+  Vertex source = shapeHistoryStow->findVertex(sourceShapeIdIn);
+  Vertex target = shapeHistoryStow->findVertex(targetShapeIdIn);
+  boost::add_edge(source, target, EdgeProperty(featureIdIn), shapeHistoryStow->graph);
+  shapeHistoryStow->connectionMap.emplace(featureIdIn, std::make_pair(source, target));
+}
+
+bool ShapeHistory::hasFeature(const uuid &featureIdIn) const
+{
+  return shapeHistoryStow->hasFeature(featureIdIn);
+}
+
+/* removal is in place. Vertices of removed features are cleared of
+ * edges and marked dead, so descriptors of all other vertices stay valid
+ * and the cost is proportional to what is removed. The graph is compacted
+ * once dead vertices outnumber live ones, so that linear pass is amortized.
+ */
+std::size_t ShapeHistory::removeFeatures(const std::vector<uuid> &featureIdsIn)
+{
+  std::vector<uuid> ids = featureIdsIn;
+  gu::uniquefy(ids);
+  
+  ShapeHistoryStow &hs = *shapeHistoryStow;
+  auto &byFeature = hs.idMap.get<ShapeIdRecord::ByFeatureId>();
+  std::size_t vertexCount = 0;
+  for (const auto &id : ids)
+  {
+    //connections made by the feature. source might belong to another feature.
+    auto connections = hs.connectionMap.equal_range(id);
+    for (auto it = connections.first; it != connections.second; ++it)
+    {
+      Vertex target = it->second.second;
+      boost::remove_out_edge_if
+      (
+        it->second.first,
+        [&](const Edge &e){return boost::target(e, hs.graph) == target && hs.graph[e].featureId == id;},
+        hs.graph
+      );
+    }
+    hs.connectionMap.erase(connections.first, connections.second);
+    
+    //shapes added by the feature. connections to them by other features go too.
+    auto records = byFeature.equal_range(id);
+    for (auto it = records.first; it != records.second; ++it)
+    {
+      boost::clear_vertex(it->graphVertex, hs.graph);
+      hs.graph[it->graphVertex].alive = false;
+      vertexCount++;
+    }
+    byFeature.erase(records.first, records.second);
+  }
+  
+  hs.deadCount += vertexCount;
+  if (hs.deadCount > boost::num_vertices(hs.graph) - hs.deadCount)
+    hs.compact();
+  
+  return vertexCount;
 }
 
 bool ShapeHistory::hasShape(const uuid &shapeIdIn) const
@@ -357,11 +494,7 @@ ShapeHistory ShapeHistory::createEvolveHistory(const uuid &shapeIdIn) const
   auto stowOut = std::make_shared<ShapeHistoryStow>();
   //need to transpose because we discard the reverse graph.
   boost::transpose_graph(filteredGraph, stowOut->graph);
-  
-  VertexIterator it, itEnd;
-  std::tie(it, itEnd) = boost::vertices(stowOut->graph);
-  for (; it != itEnd; ++it)
-    stowOut->idMap.insert(ShapeIdRecord(stowOut->graph[*it].shapeId, *it));
+  stowOut->rebuildIdMap();
   
   return ShapeHistory(stowOut);
 }
@@ -383,10 +516,7 @@ ShapeHistory ShapeHistory::createDevolveHistory(const uuid &shapeIdIn) const
   
   auto stowOut = std::make_shared<ShapeHistoryStow>();
   boost::copy_graph(filteredGraph, stowOut->graph);
-  VertexIterator it, itEnd;
-  std::tie(it, itEnd) = boost::vertices(stowOut->graph);
-  for (; it != itEnd; ++it)
-    stowOut->idMap.insert(ShapeIdRecord(stowOut->graph[*it].shapeId, *it));
+  stowOut->rebuildIdMap();
   
   return ShapeHistory(stowOut);
 }
@@ -396,7 +526,7 @@ const boost::uuids::uuid& ShapeHistory::getRootId() const
   const static uuid nil = gu::createNilId();
   for (auto its = boost::vertices(shapeHistoryStow->graph); its.first != its.second; ++its.first)
   {
-    if (boost::in_degree(*its.first, shapeHistoryStow->graph) == 0)
+    if (shapeHistoryStow->graph[*its.first].alive && boost::in_degree(*its.first, shapeHistoryStow->graph) == 0)
       return shapeHistoryStow->graph[*its.first].shapeId;
   }
   
@@ -429,6 +559,8 @@ prj::srl::spt::ShapeHistory ShapeHistory::serialOut() const
   std::tie(it, itEnd) = boost::vertices(shapeHistoryStow->graph);
   for (; it != itEnd; ++it)
   {
+    if (!shapeHistoryStow->graph[*it].alive)
+      continue;
     prj::srl::spt::HistoryVertex vOut
     (
       gu::idToString(shapeHistoryStow->graph[*it].featureId),
@@ -465,13 +597,15 @@ void ShapeHistory::serialIn(const prj::srl::spt::ShapeHistory &historyIn)
     Vertex v = boost::add_vertex(shapeHistoryStow->graph);
     shapeHistoryStow->graph[v].featureId = gu::stringToId(sv.featureId());
     shapeHistoryStow->graph[v].shapeId = gu::stringToId(sv.shapeId());
-    shapeHistoryStow->idMap.insert(ShapeIdRecord(shapeHistoryStow->graph[v].shapeId, v));
+    shapeHistoryStow->idMap.insert(ShapeIdRecord(shapeHistoryStow->graph[v].shapeId, shapeHistoryStow->graph[v].featureId, v));
   }
   
   for (const auto &se : historyIn.edges())
   {
     Vertex source = shapeHistoryStow->findVertex(gu::stringToId(se.sourceShapeId()));
     Vertex target = shapeHistoryStow->findVertex(gu::stringToId(se.targetShapeId()));
-    boost::add_edge(source, target, shapeHistoryStow->graph);
+    //connection owner isn't serialized. picks are never trimmed, so the source owner is good enough.
+    boost::add_edge(source, target, EdgeProperty(shapeHistoryStow->graph[source].featureId), shapeHistoryStow->graph);
+    shapeHistoryStow->connectionMap.emplace(shapeHistoryStow->graph[source].featureId, std::make_pair(source, target));
   }
 }
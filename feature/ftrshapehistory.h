@@ -21,6 +21,7 @@
 #define FTR_SHAPEHISTORY_H
 
 #include <memory>
+#include <vector>
 
 namespace boost{namespace uuids{struct uuid;}}
 
@@ -35,8 +36,9 @@ namespace ftr
   /*! @brief History of shape 'evolution'
    * 
    * Shape history will be used in 2 related ways.
-   * 1) will be destroyed and regenerated and used during every
-   * update to resolve identifying shapes.
+   * 1) will be maintained and used during every update to resolve
+   * identifying shapes. Features that update remove their part of
+   * the graph and fill it in again. see removeFeatures.
    * 2) will be used for storing picks. These picks will be a
    * 'sub set' of the 'update generated graph' related to a user pick. 
    * These picks will remain in the feature until the user 'deselects'
@@ -69,16 +71,30 @@ namespace ftr
     void addShape(const boost::uuids::uuid &featureIdIn, const boost::uuids::uuid &shapeIdIn);
     
     /*!
+     * @featureIdIn is the feature making the connection.
      * @sourceShapeIdIn should be child shape id.
      * @targetShapeIdIn should be parent shape id.
      */
-    void addConnection(const boost::uuids::uuid &sourceShapeIdIn, const boost::uuids::uuid &targetShapeIdIn);
+    void addConnection(const boost::uuids::uuid &featureIdIn, const boost::uuids::uuid &sourceShapeIdIn, const boost::uuids::uuid &targetShapeIdIn);
+    
+    /*! @brief Remove everything the features contributed.
+     * 
+     * @details Removes the shapes added by the features and the connections
+     * made by the features. Connections made by other features to the removed
+     * shapes go too, so callers should also remove the descendants
+     * of the features and fill them in again.
+     * @return number of shapes removed.
+     */
+    std::size_t removeFeatures(const std::vector<boost::uuids::uuid> &featureIdsIn);
     //@}
     
     //@{
     //! query functions.
     bool hasShape(const boost::uuids::uuid &shapeIdIn) const;
     
+    //! true if any shape was added by the feature.
+    bool hasFeature(const boost::uuids::uuid &featureIdIn) const;
+    
     /*! search for a descendant that is a result of @featureIdIn for the shape id @shapeIdIn.
      * @return id of shape or nil id if not found.
      */
@@ -36,6 +36,7 @@ namespace ftr
       ~Feature() override;
       
       void updateModel(const UpdatePayload&) override;
+      bool isConcurrentSafe() const override {return false;} //!< solvespace is not reentrant.
       Type getType() const override {return Type::Sketch;}
       const std::string& getTypeString() const override {return toString(Type::Sketch);}
       const QIcon& getIcon() const override {return icon;}
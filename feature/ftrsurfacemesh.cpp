@@ -29,6 +29,8 @@
 #include <osg/MatrixTransform>
 
 #include "globalutilities.h"
+#include "application/appapplication.h"
+#include "project/prjproject.h"
 #include "tools/occtools.h"
 #include "tools/idtools.h"
 #include "tools/featuretools.h"
@@ -306,7 +308,7 @@ void Feature::serialWrite(const boost::filesystem::path &dIn)
     , stow->csys.serialOut()
     , stow->source.serialOut()
     , stow->csysDragger.serialOut()
-    , stow->mesh->serialOut()
+    , stow->mesh->serialOut(buildFilePathName(dIn, "mshb"))
   );
   
   auto ct = static_cast<MeshType>(stow->meshType.getInt());
@@ -330,7 +332,7 @@ void Feature::serialRead(const prj::srl::sfms::SurfaceMesh &smIn)
   stow->csys.serialIn(smIn.csys());
   stow->source.serialIn(smIn.source());
   stow->csysDragger.serialIn(smIn.csysDragger());
-  stow->mesh->serialIn(smIn.surface());
+  stow->mesh->serialIn(smIn.surface(), app::instance()->getProject()->getSaveDirectory());
   
   if (smIn.parametersOCCT())
     stow->occtParameters.serialIn(smIn.parametersOCCT().get());
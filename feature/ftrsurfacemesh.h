@@ -50,6 +50,7 @@ namespace ftr
       ~Feature() override;
       
       void updateModel(const UpdatePayload&) override;
+      bool isConcurrentSafe() const override {return false;} //!< gmsh and netgen keep global state.
       void updateVisual() override;
       Type getType() const override {return Type::SurfaceMesh;}
       const std::string& getTypeString() const override {return toString(Type::SurfaceMesh);}
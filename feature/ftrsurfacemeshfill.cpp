@@ -22,6 +22,8 @@
 #include <osg/Switch>
 
 #include "globalutilities.h"
+#include "application/appapplication.h"
+#include "project/prjproject.h"
 #include "annex/annsurfacemesh.h"
 #include "library/lbrplabel.h"
 #include "parameter/prmparameter.h"
@@ -153,7 +155,7 @@ void SurfaceMeshFill::serialWrite(const boost::filesystem::path &dIn)
   prj::srl::smfs::SurfaceMeshFill so
   (
     Base::serialOut()
-    , mesh->serialOut()
+    , mesh->serialOut(buildFilePathName(dIn, "mshb"))
     , algorithm->serialOut()
     , algorithmLabel->serialOut()
   );
@@ -166,7 +168,7 @@ void SurfaceMeshFill::serialWrite(const boost::filesystem::path &dIn)
 void SurfaceMeshFill::serialRead(const prj::srl::smfs::SurfaceMeshFill &so)
 {
   Base::serialIn(so.base());
-  mesh->serialIn(so.mesh());
+  mesh->serialIn(so.mesh(), app::instance()->getProject()->getSaveDirectory());
   algorithm->serialIn(so.algorithm());
   algorithmLabel->serialIn(so.algorithmLabel());
 }
@@ -23,6 +23,8 @@
 #include <osg/MatrixTransform>
 
 #include "globalutilities.h"
+#include "application/appapplication.h"
+#include "project/prjproject.h"
 #include "annex/annsurfacemesh.h"
 #include "library/lbrplabel.h"
 #include "parameter/prmparameter.h"
@@ -172,7 +174,7 @@ void SurfaceReMesh::serialWrite(const boost::filesystem::path &dIn)
   prj::srl::srms::SurfaceReMesh so
   (
     Base::serialOut()
-    , mesh->serialOut()
+    , mesh->serialOut(buildFilePathName(dIn, "mshb"))
     , reMeshType->serialOut()
     , minEdgeLength->serialOut()
     , maxEdgeLength->serialOut()
@@ -191,7 +193,7 @@ void SurfaceReMesh::serialWrite(const boost::filesystem::path &dIn)
 void SurfaceReMesh::serialRead(const prj::srl::srms::SurfaceReMesh &so)
 {
   Base::serialIn(so.base());
-  mesh->serialIn(so.mesh());
+  mesh->serialIn(so.mesh(), app::instance()->getProject()->getSaveDirectory());
   reMeshType->serialIn(so.reMeshType());
   minEdgeLength->serialIn(so.minEdgeLength());
   maxEdgeLength->serialIn(so.maxEdgeLength());
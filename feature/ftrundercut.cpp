@@ -22,7 +22,6 @@
 #include <osg/Switch>
 #include <osg/Geometry>
 #include <osg/Point>
-#include <osgUtil/LineSegmentIntersector>
 
 #include "globalutilities.h"
 #include "library/lbrplabel.h"
@@ -31,6 +30,7 @@
 #include "tools/occtools.h"
 #include "tools/featuretools.h"
 #include "tools/tlsosgtools.h"
+#include "tools/tlsraycaster.h"
 #include "selection/slcvisitors.h"
 #include "feature/ftrupdatepayload.h"
 #include "modelviz/mdvnodemaskdefs.h"
@@ -312,22 +312,15 @@ void Feature::updateModel(const UpdatePayload &pIn)
     if (gridPoints.empty())
       throw std::runtime_error("Couldn't build grid points");
     
-    for (const auto &startPoint : gridPoints)
+    //build hierarchy once and cast all grid points against it.
+    tls::RayCaster caster;
+    caster.add(*childGeometry, inputTransform->getMatrix());
+    caster.build();
+    auto hits = caster.cast(gridPoints, stow->direction.getVector(), inputBound.radius() * 2.0);
+    for (const auto &h : hits)
     {
-      auto endPoint = startPoint + stow->direction.getVector() * inputBound.radius() * 2.0;
-      
-//       stow->intersectionPoints->push_back(startPoint); //temp for debug
-//       stow->intersectionPoints->push_back(endPoint); //temp for debug
-      
-      //visitor keeps a ref_ptr of intersector so have to 'new' it.
-      auto *intersector = new osgUtil::LineSegmentIntersector(startPoint, endPoint);
-      osgUtil::IntersectionVisitor visitor(intersector);
-      visitor.setTraversalMask(~mdv::edge);
-      inputTransform->accept(visitor);
-      const auto &intersections = intersector->getIntersections();
-      if (intersections.empty())
-        continue;
-      stow->intersectionPoints->push_back(intersections.begin()->getWorldIntersectPoint());
+      if (h)
+        stow->intersectionPoints->push_back(*h);
     }
     
     stow->drawArray->set(GL_POINTS, 0, stow->intersectionPoints->size());
@@ -100,6 +100,7 @@ prmObserver
   dragger->addDraggerCallback(ipCallback.get());
   
   refresh();
+  prmObserver->setDeferrable(); //scene graph changes.
   parameter->connect(*prmObserver);
 }
 
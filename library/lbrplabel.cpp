@@ -58,6 +58,7 @@ PLabel::PLabel(prm::Parameter* parameterIn)
   getOrCreateStateSet()->setMode(GL_LIGHTING, osg::StateAttribute::OFF);
   build();
   refresh();
+  pObserver->setDeferrable(); //scene graph changes.
   parameter->connect(*pObserver);
 }
 
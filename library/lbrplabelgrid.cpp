@@ -40,6 +40,7 @@ struct PLabelGridCallback::Stow
   {
     if (!dirtyParameters) return;
     observer = prm::Observer(std::bind(&Stow::valueHasChanged, this));
+    observer.setDeferrable(); //read in the update traversal.
     
     for (unsigned int index = 0; index < trsf->getNumChildren(); ++index)
     {
@@ -17,118 +17,153 @@
  *
  */
 
-/* this is a program for generating lods */
+/* this is a program for generating lods.
+ *
+ * Requests arrive on stdin and responses leave on stdout as frames,
+ * see lod/lodshared.h. The shape and ids are read from a shared memory
+ * block the application made. The result is osgb bytes in a new shared
+ * block named in the request, which the application removes.
+ */
 
 #include <iostream>
+#include <fstream>
+#include <iterator>
 #include <cassert>
+#include <cstring>
 #include <string>
-#include <chrono>
-#include <thread>
 
-#include <boost/filesystem.hpp>
-#include <boost/uuid/uuid.hpp>
+#include <boost/interprocess/streams/bufferstream.hpp>
 
 #include <Precision.hxx>
 #include <TopoDS_Shape.hxx>
 #include <BinTools.hxx>
 
 #include <osg/Switch>
-#include <osgDB/WriteFile>
 
 #include "tools/occtools.h"
 #include "annex/annshapeidhelper.h"
 #include "modelviz/mdvshapegeometry.h"
+#include "modelviz/mdvtessellationcache.h"
+#include "lod/lodshared.h"
 
-namespace bfs = boost::filesystem;
-using boost::uuids::uuid;
-
-int main(int /*argc*/, char ** /*argv*/)
+namespace
 {
-  std::vector<std::string> lines;
-  for(;;)
+  void respond(const lod::Response &response)
   {
-    try
+    std::string frame = lod::encode(response);
+    std::cout.write(frame.data(), frame.size());
+    std::cout.flush();
+  }
+  
+  void fail(const std::string &error)
+  {
+    lod::Response response;
+    response.error = error;
+    respond(response);
+  }
+  
+  //! tessellate or pull from cache. osgb bytes or error.
+  lod::Response generate(const lod::Request &request, std::string &bytes)
+  {
+    lod::Response out;
+    
+    std::shared_ptr<lod::SharedBuffer> input = lod::SharedBuffer::open(request.input);
+    lod::InputView view;
+    if (!lod::readInput(*input, view))
     {
-      std::string line;
-      while(std::getline(std::cin, line))
-      {
-        if (!line.empty())
-          lines.push_back(line);
-  //       std::cerr << "child process line: " << line << std::endl;
-        if (lines.size() == 7)
-          break;
-      }
-      if (lines.size() != 7)
-      {
-        std::cout << "FAIL lod generator: Wrong number of lines" << std::endl;
-        lines.clear();
-        continue;
-      }
-      assert(lines.at(0) == "BEGIN");
-      if (lines.at(0) != "BEGIN")
-      {
-        std::cout << "FAIL lod generator: First line is NOT 'BEGIN'" << std::endl;
-        lines.clear();
-        continue;
-      }
-      bfs::path occtPath = bfs::path(lines.at(1)); assert(bfs::exists(occtPath));
-      bfs::path osgPath = bfs::path(lines.at(2));
-      bfs::path idsPath = bfs::path(lines.at(3)); assert(bfs::exists(idsPath));
-      double linear = std::stod(lines.at(4)); assert(linear > Precision::Confusion());
-      double angular = std::stod(lines.at(5)); assert(angular > Precision::Confusion());
-      assert(lines.at(6) == "END");
-      if (lines.at(6) != "END")
-      {
-        std::cout << "FAIL lod generator: Last line is NOT 'END'" << std::endl;
-        lines.clear();
-        continue;
-      }
-      lines.clear();
-      
-  //     std::cerr << "got 7 parameters in child" << std::endl;
+      out.error = "bad input block";
+      return out;
+    }
     
-      TopoDS_Shape fileShape;
-      bool result = BinTools::Read(fileShape, occtPath.string().c_str());
-      if (!result)
-      {
-        std::cout << "FAIL lod generator: reading of occt file" << std::endl;
-        lines.clear();
-        continue;
-      }
-      occt::ShapeVector shapes = occt::mapShapes(fileShape);
-      
-      std::vector<uuid>ids = ann::ShapeIdHelper::read(idsPath);
-      assert(shapes.size() == ids.size());
-      ann::ShapeIdHelper helper;
-      std::size_t index = 0;
-      for (const auto &id : ids)
+    //application sets up cache directory, so it is there. '.scratch/tessellation'
+    std::string cacheKey = mdv::TessellationCache::buildKey(view.shape, view.shapeSize, view.ids, request.linear, request.angular);
+    mdv::TessellationCache &cache = mdv::tessellationCache();
+    cache.setDirectory(request.scratch);
+    if (cache.has(cacheKey))
+    {
+      std::ifstream cacheStream(cache.buildPath(cacheKey).string(), std::ios::binary);
+      bytes.assign((std::istreambuf_iterator<char>(cacheStream)), std::istreambuf_iterator<char>());
+      if (!bytes.empty())
       {
-        helper.add(id, shapes.at(index));
-        index++;
+        out.success = true;
+        out.cached = true;
+        return out;
       }
+    }
+    
+    TopoDS_Shape fileShape;
+    boost::interprocess::ibufferstream shapeStream(view.shape, view.shapeSize, std::ios::in | std::ios::binary);
+    if (!BinTools::Read(fileShape, shapeStream))
+    {
+      out.error = "reading of occt shape";
+      return out;
+    }
+    occt::ShapeVector shapes = occt::mapShapes(fileShape);
+    
+    assert(shapes.size() == view.ids.size());
+    if (shapes.size() != view.ids.size())
+    {
+      out.error = "shape and id count mismatch";
+      return out;
+    }
+    ann::ShapeIdHelper helper;
+    helper.reserve(view.ids.size());
+    for (std::size_t index = 0; index < view.ids.size(); ++index)
+      helper.add(view.ids.at(index), shapes.at(index));
+    
+    mdv::ShapeGeometryBuilder sBuilder(fileShape, helper);
+    sBuilder.go(request.linear, request.angular);
+    if (!sBuilder.success)
+    {
+      out.error = "builder failed";
+      return out;
+    }
+    bytes = lod::serialize(*sBuilder.out);
+    if (bytes.empty())
+    {
+      out.error = "serializing node";
+      return out;
+    }
+    cache.insert(cacheKey, *sBuilder.out);
+    
+    out.success = true;
+    return out;
+  }
+}
+
+int main(int /*argc*/, char ** /*argv*/)
+{
+  lod::Request request;
+  while (lod::read(std::cin, request))
+  {
+    try
+    {
+      assert(request.linear > Precision::Confusion());
+      assert(request.angular > Precision::Confusion());
       
-      mdv::ShapeGeometryBuilder sBuilder(fileShape, helper);
-      sBuilder.go(linear, angular);
-      if (!sBuilder.success)
-      {
-        std::cout << "FAIL lod generator: builder failed" << std::endl;
-        lines.clear();
-        continue;
-      }
-      if (!osgDB::writeNodeFile(*sBuilder.out, osgPath.string()))
+      std::string bytes;
+      lod::Response response = generate(request, bytes);
+      if (!response.success)
       {
-        std::cout << "FAIL lod generator: writing node file" << std::endl;
-        lines.clear();
+        fail(response.error);
         continue;
       }
       
-      std::cout << "SUCCESS lod generator" << std::endl;
+      std::shared_ptr<lod::SharedBuffer> output = lod::SharedBuffer::create(request.output, bytes.size());
+      std::memcpy(output->data(), bytes.data(), bytes.size());
+      output->release(); //application removes after reading.
+      response.size = bytes.size();
+      respond(response);
+    }
+    catch (const std::exception &e)
+    {
+      fail(std::string("caught exception: ") + e.what());
     }
     catch(...)
     {
-      std::cout << "FAIL lod generator: caught unknown error" << std::endl;
-      lines.clear();
-      continue;
+      fail("caught unknown error");
     }
   }
+  
+  return 0;
 }
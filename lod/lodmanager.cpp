@@ -19,11 +19,19 @@
 
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <tuple>
 
 #include <boost/filesystem.hpp>
 
+#include <QTextStream>
+
+#include <osg/Matrixd>
+
 #include "tools/idtools.h"
+#include "tools/tlsparallel.h"
 #include "application/appapplication.h"
+#include "application/appmainwindow.h"
 #include "preferences/preferencesXML.h"
 #include "preferences/prfmanager.h"
 #include "message/msgnode.h"
@@ -33,13 +41,16 @@
 #include "feature/ftrmessage.h"
 #include "feature/ftrstates.h"
 #include "feature/ftrbase.h"
+#include "modelviz/mdvtessellationcache.h"
+#include "viewer/vwrmessage.h"
+#include "viewer/vwrwidget.h"
 #include "lod/lodmanager.h"
 
 using namespace lod;
 
 namespace bfs = boost::filesystem;
 
-Manager::Manager(const std::string &parentArg)
+Manager::Manager(const std::string &parentArg, std::size_t workerCount)
 {
   bfs::path argPath = bfs::path(parentArg);
   bfs::path canonicalPath = bfs::canonical(argPath);
@@ -57,12 +68,24 @@ Manager::Manager(const std::string &parentArg)
   node->setHandler(std::bind(&msg::Sift::receive, sift.get(), std::placeholders::_1));
   setupDispatcher();
   
-  process = new QProcess(this);
-  process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
-  process->start(QString::fromStdString(lodPath.string()), QStringList());
-  connect(process, SIGNAL(readyReadStandardOutput()), this, SLOT(readyReadStdOutSlot()));
-  connect(process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(childFinishedSlot(int, QProcess::ExitStatus)));
-  connect(process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(childErrorSlot(QProcess::ProcessError)));
+  std::size_t staleBlocks = SharedBuffer::removeStale();
+  
+  clock.start();
+  
+  //leave a core for the gui.
+  if (workerCount == 0)
+    workerCount = std::max(tls::defaultThreadCount(), static_cast<std::size_t>(2)) - 1;
+  workers.resize(workerCount);
+  for (auto &w : workers)
+  {
+    w.process = new QProcess(this);
+    w.process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    connect(w.process, SIGNAL(started()), this, SLOT(childStartedSlot()));
+    connect(w.process, SIGNAL(readyReadStandardOutput()), this, SLOT(readyReadStdOutSlot()));
+    connect(w.process, SIGNAL(finished(int, QProcess::ExitStatus)), this, SLOT(childFinishedSlot(int, QProcess::ExitStatus)));
+    connect(w.process, SIGNAL(errorOccurred(QProcess::ProcessError)), this, SLOT(childErrorSlot(QProcess::ProcessError)));
+    start(w);
+  }
   
   logging = prf::manager().rootPtr->visual().mesh().logLOD().get();
   if (logging)
@@ -71,80 +94,225 @@ Manager::Manager(const std::string &parentArg)
     assert(bfs::exists(logFilePath));
     logFilePath /= "LODLog.txt";
     logStream.open(logFilePath.string(), std::ios_base::trunc | std::ios_base::out);
+    logStream << "LOD Manager: started " << workers.size() << " child processes" << std::endl;
+    if (staleBlocks != 0)
+      logStream << "LOD Manager: removed " << staleBlocks << " stale shared memory blocks" << std::endl;
   }
 }
 
 Manager::~Manager()
 {
-  //QProcess destructor should kill process.
+  //QProcess destructor should kill process. Don't restart it.
+  for (auto &w : workers)
+    w.process->disconnect(this);
+}
+
+QTextStream& Manager::getInfo(QTextStream &stream) const
+{
+  std::size_t busy = std::count_if(workers.begin(), workers.end(), [](const Worker &w){return w.working;});
+  std::size_t running = std::count_if(workers.begin(), workers.end(), [](const Worker &w)
+  {
+    return w.process->state() != QProcess::NotRunning;
+  });
+  stream << Qt::endl << QObject::tr("LOD Generation:") << Qt::endl
+  << "    " << QObject::tr("Child Processes: ") << workers.size()
+  << "    " << QObject::tr("Running: ") << running
+  << "    " << QObject::tr("Busy: ") << busy
+  << "    " << QObject::tr("Restarted: ") << stats.restarted << Qt::endl
+  << "    " << QObject::tr("Queued: ") << jobs.size() << Qt::endl
+  << "    " << QObject::tr("Completed: ") << stats.completed
+  << "    " << QObject::tr("Failed: ") << stats.failed
+  << "    " << QObject::tr("Cancelled: ") << stats.cancelled << Qt::endl
+  << "    " << QObject::tr("Child Tessellation Cache Hits: ") << stats.cached << Qt::endl;
+  const mdv::TessellationCache &cache = mdv::tessellationCache();
+  stream << "    " << QObject::tr("Tessellation Cache Hits: ") << cache.getHits()
+  << "    " << QObject::tr("Misses: ") << cache.getMisses()
+  << "    " << QObject::tr("Evicted: ") << cache.getEvictions()
+  << "    " << QObject::tr("Size (MB): ") << cache.getBytes() / (1024 * 1024)
+  << " / " << mdv::TessellationCache::maxBytes / (1024 * 1024) << Qt::endl;
+  if (stats.completed != 0)
+  {
+    double seconds = static_cast<double>(clock.elapsed()) / 1000.0;
+    stream
+    << "    " << QObject::tr("Throughput (per minute): ") << static_cast<double>(stats.completed) / seconds * 60.0 << Qt::endl
+    << "    " << QObject::tr("Average Latency (ms): ") << stats.totalLatency / static_cast<qint64>(stats.completed)
+    << "    " << QObject::tr("Max Latency (ms): ") << stats.maxLatency << Qt::endl
+    << "    " << QObject::tr("Average Processing (ms): ") << stats.totalProcessing / static_cast<qint64>(stats.completed) << Qt::endl;
+  }
+  
+  return stream;
+}
+
+/*! @brief Get the highest priority job.
+ * 
+ * @details visible features first, then features nearest the
+ * current eye position. Within a feature, coarser levels go first,
+ * as they are the first to be paged in when zooming toward it. Ties
+ * go to the newest request. Distance is measured from the eye to
+ * the feature's bounding sphere, so the eye inside a big feature
+ * counts as zero.
+ */
+std::vector<Manager::Job>::iterator Manager::nextJob()
+{
+  osg::Vec3d eye;
+  app::MainWindow *mainWindow = app::instance()->getMainWindow();
+  if (mainWindow && mainWindow->getViewer())
+    eye = osg::Matrixd::inverse(mainWindow->getViewer()->getViewSystem()).getTrans();
+  
+  auto rank = [&](const Job &j)
+  {
+    double distance = std::max((j.message.center - eye).length() - j.message.radius, 0.0);
+    return std::make_tuple(hidden.count(j.message.featureId), distance, j.message.rangeMin, ~j.sequence);
+  };
+  return std::min_element(jobs.begin(), jobs.end(), [&](const Job &lhs, const Job &rhs){return rank(lhs) < rank(rhs);});
+}
+
+//! start or restart the child process of a worker.
+void Manager::start(Worker &w)
+{
+  w.reader = ResponseReader();
+  w.process->start(QString::fromStdString(lodPath.string()), QStringList());
 }
 
 void Manager::send()
 {
-  if (childWorking || messages.empty())
+  for (auto &w : workers)
+  {
+    if (jobs.empty())
+      break;
+    send(w);
+  }
+}
+
+void Manager::send(Worker &w)
+{
+  if (w.working || jobs.empty() || w.process->state() != QProcess::Running)
     return;
   
-  cMessage = messages.back();
-  messages.pop_back();
-  cmValid = true;
-  childWorking = true;
+  auto it = nextJob();
+  w.job = *it;
+  jobs.erase(it);
+  w.valid = true;
+  w.working = true;
+  w.started = clock.elapsed();
   
-  std::ostringstream stream;
-  stream
-  << "BEGIN" << std::endl
-  << cMessage.filePathOCCT.string() << std::endl
-  << cMessage.filePathOSG.string() << std::endl
-  << cMessage.filePathIds.string() << std::endl
-  << std::to_string(cMessage.linear) << std::endl
-  << std::to_string(cMessage.angular) << std::endl
-  << "END" << std::endl;
+  const Message &cMessage = w.job.message;
+  Request request;
+  request.input = cMessage.input->getName();
+  request.output = SharedBuffer::buildName();
+  request.scratch = cMessage.filePathOSG.parent_path().string();
+  request.linear = cMessage.linear;
+  request.angular = cMessage.angular;
+  w.output = request.output;
   
-  std::string temp = stream.str();
-  process->write(temp.c_str());
+  std::string frame = encode(request);
+  w.process->write(frame.data(), static_cast<qint64>(frame.size()));
+  
+  if (logging)
+    logStream << "LOD Manager: sending to child process: " << w.process->processId() << " " << cMessage.filePathOSG.string() << std::endl;
+}
+
+Manager::Worker* Manager::findWorker(QObject *objectIn)
+{
+  for (auto &w : workers)
+  {
+    if (w.process == objectIn)
+      return &w;
+  }
+  return nullptr;
+}
+
+//! a child is ready for work. Restarted children pick up the queue.
+void Manager::childStartedSlot()
+{
+  Worker *w = findWorker(sender());
+  assert(w);
+  if (!w)
+    return;
   
   if (logging)
-    logStream << "LOD Manager: sending to child process: " << cMessage.filePathOSG.string() << std::endl;
+    logStream << "LOD Manager: child process started: " << w->process->processId() << std::endl;
+  send(*w);
 }
 
 void Manager::readyReadStdOutSlot()
 {
+  Worker *w = findWorker(sender());
+  assert(w);
+  if (!w)
+    return;
+  
   if (logging)
-    logStream << "LOD Manager: ready to read child process: " << std::endl;
+    logStream << "LOD Manager: ready to read child process: " << w->process->processId() << std::endl;
+  
+  QByteArray bytes = w->process->readAllStandardOutput();
+  w->reader.append(bytes.constData(), static_cast<std::size_t>(bytes.size()));
+  Response response;
+  while (w->reader.next(response))
+    finish(*w, response);
+  
+  std::string skipped = w->reader.takeSkipped();
+  if (!skipped.empty())
+    std::cout << "WARNING: unrecognized response from child process in Manager::readyReadStdOutSlot: "
+    << skipped << std::endl;
+}
+
+//! take the result of the worker's job and hand out the next one.
+void Manager::finish(Worker &w, const Response &response)
+{
+  if (!w.working)
+    return;
   
-  QByteArray lineBuffer;
-  while (process->canReadLine())
+  qint64 now = clock.elapsed();
+  osg::ref_ptr<osg::Node> node;
+  if (response.success && w.valid)
   {
-    lineBuffer = process->readLine();
-    if (!lineBuffer.isEmpty())
+    try
     {
-      if (lineBuffer.startsWith("FAIL"))
-      {
-        std::cout << lineBuffer.constData() << std::endl;
-        cmValid = false;
-        break;
-      }
-      else if(lineBuffer.startsWith("SUCCESS"))
-        break;
-      else
-      {
-        std::cout << "WARNING: unrecognized response from child process in Manager::readyReadStdOutSlot: "
-        << lineBuffer.toStdString() << std::endl;
-        lineBuffer.clear();
-        continue;
-      }
+      std::shared_ptr<SharedBuffer> output = SharedBuffer::open(w.output);
+      if (response.size <= output->size())
+        node = deserialize(output->data(), static_cast<std::size_t>(response.size));
+    }
+    catch (const std::exception &e)
+    {
+      std::cout << "WARNING: reading lod result in Manager::finish: " << e.what() << std::endl;
     }
   }
-  if (lineBuffer.isEmpty()) //what to do here?
-    return;
+  SharedBuffer::remove(w.output);
+  w.output.clear();
   
-  if (cmValid)
+  if (!response.success)
   {
-    msg::Message mOut(msg::Mask(msg::Response | msg::Construct | msg::LOD), cMessage);
+    std::cout << "FAIL lod generator: " << response.error << std::endl;
+    stats.failed++;
+  }
+  else if (!w.valid)
+    stats.cancelled++;
+  else if (!node)
+    stats.failed++;
+  else
+  {
+    qint64 latency = now - w.job.queued;
+    stats.completed++;
+    if (response.cached)
+      stats.cached++;
+    stats.totalLatency += latency;
+    stats.maxLatency = std::max(stats.maxLatency, latency);
+    stats.totalProcessing += now - w.started;
+    if (logging)
+      logStream << "LOD Manager: finished " << w.job.message.filePathOSG.string()
+      << " latency(ms): " << latency << " processing(ms): " << now - w.started << std::endl;
+    
+    Message result = w.job.message;
+    result.node = node;
+    result.input.reset(); //viewer doesn't need it.
+    msg::Message mOut(msg::Mask(msg::Response | msg::Construct | msg::LOD), result);
     app::instance()->queuedMessage(mOut); //ensures sync, not really necessary now.
   }
-  cmValid = false;
-  childWorking = false;
-  send();
+  w.job = Job(); //release shared input.
+  w.valid = false;
+  w.working = false;
+  send(w);
 }
 
 void Manager::childFinishedSlot(int exitCode, QProcess::ExitStatus exitStatus)
@@ -153,6 +321,31 @@ void Manager::childFinishedSlot(int exitCode, QProcess::ExitStatus exitStatus)
   << "lod generator process finished. Exit code is: " << exitCode
   << " exit status is: " << ((exitStatus == QProcess::NormalExit) ? ("Normal Exit") : ("Crash Exit"))
   << std::endl;
+  
+  //don't leave a job hanging on a dead child.
+  Worker *w = findWorker(sender());
+  if (w && w->working)
+  {
+    stats.failed++;
+    SharedBuffer::remove(w->output);
+    w->output.clear();
+    w->job = Job();
+    w->valid = false;
+    w->working = false;
+  }
+  
+  //restart it so crashes don't shrink the pool. A child dying
+  //over and over is broken, so give up on it eventually.
+  if (!w)
+    return;
+  w->crashes++;
+  if (w->crashes > maxCrashes)
+  {
+    std::cout << "WARNING: lod generator died " << w->crashes << " times. Not restarting it." << std::endl;
+    return;
+  }
+  stats.restarted++;
+  start(*w);
 }
 
 void Manager::childErrorSlot(QProcess::ProcessError error)
@@ -182,13 +375,30 @@ void Manager::setupDispatcher()
         msg::Response | msg::Feature | msg::Status
         , std::bind(&Manager::featureStateChangedDispatched, this, std::placeholders::_1)
       )
+      , std::make_pair
+      (
+        msg::Response | msg::View | msg::Show | msg::ThreeD
+        , std::bind(&Manager::shownThreeDDispatched, this, std::placeholders::_1)
+      )
+      , std::make_pair
+      (
+        msg::Response | msg::View | msg::Hide | msg::ThreeD
+        , std::bind(&Manager::hiddenThreeDDispatched, this, std::placeholders::_1)
+      )
     }
   );
 }
 
 void Manager::constructLODRequestDispatched(const msg::Message &mIn)
 {
-  messages.push_back(mIn.getLOD());
+  Job j;
+  j.message = mIn.getLOD();
+  assert(j.message.input);
+  if (!j.message.input)
+    return;
+  j.queued = clock.elapsed();
+  j.sequence = sequence++;
+  jobs.push_back(j);
   send();
 }
 
@@ -196,6 +406,7 @@ void Manager::featureRemovedDispatched(const msg::Message &mIn)
 {
   prj::Message pm = mIn.getPRJ();
   cleanMessages(pm.feature->getId());
+  hidden.erase(pm.feature->getId());
 }
 
 void Manager::featureStateChangedDispatched(const msg::Message &mIn)
@@ -211,20 +422,34 @@ void Manager::featureStateChangedDispatched(const msg::Message &mIn)
     cleanMessages(fm.featureId);
 }
 
+void Manager::shownThreeDDispatched(const msg::Message &mIn)
+{
+  hidden.erase(mIn.getVWR().featureId);
+}
+
+void Manager::hiddenThreeDDispatched(const msg::Message &mIn)
+{
+  hidden.insert(mIn.getVWR().featureId);
+}
+
 void Manager::cleanMessages(const boost::uuids::uuid &idIn)
 {
-  if (cmValid && (cMessage.featureId == idIn))
+  for (auto &w : workers)
   {
-    if (logging)
-      logStream << "LOD Manager: setting current message to invalid for id: " << gu::idToString(idIn) << std::endl;
-    cmValid = false;
+    if (w.working && w.valid && (w.job.message.featureId == idIn))
+    {
+      if (logging)
+        logStream << "LOD Manager: setting current message to invalid for id: " << gu::idToString(idIn) << std::endl;
+      w.valid = false;
+    }
   }
   
-  for (auto it = messages.begin(); it != messages.end();)
+  for (auto it = jobs.begin(); it != jobs.end();)
   {
-    if (it->featureId == idIn)
+    if (it->message.featureId == idIn)
     {
-      it = messages.erase(it);
+      it = jobs.erase(it);
+      stats.cancelled++;
       if (logging)
         logStream << "LOD Manager: cleaning message for id: " << gu::idToString(idIn) << std::endl;
     }
@@ -22,14 +22,18 @@
 
 #include <memory>
 #include <fstream>
+#include <set>
 
 #include <QObject>
 #include <QProcess> //for enums.
+#include <QElapsedTimer>
 
 #include "lod/lodmessage.h"
+#include "lod/lodshared.h"
 #include "message/msgmessage.h"
 
 class QTimer;
+class QTextStream;
 namespace msg{struct Node; struct Sift;}
 
 namespace lod
@@ -46,27 +50,73 @@ namespace lod
   /**
   * @brief Manage the external generation of lods
   * 
-  * ref class owned by application.
+  * ref class owned by application. A pool of child
+  * processes is started and queued lod requests are
+  * handed out to idle children. Requests for visible
+  * features nearest the eye are handed out first. Children
+  * that die are restarted, up to maxCrashes times each.
+  * Children get the shape and return the result
+  * through shared memory. see lod/lodshared.h.
   */
   class Manager : public QObject
   {
     Q_OBJECT
   public:
     Manager() = delete;
-    Manager(const std::string&);
+    Manager(const std::string&, std::size_t = 0); //!< 0 worker count uses all but one core.
     virtual ~Manager() override;
+    QTextStream& getInfo(QTextStream&) const;
   private:
+    //! a queued lod request.
+    struct Job
+    {
+      Message message;
+      qint64 queued = 0; //!< clock time in milliseconds when queued.
+      std::size_t sequence = 0; //!< order of arrival.
+    };
+    //! one child process and its current job.
+    struct Worker
+    {
+      QProcess *process = nullptr;
+      Job job; //!< current job being processed by child.
+      bool valid = false; //!< current job still wanted. see cleanMessages.
+      bool working = false;
+      qint64 started = 0; //!< clock time in milliseconds when sent to child.
+      std::string output; //!< shared block name for the current job's result.
+      ResponseReader reader; //!< framed responses from child stdout.
+      std::size_t crashes = 0; //!< times this child died. see maxCrashes.
+    };
+    //! throughput and latency counters.
+    struct Stats
+    {
+      std::size_t completed = 0; //!< successful and still valid.
+      std::size_t failed = 0; //!< child reported failure.
+      std::size_t cancelled = 0; //!< removed from queue or result discarded.
+      std::size_t cached = 0; //!< completed by child from tessellation cache.
+      std::size_t restarted = 0; //!< children started again after dying.
+      qint64 totalLatency = 0; //!< milliseconds from queue to completion for completed.
+      qint64 maxLatency = 0;
+      qint64 totalProcessing = 0; //!< milliseconds spent in children for completed.
+    };
+    
     boost::filesystem::path lodPath; //!< path to external application
-    std::vector<Message> messages; //message queue of all lods to be generated.
-    Message cMessage; //!< current message being processed by child.
-    bool cmValid = false; //!< current Message valid
+    std::vector<Job> jobs; //queue of all lods to be generated.
+    std::vector<Worker> workers;
+    std::set<boost::uuids::uuid> hidden; //!< features hidden in the viewer. lower priority.
+    static constexpr std::size_t maxCrashes = 5; //!< a child dying more than this is left dead.
+    std::size_t sequence = 0;
+    QElapsedTimer clock;
+    Stats stats;
     bool logging = false; //!< enable logging see constructor.
     std::ofstream logStream;
-    bool childWorking = false;
     
+    void start(Worker&);
     void send();
+    void send(Worker&);
+    std::vector<Job>::iterator nextJob();
     void cleanMessages(const boost::uuids::uuid&);
-    QProcess *process = nullptr;
+    Worker* findWorker(QObject*);
+    void finish(Worker&, const Response&);
     
     std::unique_ptr<msg::Node> node;
     std::unique_ptr<msg::Sift> sift;
@@ -74,8 +124,11 @@ namespace lod
     void constructLODRequestDispatched(const msg::Message &);
     void featureRemovedDispatched(const msg::Message &);
     void featureStateChangedDispatched(const msg::Message &);
+    void shownThreeDDispatched(const msg::Message &);
+    void hiddenThreeDDispatched(const msg::Message &);
     
   private Q_SLOTS:
+    void childStartedSlot();
     void readyReadStdOutSlot();
     void childFinishedSlot(int, QProcess::ExitStatus);
     void childErrorSlot(QProcess::ProcessError);
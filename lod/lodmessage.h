@@ -21,10 +21,14 @@
 
 #include <set>
 #include <map>
+#include <memory>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/uuid/uuid.hpp>
 
+#include <osg/Node>
+#include <osg/Vec3d>
+
 namespace lod
 {
 //   /**
@@ -64,6 +68,8 @@ namespace lod
 //     Status status = Status::Queued;
 //   };
   
+  class SharedBuffer;
+  
   /**
   * @brief message to generate all lods for a shape.
   */
@@ -73,18 +79,16 @@ namespace lod
     Message
     (
       const boost::uuids::uuid &featureIdIn,
-      const boost::filesystem::path &occtIn,
+      const std::shared_ptr<SharedBuffer> &inputIn,
       const boost::filesystem::path &osgIn,
-      const boost::filesystem::path &idsIn,
       double linearIn,
       double angularIn,
       double rangeMinIn,
       double rangeMaxIn
     ):
     featureId(featureIdIn),
-    filePathOCCT(occtIn),
+    input(inputIn),
     filePathOSG(osgIn),
-    filePathIds(idsIn),
     linear(linearIn),
     angular(angularIn),
     rangeMin(rangeMinIn),
@@ -92,13 +96,15 @@ namespace lod
     {}
     
     boost::uuids::uuid featureId;
-    boost::filesystem::path filePathOCCT; //binary occt file containing input shape.
-    boost::filesystem::path filePathOSG; //binary osg file containing output.
-    boost::filesystem::path filePathIds; //file containing ids.
+    std::shared_ptr<SharedBuffer> input; //!< shape and ids. see lod::writeInput. removed with last message.
+    boost::filesystem::path filePathOSG; //!< paged lod file name. nothing written there.
+    osg::ref_ptr<osg::Node> node; //!< generated lod. only in response.
     double linear; //!< the linear deflection.
     double angular; //!< the angular deflection.
     double rangeMin; //!< minimum range
     double rangeMax; //!< maximum range
+    osg::Vec3d center; //!< world bound center of the feature. queue priority.
+    double radius = 0.0; //!< world bound radius of the feature. queue priority.
   };
 }
 
@@ -0,0 +1,427 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <sstream>
+#include <iomanip>
+#include <cerrno>
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/shared_memory_object.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/interprocess/streams/bufferstream.hpp>
+
+#include <osg/Node>
+#include <osgDB/Registry>
+#include <osgDB/ReaderWriter>
+
+#include "tools/idtools.h"
+#include "lod/lodshared.h"
+
+using namespace lod;
+namespace bip = boost::interprocess;
+
+namespace
+{
+  const char magic[4] = {'C', 'S', 'L', 'D'};
+  const std::uint32_t requestType = 1;
+  const std::uint32_t responseType = 2;
+  const std::uint32_t maxPayload = 1 << 20; //!< payloads are a few names. anything bigger is garbage.
+  const std::size_t headerSize = sizeof(magic) + 2 * sizeof(std::uint32_t);
+  const std::string namePrefix = "cadseer_lod_";
+  
+  template <typename T>
+  void put(std::string &out, const T &value)
+  {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+  }
+  
+  void putString(std::string &out, const std::string &value)
+  {
+    put(out, static_cast<std::uint32_t>(value.size()));
+    out.append(value);
+  }
+  
+  //! bounds checked reading of a payload.
+  struct Cursor
+  {
+    const char *data;
+    std::size_t size;
+    std::size_t offset = 0;
+    
+    template <typename T>
+    bool get(T &value)
+    {
+      if (size - offset < sizeof(T))
+        return false;
+      std::memcpy(&value, data + offset, sizeof(T));
+      offset += sizeof(T);
+      return true;
+    }
+    
+    bool getString(std::string &value)
+    {
+      std::uint32_t length = 0;
+      if (!get(length) || size - offset < length)
+        return false;
+      value.assign(data + offset, length);
+      offset += length;
+      return true;
+    }
+  };
+  
+  std::string frame(std::uint32_t type, const std::string &payload)
+  {
+    std::string out(magic, sizeof(magic));
+    put(out, type);
+    put(out, static_cast<std::uint32_t>(payload.size()));
+    out.append(payload);
+    return out;
+  }
+  
+  bool decode(const char *data, std::size_t size, Request &out)
+  {
+    Cursor c{data, size};
+    return c.getString(out.input) && c.getString(out.output) && c.getString(out.scratch)
+    && c.get(out.linear) && c.get(out.angular);
+  }
+  
+  bool decode(const char *data, std::size_t size, Response &out)
+  {
+    Cursor c{data, size};
+    std::uint8_t success = 0;
+    std::uint8_t cached = 0;
+    if (!(c.get(success) && c.get(cached) && c.get(out.size) && c.getString(out.error)))
+      return false;
+    out.success = success != 0;
+    out.cached = cached != 0;
+    return true;
+  }
+  
+  //! shape size and id count at the front of an input block.
+  struct InputHeader
+  {
+    std::uint64_t shapeSize;
+    std::uint64_t idCount;
+  };
+}
+
+struct SharedBuffer::Stow
+{
+  bip::shared_memory_object object;
+  bip::mapped_region region;
+};
+
+SharedBuffer::SharedBuffer(const std::string &nameIn, std::unique_ptr<Stow> stowIn, bool ownerIn)
+: name(nameIn)
+, stow(std::move(stowIn))
+, owner(ownerIn)
+{}
+
+SharedBuffer::~SharedBuffer()
+{
+  stow.reset(); //unmap before remove.
+  if (owner)
+    remove(name);
+}
+
+/*! @brief Create and map a block for writing.
+ * 
+ * @details A stale block with the same name, from a crashed
+ * process, is replaced.
+ */
+std::shared_ptr<SharedBuffer> SharedBuffer::create(const std::string &nameIn, std::size_t sizeIn)
+{
+  bip::shared_memory_object::remove(nameIn.c_str());
+  auto s = std::make_unique<Stow>();
+  try
+  {
+    s->object = bip::shared_memory_object(bip::create_only, nameIn.c_str(), bip::read_write);
+    //zero size can't be mapped.
+    s->object.truncate(static_cast<bip::offset_t>(std::max(sizeIn, static_cast<std::size_t>(1))));
+    s->region = bip::mapped_region(s->object, bip::read_write);
+  }
+  catch (...)
+  {
+    bip::shared_memory_object::remove(nameIn.c_str());
+    throw;
+  }
+  return std::shared_ptr<SharedBuffer>(new SharedBuffer(nameIn, std::move(s), true));
+}
+
+//! map an existing block read only.
+std::shared_ptr<SharedBuffer> SharedBuffer::open(const std::string &nameIn)
+{
+  auto s = std::make_unique<Stow>();
+  s->object = bip::shared_memory_object(bip::open_only, nameIn.c_str(), bip::read_only);
+  s->region = bip::mapped_region(s->object, bip::read_only);
+  return std::shared_ptr<SharedBuffer>(new SharedBuffer(nameIn, std::move(s), false));
+}
+
+bool SharedBuffer::remove(const std::string &nameIn)
+{
+  return bip::shared_memory_object::remove(nameIn.c_str());
+}
+
+/*! @brief Unique name for a new block.
+ * 
+ * @details Short, some systems limit shared memory names to 31 characters.
+ * Carries the pid of the application so removeStale can tell
+ * blocks of a crashed application from blocks of a running one.
+ * Blocks are always named by the application, even the ones
+ * created by the generator.
+ */
+std::string SharedBuffer::buildName()
+{
+  boost::uuids::uuid id = gu::createRandomId();
+  std::ostringstream stream;
+  stream << namePrefix << std::hex << ::getpid() << '_' << std::setfill('0');
+  for (std::size_t index = 0; index < 4; ++index)
+    stream << std::setw(2) << static_cast<int>(id.data[index]);
+  return stream.str();
+}
+
+/*! @brief Remove blocks left behind by applications that are gone.
+ * 
+ * @return number of blocks removed.
+ * @details Blocks are only removed by their owner, so a crash leaves
+ * them in /dev/shm until reboot. Blocks of running applications
+ * are left alone. Nothing happens where shared memory isn't
+ * backed by /dev/shm.
+ */
+std::size_t SharedBuffer::removeStale()
+{
+  namespace bfs = boost::filesystem;
+  
+  std::size_t out = 0;
+  boost::system::error_code ec;
+  bfs::directory_iterator it(bfs::path("/dev/shm"), ec);
+  if (ec)
+    return out;
+  std::vector<std::string> stale;
+  for (; it != bfs::directory_iterator(); it.increment(ec))
+  {
+    if (ec)
+      break;
+    std::string name = it->path().filename().string();
+    if (name.compare(0, namePrefix.size(), namePrefix) != 0)
+      continue;
+    std::istringstream stream(name.substr(namePrefix.size()));
+    long pid = 0;
+    char separator = 0;
+    if (!(stream >> std::hex >> pid >> separator) || separator != '_' || pid <= 0)
+      continue; //not ours or from before pids were in the name.
+    if (pid == static_cast<long>(::getpid()))
+      continue;
+    if (::kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH)
+      continue; //alive or can't tell.
+    stale.push_back(name);
+  }
+  for (const auto &name : stale)
+  {
+    if (remove(name))
+      out++;
+  }
+  return out;
+}
+
+char* SharedBuffer::data()
+{
+  return static_cast<char*>(stow->region.get_address());
+}
+
+const char* SharedBuffer::data() const
+{
+  return static_cast<const char*>(stow->region.get_address());
+}
+
+std::size_t SharedBuffer::size() const
+{
+  return stow->region.get_size();
+}
+
+std::shared_ptr<SharedBuffer> lod::writeInput(const std::string &shapeBytes, const std::vector<boost::uuids::uuid> &ids)
+{
+  InputHeader header{static_cast<std::uint64_t>(shapeBytes.size()), static_cast<std::uint64_t>(ids.size())};
+  std::size_t idBytes = ids.size() * sizeof(boost::uuids::uuid::data);
+  auto out = SharedBuffer::create(SharedBuffer::buildName(), sizeof(header) + shapeBytes.size() + idBytes);
+  char *cursor = out->data();
+  std::memcpy(cursor, &header, sizeof(header));
+  cursor += sizeof(header);
+  std::memcpy(cursor, shapeBytes.data(), shapeBytes.size());
+  cursor += shapeBytes.size();
+  for (const auto &id : ids)
+  {
+    std::memcpy(cursor, id.data, sizeof(id.data));
+    cursor += sizeof(id.data);
+  }
+  return out;
+}
+
+bool lod::readInput(const SharedBuffer &buffer, InputView &out)
+{
+  InputHeader header;
+  if (buffer.size() < sizeof(header))
+    return false;
+  std::memcpy(&header, buffer.data(), sizeof(header));
+  std::size_t idBytes = header.idCount * sizeof(boost::uuids::uuid::data);
+  if (buffer.size() - sizeof(header) < header.shapeSize + idBytes)
+    return false;
+  
+  out.shape = buffer.data() + sizeof(header);
+  out.shapeSize = header.shapeSize;
+  out.ids.resize(header.idCount);
+  const char *cursor = out.shape + out.shapeSize;
+  for (auto &id : out.ids)
+  {
+    std::memcpy(id.data, cursor, sizeof(id.data));
+    cursor += sizeof(id.data);
+  }
+  return true;
+}
+
+//! empty on failure.
+std::string lod::serialize(const osg::Node &node)
+{
+  osgDB::ReaderWriter *rw = osgDB::Registry::instance()->getReaderWriterForExtension("osgb");
+  if (!rw)
+    return std::string();
+  std::ostringstream stream(std::ios::out | std::ios::binary);
+  if (!rw->writeNode(node, stream).success())
+    return std::string();
+  return stream.str();
+}
+
+//! reads straight from the mapped bytes. null on failure.
+osg::ref_ptr<osg::Node> lod::deserialize(const char *data, std::size_t size)
+{
+  osgDB::ReaderWriter *rw = osgDB::Registry::instance()->getReaderWriterForExtension("osgb");
+  if (!rw)
+    return nullptr;
+  bip::ibufferstream stream(data, size, std::ios::in | std::ios::binary);
+  osgDB::ReaderWriter::ReadResult result = rw->readNode(stream);
+  if (!result.validNode())
+    return nullptr;
+  return result.getNode();
+}
+
+std::string lod::encode(const Request &request)
+{
+  std::string payload;
+  putString(payload, request.input);
+  putString(payload, request.output);
+  putString(payload, request.scratch);
+  put(payload, request.linear);
+  put(payload, request.angular);
+  return frame(requestType, payload);
+}
+
+std::string lod::encode(const Response &response)
+{
+  std::string payload;
+  put(payload, static_cast<std::uint8_t>(response.success));
+  put(payload, static_cast<std::uint8_t>(response.cached));
+  put(payload, response.size);
+  putString(payload, response.error);
+  return frame(responseType, payload);
+}
+
+bool lod::read(std::istream &stream, Request &out)
+{
+  for (;;)
+  {
+    //slide until the magic lines up.
+    char window[sizeof(magic)] = {0, 0, 0, 0};
+    if (!stream.read(window, sizeof(window)))
+      return false;
+    while (std::memcmp(window, magic, sizeof(magic)) != 0)
+    {
+      std::memmove(window, window + 1, sizeof(window) - 1);
+      if (!stream.get(window[sizeof(window) - 1]))
+        return false;
+    }
+    
+    std::uint32_t type = 0;
+    std::uint32_t length = 0;
+    if (!stream.read(reinterpret_cast<char*>(&type), sizeof(type)) || !stream.read(reinterpret_cast<char*>(&length), sizeof(length)))
+      return false;
+    if (length > maxPayload)
+      continue;
+    std::string payload(length, 0);
+    if (!stream.read(&payload[0], length))
+      return false;
+    if (type == requestType && decode(payload.data(), payload.size(), out))
+      return true;
+  }
+}
+
+void ResponseReader::append(const char *data, std::size_t size)
+{
+  buffer.append(data, size);
+}
+
+bool ResponseReader::next(Response &out)
+{
+  for (;;)
+  {
+    std::size_t start = buffer.find(magic, 0, sizeof(magic));
+    if (start == std::string::npos)
+    {
+      //keep a tail that might be the front of a magic.
+      std::size_t keep = std::min(buffer.size(), sizeof(magic) - 1);
+      skipped.append(buffer, 0, buffer.size() - keep);
+      buffer.erase(0, buffer.size() - keep);
+      return false;
+    }
+    skipped.append(buffer, 0, start);
+    buffer.erase(0, start);
+    if (buffer.size() < headerSize)
+      return false;
+    
+    std::uint32_t type = 0;
+    std::uint32_t length = 0;
+    std::memcpy(&type, buffer.data() + sizeof(magic), sizeof(type));
+    std::memcpy(&length, buffer.data() + sizeof(magic) + sizeof(type), sizeof(length));
+    if (length > maxPayload)
+    {
+      //not really a frame. step past this magic.
+      skipped.append(buffer, 0, 1);
+      buffer.erase(0, 1);
+      continue;
+    }
+    if (buffer.size() < headerSize + length)
+      return false;
+    
+    bool valid = (type == responseType) && decode(buffer.data() + headerSize, length, out);
+    buffer.erase(0, headerSize + length);
+    if (valid)
+      return true;
+  }
+}
+
+std::string ResponseReader::takeSkipped()
+{
+  std::string out;
+  out.swap(skipped);
+  return out;
+}
@@ -0,0 +1,139 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LOD_SHARED_H
+#define LOD_SHARED_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include <istream>
+
+#include <boost/uuid/uuid.hpp>
+
+#include <osg/ref_ptr>
+
+namespace osg{class Node;}
+
+namespace lod
+{
+  /**
+  * @brief Named shared memory block.
+  * 
+  * Transport between the application and the lod generator
+  * children. The creating side owns the block and removes
+  * it on destruction unless released. Opening side only maps.
+  * Construction throws boost::interprocess::interprocess_exception.
+  */
+  class SharedBuffer
+  {
+  public:
+    SharedBuffer() = delete;
+    SharedBuffer(const SharedBuffer&) = delete;
+    SharedBuffer& operator=(const SharedBuffer&) = delete;
+    ~SharedBuffer();
+    
+    static std::shared_ptr<SharedBuffer> create(const std::string&, std::size_t);
+    static std::shared_ptr<SharedBuffer> open(const std::string&);
+    static bool remove(const std::string&);
+    static std::string buildName(); //!< unique name for a new block.
+    static std::size_t removeStale(); //!< blocks of crashed applications.
+    
+    char* data();
+    const char* data() const;
+    std::size_t size() const;
+    const std::string& getName() const {return name;}
+    void release() {owner = false;} //!< other process now responsible for removal.
+  private:
+    struct Stow;
+    SharedBuffer(const std::string&, std::unique_ptr<Stow>, bool);
+    std::string name;
+    std::unique_ptr<Stow> stow;
+    bool owner;
+  };
+  
+  /*! @brief Shape and ids for the lod generator in one shared block.
+   * 
+   * @param shapeBytes is the shape from BinTools::Write.
+   * @param ids are in ShapeIdHelper order.
+   * @details Both lods of a feature use the same block.
+   */
+  std::shared_ptr<SharedBuffer> writeInput(const std::string &shapeBytes, const std::vector<boost::uuids::uuid> &ids);
+  
+  //! view into a block from writeInput. valid as long as the block.
+  struct InputView
+  {
+    const char *shape = nullptr;
+    std::size_t shapeSize = 0;
+    std::vector<boost::uuids::uuid> ids;
+  };
+  bool readInput(const SharedBuffer&, InputView&);
+  
+  //@{
+  //! osgb bytes.
+  std::string serialize(const osg::Node&);
+  osg::ref_ptr<osg::Node> deserialize(const char*, std::size_t);
+  //@}
+  
+  //! application to child. names of the shared blocks and deflections.
+  struct Request
+  {
+    std::string input; //!< shared block from writeInput.
+    std::string output; //!< shared block the child creates with osgb result.
+    std::string scratch; //!< project scratch directory for the tessellation cache.
+    double linear = 0.0;
+    double angular = 0.0;
+  };
+  
+  //! child to application.
+  struct Response
+  {
+    bool success = false;
+    bool cached = false; //!< from tessellation cache.
+    std::uint64_t size = 0; //!< osgb bytes in output block.
+    std::string error;
+  };
+  
+  /*! @brief Framed binary protocol over the child's stdin and stdout.
+   * 
+   * @details Frame is magic, type, payload length and payload. Same
+   * machine, so native byte order. Magic lets the reader skip stray
+   * text a library might print to stdout.
+   */
+  //@{
+  std::string encode(const Request&);
+  std::string encode(const Response&);
+  bool read(std::istream&, Request&); //!< blocking. false on end of stream or bad frame.
+  //@}
+  
+  //! accumulates child output and pulls out responses.
+  class ResponseReader
+  {
+  public:
+    void append(const char*, std::size_t);
+    bool next(Response&);
+    std::string takeSkipped(); //!< bytes that weren't part of a frame.
+  private:
+    std::string buffer;
+    std::string skipped;
+  };
+}
+
+#endif // LOD_SHARED_H
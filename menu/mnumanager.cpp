@@ -426,6 +426,7 @@ void Manager::Stow::setAllMenu()
       editBase.commandIds().push_back(55);
       editBase.commandIds().push_back(56);
       editBase.commandIds().push_back(57);
+      editBase.commandIds().push_back(106);
       editBase.commandIds().push_back(58);
       start.subMenus().push_back(editBase);
     }
@@ -755,6 +756,7 @@ void Manager::Stow::setAllToolbars()
       addCommand(53); //remove feature
       addCommand(56); //project update
       addCommand(57); //project force update
+      addCommand(106); //validate shapes
       addCommand(63); //preferences
       addCommand(51); //cancel command
     }
@@ -1877,4 +1879,14 @@ void Manager::Stow::setAllCommands()
     , QObject::tr("Create A Law Spine").toStdString() // toolTipText
     , msg::Request | msg::Construct | msg::LawSpine
   );
+  sc
+  (
+    106
+    , ":/resources/images/inspectCheckGeometry.svg"
+    , QObject::tr("Validate").toStdString() //icon text
+    , QObject::tr("Validate Shapes").toStdString() //status text
+    , QObject::tr("Runs Full Shape Checks On All Features. Use With Deferred Shape Checks").toStdString() //whats this text
+    , QObject::tr("Validate Shapes").toStdString() // toolTipText
+    , msg::Request | msg::Project | msg::Validate
+  );
 }
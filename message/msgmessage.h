@@ -70,7 +70,7 @@ namespace msg
     static const Mask Git(Mask().set(                           26));//!< git project integration
     static const Mask Freeze(Mask().set(                        27));//!< git modifier
     static const Mask Thaw(Mask().set(                          28));//!< git modifier
-//     static const Mask Cancel(Mask().set(                        29));//!< UNUSED
+    static const Mask Cancel(Mask().set(                        29));//!< project action. request only. stops a running model update
     static const Mask Done(Mask().set(                          30));//!< command manager
     static const Mask Command(Mask().set(                       31));//!< command manager
     static const Mask Active(Mask().set(                        32));//!< command manager
@@ -179,6 +179,7 @@ namespace msg
     static const Mask Mutate(Mask().set(                       135));//!< command
     static const Mask Section(Mask().set(                      136));//!< command
     static const Mask LawSpine(Mask().set(                     137));//!< command
+    static const Mask Validate(Mask().set(                     138));//!< project action. full shape checks.
 
     struct Stow; // forward declare see message/variant.h
     struct Message
@@ -17,6 +17,8 @@
  *
  */
 
+#include <cassert>
+
 #include <boost/signals2.hpp>
 
 #include "message/msgnode.h"
@@ -30,6 +32,23 @@ namespace msg
   };
 }
 
+namespace msg
+{
+  struct Deferral::Entry
+  {
+    const Node *node;
+    Message message;
+    bool blocked;
+    std::function<void ()> function; //!< set means a deferred call, not a message.
+  };
+}
+
+namespace
+{
+  //!< messages sent from a thread with an active deferral land here.
+  thread_local std::vector<msg::Deferral::Entry> *deferred = nullptr;
+}
+
 using namespace msg;
 
 Node::Node() : stow(std::make_unique<Stow>()) {}
@@ -49,11 +68,21 @@ void Node::setHandler(Handler hIn)
 
 void Node::send(const Message &mIn) const
 {
+  if (deferred)
+  {
+    deferred->push_back({this, mIn, false});
+    return;
+  }
   stow->signal(mIn);
 }
 
 void Node::sendBlocked(const Message &mIn) const
 {
+  if (deferred)
+  {
+    deferred->push_back({this, mIn, true});
+    return;
+  }
   std::vector<boost::signals2::shared_connection_block> blockers;
   for (const auto &c : stow->connections)
     blockers.emplace_back(c);
@@ -88,3 +117,56 @@ Node& msg::hub()
   n.setHub(true);
   return n;
 }
+
+Deferral::Deferral() = default;
+
+Deferral::~Deferral()
+{
+  if (deferred == &entries)
+    deferred = nullptr;
+}
+
+Deferral::Deferral(Deferral &&) = default;
+
+Deferral& Deferral::operator=(Deferral &&) = default;
+
+void Deferral::activate()
+{
+  assert(!deferred); //no nesting.
+  deferred = &entries;
+}
+
+void Deferral::deactivate()
+{
+  if (deferred == &entries)
+    deferred = nullptr;
+}
+
+bool msg::defer(const std::function<void ()> &fIn)
+{
+  if (!deferred)
+    return false;
+  deferred->push_back({nullptr, Message(), false, fIn});
+  return true;
+}
+
+bool Deferral::isEmpty() const
+{
+  return entries.empty();
+}
+
+void Deferral::flush()
+{
+  assert(deferred != &entries); //flush from the collecting thread would just collect again.
+  std::vector<Entry> local;
+  std::swap(local, entries);
+  for (const auto &e : local)
+  {
+    if (e.function)
+      e.function();
+    else if (e.blocked)
+      e.node->sendBlocked(e.message);
+    else
+      e.node->send(e.message);
+  }
+}
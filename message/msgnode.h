@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <vector>
+#include <functional>
 
 #include "message/msgmessage.h"
 
@@ -77,6 +78,61 @@ namespace msg
   
   //! Singleton message hub.
   Node& hub();
+  
+  /*! @class Deferral
+   * @brief Collects messages sent from a worker thread.
+   * 
+   * @details Nodes and the hub are not thread safe. While a
+   * deferral is active on a thread, any message sent through
+   * any node from that thread is stored instead of signaled.
+   * The owner calls flush from the gui thread to send the
+   * stored messages in their original order. Calls stored
+   * with @ref defer are made in that same order.
+   */
+  class Deferral
+  {
+  public:
+    Deferral();
+    ~Deferral();
+    Deferral(const Deferral&) = delete; //no copy
+    Deferral& operator=(const Deferral&) = delete; //no copy
+    Deferral(Deferral &&);
+    Deferral& operator=(Deferral &&);
+    
+    void activate(); //!< start collecting messages sent from the calling thread.
+    void deactivate(); //!< stop collecting messages sent from the calling thread.
+    bool isEmpty() const;
+    void flush(); //!< send and clear collected messages. Call from gui thread.
+    
+    struct Entry;
+  private:
+    std::vector<Entry> entries;
+  };
+  
+  /*! @brief Store a call in the deferral active on the calling thread.
+   * 
+   * @return false, without calling, when no deferral is active.
+   * @details For non message side effects of worker threads,
+   * like parameter observers, that have to happen on the gui thread.
+   */
+  bool defer(const std::function<void ()>&);
+  
+  /*! @class DeferralScope
+   * @brief Activates a deferral for the life of the scope.
+   * 
+   * @details Deactivates on destruction, so an exception
+   * leaving the scope doesn't leave the thread collecting.
+   */
+  class DeferralScope
+  {
+  public:
+    explicit DeferralScope(Deferral &dIn) : deferral(dIn) {deferral.activate();}
+    ~DeferralScope() {deferral.deactivate();}
+    DeferralScope(const DeferralScope&) = delete; //no copy
+    DeferralScope& operator=(const DeferralScope&) = delete; //no copy
+  private:
+    Deferral &deferral;
+  };
 }
 
 #endif // MSG_NODE_H
@@ -0,0 +1,110 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cassert>
+#include <algorithm>
+
+#include <osg/State>
+#include <osg/TexMat>
+
+#include "modelviz/mdvpsetcolors.h"
+
+using namespace mdv;
+
+PSetColors::PSetColors(std::size_t countIn)
+: count(countIn)
+, height(1)
+{
+  std::size_t rows = (std::max(count, static_cast<std::size_t>(1)) + width - 1) / width;
+  while (static_cast<std::size_t>(height) < rows)
+    height *= 2;
+  texels.resize(static_cast<std::size_t>(width) * height * 4, 255);
+  rowRevisions.resize(height, revision);
+}
+
+osg::Vec2 PSetColors::texel(std::size_t pSet)
+{
+  return osg::Vec2
+  (
+    static_cast<float>(pSet % width) + 0.5f
+    , static_cast<float>(pSet / width) + 0.5f
+  );
+}
+
+void PSetColors::apply(osg::StateSet &stateSet) const
+{
+  osg::Texture2D *texture = new osg::Texture2D();
+  texture->setTextureSize(width, height);
+  texture->setInternalFormat(GL_RGBA);
+  texture->setFilter(osg::Texture::MIN_FILTER, osg::Texture::NEAREST);
+  texture->setFilter(osg::Texture::MAG_FILTER, osg::Texture::NEAREST);
+  texture->setWrap(osg::Texture::WRAP_S, osg::Texture::CLAMP_TO_EDGE);
+  texture->setWrap(osg::Texture::WRAP_T, osg::Texture::CLAMP_TO_EDGE);
+  texture->setResizeNonPowerOfTwoHint(false);
+  texture->setDataVariance(osg::Object::DYNAMIC);
+  texture->setSubloadCallback(const_cast<PSetColors*>(this));
+  stateSet.setTextureAttributeAndModes(0, texture, osg::StateAttribute::ON);
+  
+  //texture coordinates are in texels.
+  osg::TexMat *texMat = new osg::TexMat(osg::Matrix::scale(1.0 / width, 1.0 / height, 1.0));
+  stateSet.setTextureAttribute(0, texMat);
+}
+
+void PSetColors::set(std::size_t pSet, const osg::Vec4 &color)
+{
+  assert(pSet < count);
+  GLubyte *out = &texels[pSet * 4];
+  for (int index = 0; index < 4; ++index)
+    out[index] = static_cast<GLubyte>(std::clamp(color[index], 0.0f, 1.0f) * 255.0f + 0.5f);
+  rowRevisions[pSet / width] = ++revision;
+}
+
+void PSetColors::setAll(const osg::Vec4 &color)
+{
+  ++revision;
+  for (std::size_t index = 0; index < count; ++index)
+  {
+    GLubyte *out = &texels[index * 4];
+    for (int channel = 0; channel < 4; ++channel)
+      out[channel] = static_cast<GLubyte>(std::clamp(color[channel], 0.0f, 1.0f) * 255.0f + 0.5f);
+  }
+  std::fill(rowRevisions.begin(), rowRevisions.end(), revision);
+}
+
+void PSetColors::load(const osg::Texture2D&, osg::State &state) const
+{
+  glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels.data());
+  uploaded[state.getContextID()] = revision;
+}
+
+void PSetColors::subload(const osg::Texture2D&, osg::State &state) const
+{
+  //called every time texture is applied, so get out fast when nothing changed.
+  unsigned int &current = uploaded[state.getContextID()];
+  if (current == revision)
+    return;
+  for (int row = 0; row < height; ++row)
+  {
+    if (rowRevisions[row] <= current)
+      continue;
+    const GLubyte *data = &texels[static_cast<std::size_t>(row) * width * 4];
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, row, width, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  }
+  current = revision;
+}
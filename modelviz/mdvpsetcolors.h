@@ -0,0 +1,65 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MDV_PSETCOLORS_H
+#define MDV_PSETCOLORS_H
+
+#include <vector>
+
+#include <osg/Texture2D>
+#include <osg/buffered_value>
+
+namespace mdv
+{
+  /*! @class PSetColors
+   * @brief Color per primitive set of a ShapeGeometry.
+   * 
+   * @details Colors live in a small rgba texture with 1 texel per
+   * primitive set. Every vertex carries the texture coordinate of
+   * its primitive set texel, so changing the color of a face changes
+   * 1 texel and only changed rows are uploaded. Highlighting costs the
+   * same no matter how many vertices a body has. Texture coordinates
+   * are in texels and scaled by the texture matrix added in apply.
+   */
+  class PSetColors : public osg::Texture2D::SubloadCallback
+  {
+  public:
+    static constexpr int width = 256; //!< texels per row.
+    
+    explicit PSetColors(std::size_t);
+    
+    static osg::Vec2 texel(std::size_t); //!< texture coordinate of primitive set in texels.
+    void apply(osg::StateSet&) const; //!< adds texture and texture matrix to unit 0.
+    void set(std::size_t, const osg::Vec4&);
+    void setAll(const osg::Vec4&);
+    std::size_t getCount() const {return count;}
+    
+    void load(const osg::Texture2D&, osg::State&) const override;
+    void subload(const osg::Texture2D&, osg::State&) const override;
+  private:
+    std::size_t count; //!< primitive sets.
+    int height; //!< rows. power of 2.
+    std::vector<GLubyte> texels; //!< rgba. row major.
+    std::vector<unsigned int> rowRevisions; //!< revision of last change to each row.
+    unsigned int revision = 1;
+    mutable osg::buffered_value<unsigned int> uploaded; //!< revision on the gpu for each context.
+  };
+}
+
+#endif // MDV_PSETCOLORS_H
@@ -38,9 +38,11 @@
 #include <osg/Point>
 
 #include "tools/idtools.h"
+#include "tools/tlsparallel.h"
 #include "annex/annshapeidhelper.h"
 #include "modelviz/mdvhiddenlineeffect.h"
 #include "modelviz/mdvshapegeometryprivate.h"
+#include "modelviz/mdvpsetcolors.h"
 #include "modelviz/mdvshapegeometry.h"
 #include "modelviz/mdvnodemaskdefs.h"
 
@@ -100,12 +102,11 @@ static bool writePSetPrimitive(osgDB::OutputStream& os, const mdv::ShapeGeometry
 {
   const PSetPrimitiveWrapper &pspw = sgIn.getPSetPrimitiveWrapper();
   
-  typedef PSetPrimitiveContainer::index<PSetPrimitiveRecord::ByPSet>::type List;
-  const List &list = pspw.pSetPrimitiveContainer.get<PSetPrimitiveRecord::ByPSet>();
-  
-  os << list.size() << os.BEGIN_BRACKET << std::endl;
-  for (const auto &r : list)
-    os << r.primitiveSetIndex << r.primitiveIndex << std::endl;
+  //1 range per primitive set. 32 bits is plenty for both indexes.
+  os << static_cast<unsigned int>(pspw.primitiveCount);
+  os << static_cast<unsigned int>(pspw.starts.size()) << os.BEGIN_BRACKET << std::endl;
+  for (std::size_t index = 0; index < pspw.starts.size(); ++index)
+    os << static_cast<unsigned int>(pspw.starts[index]) << static_cast<unsigned int>(pspw.pSets[index]) << std::endl;
   os << os.END_BRACKET << std::endl;
   
   return true;
@@ -115,21 +116,27 @@ static bool readPSetPrimitive(osgDB::InputStream& is, mdv::ShapeGeometry &sgIn)
 {
   std::shared_ptr<PSetPrimitiveWrapper> pspw(new PSetPrimitiveWrapper());
   
-  std::size_t size = 0;
+  unsigned int primitiveCount = 0;
+  unsigned int size = 0;
+  is >> primitiveCount;
   is >> size >> is.BEGIN_BRACKET;
-  for (std::size_t index = 0; index < size; ++index)
+  pspw->starts.reserve(size);
+  pspw->pSets.reserve(size);
+  for (unsigned int index = 0; index < size; ++index)
   {
-    std::size_t pSetIndex;
-    std::size_t pIndex;
-    is >> pSetIndex >> pIndex;
-    PSetPrimitiveRecord r;
-    r.primitiveSetIndex = pSetIndex;
-    r.primitiveIndex = pIndex;
-    pspw->pSetPrimitiveContainer.insert(r);
+    unsigned int start;
+    unsigned int pSetIndex;
+    is >> start >> pSetIndex;
+    pspw->starts.push_back(start);
+    pspw->pSets.push_back(pSetIndex);
   }
   is >> is.END_BRACKET;
+  pspw->primitiveCount = primitiveCount;
   
   sgIn.setPSetPrimitiveWrapper(pspw);
+  
+  //primitive sets and color are read by now. replaces the texture from the state set.
+  sgIn.buildPSetColors();
   return true;
 }
 
@@ -154,6 +161,11 @@ ShapeGeometry::ShapeGeometry(const ShapeGeometry &rhs, const CopyOp& copyOperati
 {
   if (rhs.idPSetWrapper)
     idPSetWrapper = std::shared_ptr<IdPSetWrapper>(new IdPSetWrapper(*rhs.idPSetWrapper));
+  pSetColors = rhs.pSetColors;
+}
+
+ShapeGeometry::~ShapeGeometry()
+{
 }
 
 void ShapeGeometry::setIdPSetWrapper(std::shared_ptr<IdPSetWrapper> &mapIn)
@@ -181,27 +193,26 @@ void ShapeGeometry::setColor(const Vec4& colorIn)
   //we are assuming that any callers have cleared any selection
   //before call this function. So don't worry about current color state.
   color = colorIn;
-  osg::Vec4Array *colors = dynamic_cast<osg::Vec4Array *>(_colorArray.get());
-  assert(colors);
-  for (auto &c : *colors)
-    c = color;
-  _colorArray->dirty();
+  if (pSetColors)
+    pSetColors->setAll(color);
+}
+
+void ShapeGeometry::buildPSetColors()
+{
+  pSetColors = new PSetColors(getNumPrimitiveSets());
+  pSetColors->setAll(color);
+  pSetColors->apply(*getOrCreateStateSet());
 }
 
 void ShapeGeometry::setColor(const boost::uuids::uuid &idIn, const osg::Vec4 &colorIn)
 {
-  if (!idPSetWrapper->hasId(idIn))
+  if (!pSetColors || !idPSetWrapper->hasId(idIn))
     return;
   std::size_t primitiveIndex = idPSetWrapper->findPSetFromId(idIn);
   
-  assert(primitiveIndex < getNumPrimitiveSets());
-  DrawElementsUInt *pSet = dynamic_cast<DrawElementsUInt *>(getPrimitiveSet(primitiveIndex));
-  assert(pSet);
-  osg::Vec4Array *colors = dynamic_cast<osg::Vec4Array *>(_colorArray.get());
-  assert(colors);
-  for (auto index : *pSet)
-    colors->at(index) = colorIn;
-  _colorArray->dirty();
+  //only touches 1 texel, vertex arrays stay on the gpu as they are.
+  assert(primitiveIndex < pSetColors->getCount());
+  pSetColors->set(primitiveIndex, colorIn);
 }
 
 void ShapeGeometry::setToColor(const boost::uuids::uuid &idIn)
@@ -300,13 +311,62 @@ void ShapeGeometryBuilder::go(double deflection, double angle)
     
     BRepMesh_IncrementalMesh(copiedShape, mprms);
 
+    /* 3 passes. Serial traversal collects faces and edges into slots in
+     * the same order as a recursive build. Slots are filled concurrently
+     * as they are independent. Then slots are concatenated into the
+     * geometry in order, so output doesn't depend upon thread count.
+     */
+    slots.clear();
     processed.Add(copiedShape);
-    if (copiedShape.ShapeType() == TopAbs_FACE)
-        faceConstruct(TopoDS::Face(copiedShape));
-    if (copiedShape.ShapeType() == TopAbs_EDGE)
-        edgeConstruct(TopoDS::Edge(copiedShape));
-    recursiveConstruct(copiedShape);
-    success = true;
+    if (copiedShape.ShapeType() == TopAbs_FACE || copiedShape.ShapeType() == TopAbs_EDGE)
+      collect(copiedShape, true);
+    recursiveCollect(copiedShape);
+    
+    tls::parallelFor(slots.size(), [&](std::size_t index)
+    {
+      Slot &slot = slots[index];
+      try
+      {
+        if (slot.shape.ShapeType() == TopAbs_FACE)
+          faceConstruct(slot);
+        else
+          edgeConstruct(slot);
+      }
+      catch(const Standard_Failure &error)
+      {
+        slot.fatal = true;
+        slot.error = std::string("OCC Error: failure building model vizualization. Message: ") + error.GetMessageString();
+      }
+      catch(const std::exception &error)
+      {
+        //root shape failure is fatal same as non root occt failure.
+        slot.fatal = slot.root;
+        slot.error = std::string("Problem building model vizualization. Message: ") + error.what();
+      }
+    }, threadCount);
+    
+    bool fatal = false;
+    for (const auto &slot : slots)
+    {
+      warnings.insert(warnings.end(), slot.warnings.begin(), slot.warnings.end());
+      if (slot.error.empty())
+        continue;
+      std::ostringstream stream;
+      stream << ((slot.fatal) ? "" : "Warning! ") << slot.error << std::endl;
+      if (slot.fatal)
+      {
+        errors.push_back(stream.str());
+        fatal = true;
+      }
+      else
+        warnings.push_back(stream.str());
+    }
+    if (!fatal)
+    {
+      concatenate(slots);
+      success = true;
+    }
+    slots.clear();
   }
   catch(const Standard_Failure &error)
   {
@@ -352,8 +412,10 @@ void ShapeGeometryBuilder::initialize()
     faceGeometry->setUseDisplayList(false);
 //     faceGeometry->setUseVertexBufferObjects(true);
 
-    faceGeometry->setColorArray(new osg::Vec4Array());
-    faceGeometry->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
+    //white modulated by the primitive set color texture.
+    faceGeometry->setColorArray(new osg::Vec4Array(1, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0f)));
+    faceGeometry->setColorBinding(osg::Geometry::BIND_OVERALL);
+    faceGeometry->setTexCoordArray(0, new osg::Vec2Array(), osg::Array::BIND_PER_VERTEX);
 
     faceGeometry->setNormalArray(new osg::Vec3Array());
     faceGeometry->setNormalBinding(osg::Geometry::BIND_PER_VERTEX);
@@ -381,8 +443,10 @@ void ShapeGeometryBuilder::initialize()
     edgeGeometry->setVertexArray(new osg::Vec3Array());
     edgeGeometry->setUseDisplayList(false);
     
-    edgeGeometry->setColorArray(new osg::Vec4Array());
-    edgeGeometry->setColorBinding(osg::Geometry::BIND_PER_VERTEX);
+    //white modulated by the primitive set color texture.
+    edgeGeometry->setColorArray(new osg::Vec4Array(1, osg::Vec4(1.0f, 1.0f, 1.0f, 1.0f)));
+    edgeGeometry->setColorBinding(osg::Geometry::BIND_OVERALL);
+    edgeGeometry->setTexCoordArray(0, new osg::Vec2Array(), osg::Array::BIND_PER_VERTEX);
     
     edgeGeometry->setIdPSetWrapper(idPSetWrapperEdge);
     edgeGeometry->setColor(osg::Vec4(0.0f, 0.0f, 0.0f, 1.0f));
@@ -414,7 +478,38 @@ void ShapeGeometryBuilder::initialize()
     vertexGeometry.release();
 }
 
-void ShapeGeometryBuilder::recursiveConstruct(const TopoDS_Shape &shapeIn)
+//! @brief Generated buffers for one face or edge.
+struct ShapeGeometryBuilder::Slot
+{
+  TopoDS_Shape shape;
+  boost::uuids::uuid id;
+  bool root = false; //!< the root shape is a face or edge.
+  std::vector<osg::Vec3> vertices;
+  std::vector<osg::Vec3> normals; //!< faces only.
+  std::vector<GLuint> indices; //!< relative to slot vertices.
+  std::size_t primitiveCount = 0; //!< triangles or line segments.
+  std::vector<std::string> warnings;
+  std::string error; //!< not empty means slot is skipped.
+  bool fatal = false; //!< error fails the whole build.
+};
+
+void ShapeGeometryBuilder::collect(const TopoDS_Shape &shapeIn, bool root)
+{
+  TopAbs_ShapeEnum type = shapeIn.ShapeType();
+  if (type == TopAbs_FACE && !shouldBuildFaces)
+    return;
+  if (type == TopAbs_EDGE && !shouldBuildEdges)
+    return;
+  
+  auto id = shapeIdHelper.find(shapeIn);
+  assert(id);
+  slots.emplace_back();
+  slots.back().shape = shapeIn;
+  slots.back().id = (id) ? *id : gu::createNilId();
+  slots.back().root = root;
+}
+
+void ShapeGeometryBuilder::recursiveCollect(const TopoDS_Shape &shapeIn)
 {
   for (TopoDS_Iterator it(shapeIn); it.More(); it.Next())
   {
@@ -434,39 +529,26 @@ void ShapeGeometryBuilder::recursiveConstruct(const TopoDS_Shape &shapeIn)
       (currentType == TopAbs_WIRE)
     )
     {
-      recursiveConstruct(currentShape);
+      recursiveCollect(currentShape);
       continue;
     }
-    try
+    if (currentType == TopAbs_FACE)
     {
-      if (currentType == TopAbs_FACE)
-      {
-        faceConstruct(TopoDS::Face(currentShape));
-        recursiveConstruct(currentShape);
-        continue;
-      }
-      if (currentType == TopAbs_EDGE)
-      {
-        edgeConstruct(TopoDS::Edge(currentShape));
-        recursiveConstruct(currentShape); // for obsolete vertices?
-      }
+      collect(currentShape, false);
+      recursiveCollect(currentShape);
+      continue;
     }
-    catch(const std::exception &error)
+    if (currentType == TopAbs_EDGE)
     {
-      std::ostringstream stream;
-      stream
-      << "Warning! Problem building model vizualization. Message: "
-      << error.what()
-      << std::endl;
-      warnings.push_back(stream.str());
+      collect(currentShape, false);
+      recursiveCollect(currentShape); // for obsolete vertices?
     }
   }
 }
 
-void ShapeGeometryBuilder::faceConstruct(const TopoDS_Face &faceIn)
+void ShapeGeometryBuilder::faceConstruct(Slot &slot) const
 {
-  if (!shouldBuildFaces)
-    return;
+  const TopoDS_Face &faceIn = TopoDS::Face(slot.shape);
   
   TopLoc_Location location;
   const Handle(Poly_Triangulation) &triangulation = BRep_Tool::Triangulation(faceIn, location);
@@ -488,16 +570,13 @@ void ShapeGeometryBuilder::faceConstruct(const TopoDS_Face &faceIn)
   }
 
   //vertices.
-  osg::Vec3Array *vertices = dynamic_cast<osg::Vec3Array *>(faceGeometry->getVertexArray());
-  osg::Vec4Array *colors = dynamic_cast<osg::Vec4Array *>(faceGeometry->getColorArray());
-  std::size_t offset = vertices->size();
+  slot.vertices.reserve(triangulation->NbNodes());
   for (int index = 1; index < triangulation->NbNodes() + 1; ++index)
   {
     gp_Pnt point = triangulation->Node(index);
     if(!identity)
       point.Transform(transformation);
-    vertices->push_back(osg::Vec3(point.X(), point.Y(), point.Z()));
-    colors->push_back(faceGeometry->getColor());
+    slot.vertices.push_back(osg::Vec3(point.X(), point.Y(), point.Z()));
   }
   
   //normals.
@@ -505,10 +584,10 @@ void ShapeGeometryBuilder::faceConstruct(const TopoDS_Face &faceIn)
   //wants to 'average' out normals across faces. so we go back to manual calculation
   //of surface normals.
   assert(triangulation->HasUVNodes());
-  osg::Vec3Array *normals = dynamic_cast<osg::Vec3Array *>(faceGeometry->getNormalArray());
   opencascade::handle<Geom_Surface> surface = BRep_Tool::Surface(faceIn);
   if (surface.IsNull())
     throw std::runtime_error("null surface in face construction");
+  slot.normals.reserve(triangulation->NbNodes());
   for (int index = 1; index < triangulation->NbNodes() + 1; ++index)
   {
     gp_Dir direction;
@@ -519,16 +598,14 @@ void ShapeGeometryBuilder::faceConstruct(const TopoDS_Face &faceIn)
       stream
       << "WARNING: GeomLib::NormEstim failed in mdv::ShapeGeometryBuilder::faceConstruct"
       << std::endl;
-      warnings.push_back(stream.str());
+      slot.warnings.push_back(stream.str());
     }
     if (!signalOrientation)
       direction.Reverse();
-    normals->push_back(osg::Vec3(direction.X(), direction.Y(), direction.Z()));
+    slot.normals.push_back(osg::Vec3(direction.X(), direction.Y(), direction.Z()));
   }
 
-  osg::ref_ptr<osg::DrawElementsUInt> indices = new osg::DrawElementsUInt
-    (GL_TRIANGLES, triangulation->NbTriangles() * 3);
-
+  slot.indices.resize(triangulation->NbTriangles() * 3);
   for (int index = 1; index < triangulation->NbTriangles() + 1; ++index)
   {
     int N1, N2, N3;
@@ -537,47 +614,29 @@ void ShapeGeometryBuilder::faceConstruct(const TopoDS_Face &faceIn)
     int factor = (index - 1) * 3;
     if (!signalOrientation)
     {
-      (*indices)[factor] = N3 - 1  + offset;
-      (*indices)[factor + 1] = N2 - 1 + offset;
-      (*indices)[factor + 2] = N1 - 1 + offset;
+      slot.indices[factor] = N3 - 1;
+      slot.indices[factor + 1] = N2 - 1;
+      slot.indices[factor + 2] = N1 - 1;
     }
     else
     {
-      (*indices)[factor] = N1 - 1 + offset;
-      (*indices)[factor + 1] = N2 - 1 + offset;
-      (*indices)[factor + 2] = N3 - 1 + offset;
+      slot.indices[factor] = N1 - 1;
+      slot.indices[factor + 1] = N2 - 1;
+      slot.indices[factor + 2] = N3 - 1;
     }
-    
-    //store primitiveset index and vertex indes into map.
-    PSetPrimitiveRecord record;
-    record.primitiveSetIndex = faceGeometry->getNumPrimitiveSets();
-    record.primitiveIndex = primitiveCountFace;
-    pSetPrimitiveWrapperFace->pSetPrimitiveContainer.insert(record);
-    primitiveCountFace++;
   }
-  faceGeometry->addPrimitiveSet(indices.get());
-  boost::uuids::uuid id = *shapeIdHelper.find(faceIn);
-  std::size_t lastPrimitiveIndex = faceGeometry->getNumPrimitiveSets() - 1;
-  if (!idPSetWrapperFace->hasId(id))
-  {
-    IdPSetRecord record;
-    record.id = id;
-    record.primitiveSetIndex = lastPrimitiveIndex;
-    idPSetWrapperFace->idPSetContainer.insert(record);
-  }
-  else
-    //ensure that the faces have the same primitive index between lod calls.
-    assert(lastPrimitiveIndex == idPSetWrapperFace->findPSetFromId(id));
+  slot.primitiveCount = triangulation->NbTriangles();
 }
 
-void ShapeGeometryBuilder::edgeConstruct(const TopoDS_Edge &edgeIn)
+void ShapeGeometryBuilder::edgeConstruct(Slot &slot) const
 {
-  if (!shouldBuildEdges)
-    return;
+  const TopoDS_Edge &edgeIn = TopoDS::Edge(slot.shape);
   
-  osg::Vec3Array *vertices = dynamic_cast<osg::Vec3Array *>(edgeGeometry->getVertexArray());
-  osg::Vec4Array *colors = dynamic_cast<osg::Vec4Array *>(edgeGeometry->getColorArray());
-  osg::ref_ptr<osg::DrawElementsUInt> indices = new osg::DrawElementsUInt(GL_LINE_STRIP);
+  auto addPoint = [&](const gp_Pnt &point)
+  {
+    slot.vertices.push_back(osg::Vec3(point.X(), point.Y(), point.Z()));
+    slot.indices.push_back(slot.vertices.size() - 1);
+  };
   
   if (edgeToFace.Contains(edgeIn) && edgeToFace.FindFromKey(edgeIn).Size() > 0)
   {
@@ -603,25 +662,14 @@ void ShapeGeometryBuilder::edgeConstruct(const TopoDS_Edge &edgeIn)
     }
     
     const TColStd_Array1OfInteger& indexes = segments->Nodes();
-    indices->resizeElements(indexes.Length());
+    slot.vertices.reserve(indexes.Length());
+    slot.indices.reserve(indexes.Length());
     for (int index(indexes.Lower()); index < indexes.Upper() + 1; ++index)
     {
       gp_Pnt point = triangulation->Node(indexes(index));
       if(!identity)
         point.Transform(transformation);
-      vertices->push_back(osg::Vec3(point.X(), point.Y(), point.Z()));
-      colors->push_back(edgeGeometry->getColor());
-      (*indices)[index - 1] = vertices->size() - 1;
-      
-      if (index != indexes.Lower()) //no edge for first point. so skip
-      {
-        //store primitiveset index and vertex indexes into map.
-        PSetPrimitiveRecord record;
-        record.primitiveSetIndex = edgeGeometry->getNumPrimitiveSets();
-        record.primitiveIndex = primitiveCountEdge;
-        pSetPrimitiveWrapperEdge->pSetPrimitiveContainer.insert(record);
-        primitiveCountEdge++;
-      }
+      addPoint(point);
     }
   }
   else //no face for edge
@@ -640,43 +688,110 @@ void ShapeGeometryBuilder::edgeConstruct(const TopoDS_Edge &edgeIn)
     }
     
     const TColgp_Array1OfPnt& nodes = poly->Nodes();
-    indices->resizeElements(nodes.Size());
-    std::size_t tempIndex = 0;
+    slot.vertices.reserve(nodes.Size());
+    slot.indices.reserve(nodes.Size());
     for (auto point : nodes) //can't const ref, might transform.
     {
       if (!identity)
         point.Transform(transformation);
-      vertices->push_back(osg::Vec3(point.X(), point.Y(), point.Z()));
-      colors->push_back(edgeGeometry->getColor());
-      (*indices)[tempIndex] = vertices->size() - 1;
-      tempIndex++;
-      
-      //first point is skipped, like above.
-      if (tempIndex == 1)
-        continue;
-      
-      //store primitiveset index and primitive index into map.
-      PSetPrimitiveRecord record;
-      record.primitiveSetIndex = edgeGeometry->getNumPrimitiveSets();
-      record.primitiveIndex = primitiveCountEdge;
-      pSetPrimitiveWrapperEdge->pSetPrimitiveContainer.insert(record);
-      primitiveCountEdge++;
+      addPoint(point);
     }
   }
   
-  edgeGeometry->addPrimitiveSet(indices.get());
-  boost::uuids::uuid id = *shapeIdHelper.find(edgeIn);
-  std::size_t lastPrimitiveIndex = edgeGeometry->getNumPrimitiveSets() - 1;
-  if (!idPSetWrapperEdge->hasId(id))
+  //no segment for first point.
+  if (!slot.vertices.empty())
+    slot.primitiveCount = slot.vertices.size() - 1;
+}
+
+void ShapeGeometryBuilder::concatenate(const std::vector<Slot> &slotsIn)
+{
+  //reserve so we don't reallocate large arrays while appending.
+  std::size_t faceVertexCount = 0;
+  std::size_t edgeVertexCount = 0;
+  for (const auto &slot : slotsIn)
   {
-    IdPSetRecord record;
-    record.id = id;
-    record.primitiveSetIndex = lastPrimitiveIndex;
-    idPSetWrapperEdge->idPSetContainer.insert(record);
+    if (!slot.error.empty())
+      continue;
+    if (slot.shape.ShapeType() == TopAbs_FACE)
+      faceVertexCount += slot.vertices.size();
+    else
+      edgeVertexCount += slot.vertices.size();
   }
-  else
-    //ensure that edges have the same primitive index between lod calls.
-    //asserts here prior to having lod implemented is probably duplicate ids
-    //for different geometry.
-    assert(lastPrimitiveIndex == idPSetWrapperEdge->findPSetFromId(id));
+  if (shouldBuildFaces)
+  {
+    auto *vertices = dynamic_cast<osg::Vec3Array *>(faceGeometry->getVertexArray());
+    vertices->reserve(vertices->size() + faceVertexCount);
+    auto *normals = dynamic_cast<osg::Vec3Array *>(faceGeometry->getNormalArray());
+    normals->reserve(normals->size() + faceVertexCount);
+    auto *texCoords = dynamic_cast<osg::Vec2Array *>(faceGeometry->getTexCoordArray(0));
+    texCoords->reserve(texCoords->size() + faceVertexCount);
+  }
+  if (shouldBuildEdges)
+  {
+    auto *vertices = dynamic_cast<osg::Vec3Array *>(edgeGeometry->getVertexArray());
+    vertices->reserve(vertices->size() + edgeVertexCount);
+    auto *texCoords = dynamic_cast<osg::Vec2Array *>(edgeGeometry->getTexCoordArray(0));
+    texCoords->reserve(texCoords->size() + edgeVertexCount);
+  }
+  
+  auto append = 
+  [](
+    ShapeGeometry *geometry
+    , const Slot &slot
+    , GLenum mode
+    , PSetPrimitiveWrapper &pSetPrimitiveWrapper
+    , IdPSetWrapper &idPSetWrapper
+    , std::size_t &primitiveCount
+  )
+  {
+    auto *vertices = dynamic_cast<osg::Vec3Array *>(geometry->getVertexArray());
+    auto *texCoords = dynamic_cast<osg::Vec2Array *>(geometry->getTexCoordArray(0));
+    std::size_t offset = vertices->size();
+    vertices->insert(vertices->end(), slot.vertices.begin(), slot.vertices.end());
+    texCoords->insert(texCoords->end(), slot.vertices.size(), PSetColors::texel(geometry->getNumPrimitiveSets()));
+    if (!slot.normals.empty())
+    {
+      auto *normals = dynamic_cast<osg::Vec3Array *>(geometry->getNormalArray());
+      normals->insert(normals->end(), slot.normals.begin(), slot.normals.end());
+    }
+    
+    osg::ref_ptr<osg::DrawElementsUInt> indices = new osg::DrawElementsUInt(mode, slot.indices.size());
+    for (std::size_t index = 0; index < slot.indices.size(); ++index)
+      (*indices)[index] = slot.indices[index] + offset;
+    
+    //store the range of primitives belonging to this primitive set.
+    assert(pSetPrimitiveWrapper.primitiveCount == primitiveCount);
+    pSetPrimitiveWrapper.append(geometry->getNumPrimitiveSets(), slot.primitiveCount);
+    primitiveCount += slot.primitiveCount;
+    
+    geometry->addPrimitiveSet(indices.get());
+    std::size_t lastPrimitiveIndex = geometry->getNumPrimitiveSets() - 1;
+    if (!idPSetWrapper.hasId(slot.id))
+    {
+      IdPSetRecord record;
+      record.id = slot.id;
+      record.primitiveSetIndex = lastPrimitiveIndex;
+      idPSetWrapper.idPSetContainer.insert(record);
+    }
+    else
+      //ensure that faces and edges have the same primitive index between lod calls.
+      //asserts here prior to having lod implemented is probably duplicate ids
+      //for different geometry.
+      assert(lastPrimitiveIndex == idPSetWrapper.findPSetFromId(slot.id));
+  };
+  
+  for (const auto &slot : slotsIn)
+  {
+    if (!slot.error.empty())
+      continue;
+    if (slot.shape.ShapeType() == TopAbs_FACE)
+      append(faceGeometry.get(), slot, GL_TRIANGLES, *pSetPrimitiveWrapperFace, *idPSetWrapperFace, primitiveCountFace);
+    else
+      append(edgeGeometry.get(), slot, GL_LINE_STRIP, *pSetPrimitiveWrapperEdge, *idPSetWrapperEdge, primitiveCountEdge);
+  }
+  
+  if (shouldBuildFaces)
+    faceGeometry->buildPSetColors();
+  if (shouldBuildEdges)
+    edgeGeometry->buildPSetColors();
 }
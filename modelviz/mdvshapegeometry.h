@@ -40,6 +40,7 @@ namespace mdv
 {
   struct IdPSetWrapper;
   struct PSetPrimitiveWrapper;
+  class PSetColors;
   
   class ShapeGeometry : public Base
   {
@@ -55,6 +56,7 @@ namespace mdv
     std::size_t getPSetFromPrimitive(std::size_t) const;
     
     virtual void setColor(const osg::Vec4 &colorIn) override;
+    void buildPSetColors(); //!< call after all primitive sets are added.
     
     void setToColor(const boost::uuids::uuid&); //!< set to color of primitive index.
     void setToPreHighlight(const boost::uuids::uuid&); //!< set to prehighlight of primitive index.
@@ -65,10 +67,12 @@ namespace mdv
     const PSetPrimitiveWrapper& getPSetPrimitiveWrapper() const;
     
   protected:
+    virtual ~ShapeGeometry() override;
     void setColor(const boost::uuids::uuid&, const osg::Vec4&); //set color of primitive index.
     
     std::shared_ptr<IdPSetWrapper> idPSetWrapper;
     std::shared_ptr<PSetPrimitiveWrapper> pSetVertexWrapper;
+    osg::ref_ptr<PSetColors> pSetColors; //!< shared with copies like the state set.
   };
   
   class ShapeGeometryBuilder
@@ -81,15 +85,19 @@ namespace mdv
     void buildFaces(bool in){shouldBuildFaces = in;}
     void buildEdges(bool in){shouldBuildEdges = in;}
     void buildVertices(bool in){shouldBuildVertices = in;}
+    void setThreadCount(std::size_t in){threadCount = in;} //!< 0 = all cores. 1 = serial.
     osg::ref_ptr<osg::Switch> out;
     bool success = false;
     const std::vector<std::string>& getWarnings(){return warnings;}
     const std::vector<std::string>& getErrors(){return errors;}
   private:
+    struct Slot; //!< buffers for one face or edge. see source.
     void initialize();
-    void recursiveConstruct(const TopoDS_Shape &shapeIn);
-    void edgeConstruct(const TopoDS_Edge &edgeIn);
-    void faceConstruct(const TopoDS_Face &faceIn);
+    void recursiveCollect(const TopoDS_Shape &shapeIn);
+    void collect(const TopoDS_Shape &shapeIn, bool root);
+    void edgeConstruct(Slot&) const;
+    void faceConstruct(Slot&) const;
+    void concatenate(const std::vector<Slot>&);
     TopoDS_Shape copiedShape;
     const ann::ShapeIdHelper &shapeIdHelper;
     Bnd_Box bound;
@@ -111,6 +119,8 @@ namespace mdv
     std::size_t primitiveCountEdge;
     std::vector<std::string> warnings;
     std::vector<std::string> errors;
+    std::vector<Slot> slots; //!< faces and edges in traversal order.
+    std::size_t threadCount = 0;
   };
 }
 
@@ -20,6 +20,11 @@
 #ifndef MDV_SHAPEGEOMETRYPRIVATE_H
 #define MDV_SHAPEGEOMETRYPRIVATE_H
 
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <ostream>
+
 #include <boost/multi_index_container.hpp>
 #include <boost/multi_index/member.hpp>
 #include <boost/multi_index/ordered_index.hpp>
@@ -114,71 +119,52 @@ namespace mdv
     }
   };
   
-  //! @brief map between primitive set indexes and primitive indexes (triangle or line)
-  struct PSetPrimitiveRecord
-  {
-    std::size_t primitiveSetIndex = 0; //!< primitiveset index.
-    std::size_t primitiveIndex = 0; //!< triangle index.
-    
-    //@{
-    //! used as tags.
-    struct ByPSet{};
-    struct ByPrimitive{};
-    //@}
-  };
-  std::ostream& operator<<(std::ostream& os, const PSetPrimitiveRecord& record)
-  {
-    os << record.primitiveSetIndex << "      " << record.primitiveIndex << std::endl;
-    return os;
-  }
-  
-  typedef boost::multi_index_container
-  <
-    PSetPrimitiveRecord,
-    BMI::indexed_by
-    <
-      BMI::ordered_non_unique
-      <
-        BMI::tag<PSetPrimitiveRecord::ByPSet>,
-        BMI::member<PSetPrimitiveRecord, std::size_t, &PSetPrimitiveRecord::primitiveSetIndex>
-      >,
-      BMI::ordered_unique
-      <
-        BMI::tag<PSetPrimitiveRecord::ByPrimitive>,
-        BMI::member<PSetPrimitiveRecord, std::size_t, &PSetPrimitiveRecord::primitiveIndex>
-      >
-    >
-  > PSetPrimitiveContainer;
-  std::ostream& operator<<(std::ostream& os, const PSetPrimitiveContainer& container)
-  {
-    typedef PSetPrimitiveContainer::index<PSetPrimitiveRecord::ByPSet>::type List;
-    const List &list = container.get<PSetPrimitiveRecord::ByPSet>();
-    for (List::const_iterator it = list.begin(); it != list.end(); ++it)
-      os << *it;
-    return os;
-  }
-  
-  //! @brief So I can forward declare.
+  /*! @brief map between primitive indexes (triangle or line) and primitive set indexes.
+   * 
+   * @details Primitives of a primitive set are consecutive, so we store
+   * 1 range per primitive set instead of 1 record per primitive. Lookup
+   * is a binary search over the range starts.
+   */
   struct PSetPrimitiveWrapper
   {
-    PSetPrimitiveContainer pSetPrimitiveContainer;
-    bool hasPSet(std::size_t indexIn)
+    std::vector<std::size_t> starts; //!< first primitive of each range. ascending.
+    std::vector<std::size_t> pSets; //!< primitive set index of each range. parallel to starts.
+    std::size_t primitiveCount = 0; //!< one past the last primitive of the last range.
+    
+    //! primitives [primitiveCount, primitiveCount + countIn) belong to pSetIn.
+    void append(std::size_t pSetIn, std::size_t countIn)
     {
-      typedef PSetPrimitiveContainer::index<PSetPrimitiveRecord::ByPSet>::type List;
-      const List &list = pSetPrimitiveContainer.get<PSetPrimitiveRecord::ByPSet>();
-      List::const_iterator it = list.find(indexIn);
-      return it != list.end();
+      if (countIn == 0)
+        return;
+      starts.push_back(primitiveCount);
+      pSets.push_back(pSetIn);
+      primitiveCount += countIn;
     }
     
-    std::size_t findPSetFromPrimitive(std::size_t indexIn)
+    bool hasPSet(std::size_t indexIn) const
     {
-      typedef PSetPrimitiveContainer::index<PSetPrimitiveRecord::ByPrimitive>::type List;
-      const List &list = pSetPrimitiveContainer.get<PSetPrimitiveRecord::ByPrimitive>();
-      List::const_iterator it = list.find(indexIn);
-      assert(it != list.end());
-      return it->primitiveSetIndex;
+      return std::find(pSets.begin(), pSets.end(), indexIn) != pSets.end();
+    }
+    
+    bool hasPrimitive(std::size_t indexIn) const
+    {
+      return indexIn < primitiveCount;
+    }
+    
+    std::size_t findPSetFromPrimitive(std::size_t indexIn) const
+    {
+      assert(hasPrimitive(indexIn));
+      auto it = std::upper_bound(starts.begin(), starts.end(), indexIn);
+      assert(it != starts.begin());
+      return pSets[std::distance(starts.begin(), it) - 1];
     }
   };
+  std::ostream& operator<<(std::ostream& os, const PSetPrimitiveWrapper& wrapper)
+  {
+    for (std::size_t index = 0; index < wrapper.starts.size(); ++index)
+      os << wrapper.pSets.at(index) << "      " << wrapper.starts.at(index) << std::endl;
+    return os;
+  }
 }
 
 #endif // MDV_SHAPEGEOMETRYPRIVATE_H
@@ -0,0 +1,189 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdint>
+#include <ctime>
+#include <algorithm>
+#include <tuple>
+
+#include <boost/filesystem.hpp>
+
+#include <osg/Switch>
+#include <osgDB/ReadFile>
+#include <osgDB/WriteFile>
+
+#include "tools/tlshash.h"
+#include "modelviz/mdvtessellationcache.h"
+
+using namespace mdv;
+namespace bfs = boost::filesystem;
+
+void TessellationCache::setDirectory(const bfs::path &scratch)
+{
+  bfs::path fresh = scratch / "tessellation";
+  if (fresh == directory)
+    return;
+  directory = fresh;
+  if (!bfs::exists(directory))
+    bfs::create_directories(directory);
+  evict(); //previous sessions might have left it over the limit.
+}
+
+std::string TessellationCache::buildKey
+(
+  const std::string &shapeBytes
+  , const std::vector<boost::uuids::uuid> &ids
+  , double linear
+  , double angular
+)
+{
+  return buildKey(shapeBytes.data(), shapeBytes.size(), ids, linear, angular);
+}
+
+std::string TessellationCache::buildKey
+(
+  const char *shapeBytes
+  , std::size_t shapeSize
+  , const std::vector<boost::uuids::uuid> &ids
+  , double linear
+  , double angular
+)
+{
+  tls::Hasher hasher;
+  hasher.process(shapeBytes, shapeSize);
+  for (const auto &id : ids)
+    hasher.process(id.data, id.size());
+  hasher.process(&linear, sizeof(double));
+  hasher.process(&angular, sizeof(double));
+  //change when the osgb layout of ShapeGeometry changes, so old entries are ignored.
+  const std::uint32_t formatVersion = 3;
+  hasher.process(&formatVersion, sizeof(formatVersion));
+  
+  return hasher.toString();
+}
+
+bfs::path TessellationCache::buildPath(const std::string &key) const
+{
+  return directory / (key + ".osgb");
+}
+
+bool TessellationCache::has(const std::string &key)
+{
+  if (!directory.empty() && bfs::exists(buildPath(key)))
+  {
+    hits++;
+    touch(buildPath(key));
+    return true;
+  }
+  misses++;
+  return false;
+}
+
+osg::ref_ptr<osg::Switch> TessellationCache::find(const std::string &key)
+{
+  osg::ref_ptr<osg::Switch> out;
+  if (!directory.empty())
+  {
+    bfs::path p = buildPath(key);
+    if (bfs::exists(p))
+      out = dynamic_cast<osg::Switch*>(osgDB::readNodeFile(p.string()));
+  }
+  if (out)
+  {
+    hits++;
+    touch(buildPath(key));
+  }
+  else
+    misses++;
+  return out;
+}
+
+void TessellationCache::insert(const std::string &key, osg::Switch &node)
+{
+  if (directory.empty())
+    return;
+  //write to temp and rename so a reader never sees a partial file.
+  bfs::path p = buildPath(key);
+  bfs::path temp = p;
+  temp += bfs::unique_path(".%%%%%%.osgb");
+  if (osgDB::writeNodeFile(node, temp.string()))
+  {
+    boost::system::error_code ec;
+    bfs::rename(temp, p, ec);
+    std::uintmax_t size = bfs::file_size(p, ec);
+    if (!ec)
+      bytes += size;
+  }
+  if (bytes > maxBytes)
+    evict();
+}
+
+//! mark as recently used. Modification time is the recency eviction sorts by.
+void TessellationCache::touch(const bfs::path &p)
+{
+  boost::system::error_code ec;
+  bfs::last_write_time(p, std::time(nullptr), ec);
+}
+
+//! measure the directory and remove least recently used entries when over maxBytes.
+void TessellationCache::evict()
+{
+  if (directory.empty() || !bfs::exists(directory))
+    return;
+  
+  std::vector<std::tuple<std::time_t, std::uintmax_t, bfs::path>> entries;
+  std::uintmax_t total = 0;
+  boost::system::error_code ec;
+  for (const auto &entry : bfs::directory_iterator(directory, ec))
+  {
+    const bfs::path &p = entry.path();
+    //temporaries of an insert in progress have a second extension.
+    if (p.extension() != ".osgb" || !p.stem().extension().empty())
+      continue;
+    boost::system::error_code entryEc;
+    std::uintmax_t size = bfs::file_size(p, entryEc);
+    std::time_t time = bfs::last_write_time(p, entryEc);
+    if (entryEc)
+      continue;
+    entries.emplace_back(time, size, p);
+    total += size;
+  }
+  
+  if (total > maxBytes)
+  {
+    std::sort(entries.begin(), entries.end());
+    std::uintmax_t target = maxBytes / 4 * 3;
+    for (const auto &entry : entries)
+    {
+      if (total <= target)
+        break;
+      boost::system::error_code removeEc;
+      if (bfs::remove(std::get<2>(entry), removeEc))
+        evictions++;
+      total -= std::get<1>(entry); //gone either way. another process may have removed it.
+    }
+  }
+  bytes = total;
+}
+
+TessellationCache& mdv::tessellationCache()
+{
+  static TessellationCache cache;
+  return cache;
+}
@@ -0,0 +1,89 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MDV_TESSELLATIONCACHE_H
+#define MDV_TESSELLATIONCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include <osg/ref_ptr>
+
+namespace osg{class Switch;}
+
+namespace mdv
+{
+  /*! @class TessellationCache
+   * @brief Disk cache of ShapeGeometryBuilder output.
+   * 
+   * @details Entries are osgb files in a 'tessellation' sub
+   * directory of the project scratch directory. The key is
+   * built from the binary occt shape, the shape ids and the
+   * deflections, so a feature that regenerates identical
+   * geometry reuses the previous tessellation. Used by both
+   * the application and the external lod generator.
+   * 
+   * The shape must be serialized without triangulation,
+   * BRepTools::Clean, or the key will never match.
+   * 
+   * The directory is kept under maxBytes. A hit sets the file's
+   * modification time, and when an insert goes over the limit the least
+   * recently used files are removed down to three quarters of it. The
+   * application and lod generators share the directory, so the size is
+   * taken from the directory itself before evicting.
+   */
+  class TessellationCache
+  {
+  public:
+    //! @param scratch is the project scratch directory.
+    void setDirectory(const boost::filesystem::path &scratch);
+    
+    //! key for binary occt bytes from BinTools::Write, ids in ShapeIdHelper order and deflections.
+    static std::string buildKey(const std::string &shapeBytes, const std::vector<boost::uuids::uuid>&, double, double);
+    static std::string buildKey(const char *shapeBytes, std::size_t shapeSize, const std::vector<boost::uuids::uuid>&, double, double);
+    
+    boost::filesystem::path buildPath(const std::string &key) const;
+    bool has(const std::string &key); //!< counts hit or miss.
+    osg::ref_ptr<osg::Switch> find(const std::string &key); //!< null and counts miss if not there.
+    void insert(const std::string &key, osg::Switch&);
+    
+    std::size_t getHits() const {return hits;}
+    std::size_t getMisses() const {return misses;}
+    std::size_t getEvictions() const {return evictions;} //!< files removed to stay under maxBytes.
+    std::uintmax_t getBytes() const {return bytes;} //!< directory size as of last insert or scan.
+    static constexpr std::uintmax_t maxBytes = 512 * 1024 * 1024;
+  private:
+    boost::filesystem::path directory;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::uintmax_t bytes = 0;
+    void touch(const boost::filesystem::path&);
+    void evict();
+  };
+  
+  //! singleton for the process.
+  TessellationCache& tessellationCache();
+}
+
+#endif // MDV_TESSELLATIONCACHE_H
@@ -28,6 +28,7 @@
 #include "tools/idtools.h"
 #include "tools/infotools.h"
 #include "tools/tlsstring.h"
+#include "message/msgnode.h"
 #include "project/serial/generated/prjsrlsptparameter.h"
 #include "parameter/prmvariant.h"
 #include "parameter/prmparameter.h"
@@ -259,6 +260,8 @@ namespace prm
   {
     std::vector<boost::signals2::scoped_connection> connections;
     std::vector<boost::signals2::shared_connection_block> blockers;
+    bool deferrable = false;
+    std::shared_ptr<bool> token = std::make_shared<bool>(true); //!< deferred calls check the observer still exists.
   };
   struct Subject::Stow
   {
@@ -305,6 +308,11 @@ void Observer::unblock()
   stow->blockers.clear();
 }
 
+void Observer::setDeferrable()
+{
+  stow->deferrable = true;
+}
+
 
 Subject::Subject()
 : stow(std::make_unique<Stow>())
@@ -331,12 +339,24 @@ void Subject::addActiveHandler(Handler ahIn)
 
 void Subject::connect(Observer &oIn)
 {
+  auto wrap = [&oIn](const Handler &hIn) -> Handler
+  {
+    //observer stow outlives the connection, so it is valid whenever the handler is signaled.
+    const Observer::Stow *os = oIn.stow.get();
+    std::weak_ptr<bool> token = os->token;
+    return [hIn, os, token]()
+    {
+      if (os->deferrable && msg::defer([hIn, token](){if (!token.expired()) hIn();}))
+        return;
+      hIn();
+    };
+  };
   if (oIn.valueHandler)
-    oIn.stow->connections.push_back(stow->valueSignal.connect(oIn.valueHandler));
+    oIn.stow->connections.push_back(stow->valueSignal.connect(wrap(oIn.valueHandler)));
   if (oIn.constantHandler)
-    oIn.stow->connections.push_back(stow->constantSignal.connect(oIn.constantHandler));
+    oIn.stow->connections.push_back(stow->constantSignal.connect(wrap(oIn.constantHandler)));
   if (oIn.activeHandler)
-    oIn.stow->connections.push_back(stow->activeSignal.connect(oIn.activeHandler));
+    oIn.stow->connections.push_back(stow->activeSignal.connect(wrap(oIn.activeHandler)));
 }
 
 void Subject::sendValueChanged() const
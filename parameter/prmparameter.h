@@ -105,6 +105,7 @@ namespace prm
     
     void block();
     void unblock();
+    void setDeferrable(); //!< handlers touch gui or scene graph. see Subject::connect.
     
     struct Stow; //!< forward declare pimpl
     std::unique_ptr<Stow> stow; //!< private data
@@ -176,7 +177,10 @@ namespace prm
     /*! @anchor Transient
       * @name Transient 
       * 1 way, transient communication.
-      * no constraints on target life vs Subject life
+      * no constraints on target life vs Subject life.
+      * Handlers of a deferrable observer, changed from a thread
+      * with an active msg::Deferral, are called when the deferral
+      * is flushed on the gui thread. Unless the observer is gone by then.
       */
     void connect(Observer&);
     //@}
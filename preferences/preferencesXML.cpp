@@ -1298,6 +1298,36 @@ namespace prf
     this->lastDirectory_.set (std::move (x));
   }
 
+  const Project::DeferShapeChecksOptional& Project::
+  deferShapeChecks () const
+  {
+    return this->deferShapeChecks_;
+  }
+
+  Project::DeferShapeChecksOptional& Project::
+  deferShapeChecks ()
+  {
+    return this->deferShapeChecks_;
+  }
+
+  void Project::
+  deferShapeChecks (const DeferShapeChecksType& x)
+  {
+    this->deferShapeChecks_.set (x);
+  }
+
+  void Project::
+  deferShapeChecks (const DeferShapeChecksOptional& x)
+  {
+    this->deferShapeChecks_ = x;
+  }
+
+  Project::DeferShapeChecksType Project::
+  deferShapeChecks_default_value ()
+  {
+    return DeferShapeChecksType (false);
+  }
+
 
   // SpaceballButton
   // 
@@ -4906,7 +4936,8 @@ namespace prf
     gitName_ (gitName, this),
     gitEmail_ (gitEmail, this),
     recentProjects_ (recentProjects, this),
-    lastDirectory_ (this)
+    lastDirectory_ (this),
+    deferShapeChecks_ (this)
   {
   }
 
@@ -4920,7 +4951,8 @@ namespace prf
     gitName_ (gitName, this),
     gitEmail_ (gitEmail, this),
     recentProjects_ (std::move (recentProjects), this),
-    lastDirectory_ (this)
+    lastDirectory_ (this),
+    deferShapeChecks_ (this)
   {
   }
 
@@ -4933,7 +4965,8 @@ namespace prf
     gitName_ (x.gitName_, f, this),
     gitEmail_ (x.gitEmail_, f, this),
     recentProjects_ (x.recentProjects_, f, this),
-    lastDirectory_ (x.lastDirectory_, f, this)
+    lastDirectory_ (x.lastDirectory_, f, this),
+    deferShapeChecks_ (x.deferShapeChecks_, f, this)
   {
   }
 
@@ -4946,7 +4979,8 @@ namespace prf
     gitName_ (this),
     gitEmail_ (this),
     recentProjects_ (this),
-    lastDirectory_ (this)
+    lastDirectory_ (this),
+    deferShapeChecks_ (this)
   {
     if ((f & ::xml_schema::Flags::base) == 0)
     {
@@ -5035,6 +5069,17 @@ namespace prf
         }
       }
 
+      // deferShapeChecks
+      //
+      if (n.name () == "deferShapeChecks" && n.namespace_ ().empty ())
+      {
+        if (!this->deferShapeChecks_)
+        {
+          this->deferShapeChecks_.set (DeferShapeChecksTraits::create (i, f, this));
+          continue;
+        }
+      }
+
       break;
     }
 
@@ -5085,6 +5130,7 @@ namespace prf
       this->gitEmail_ = x.gitEmail_;
       this->recentProjects_ = x.recentProjects_;
       this->lastDirectory_ = x.lastDirectory_;
+      this->deferShapeChecks_ = x.deferShapeChecks_;
     }
 
     return *this;
@@ -8939,6 +8985,18 @@ namespace prf
 
       s << *i.lastDirectory ();
     }
+
+    // deferShapeChecks
+    //
+    if (i.deferShapeChecks ())
+    {
+      ::xercesc::DOMElement& s (
+        ::xsd::cxx::xml::dom::create_element (
+          "deferShapeChecks",
+          e));
+
+      s << *i.deferShapeChecks ();
+    }
   }
 
   void
@@ -4402,6 +4402,79 @@ namespace prf
 
     //@}
 
+    /**
+     * @name deferShapeChecks
+     *
+     * @brief Accessor and modifier functions for the %deferShapeChecks
+     * optional element.
+     */
+    //@{
+
+    /**
+     * @brief Element type.
+     */
+    typedef ::xml_schema::Boolean DeferShapeChecksType;
+
+    /**
+     * @brief Element optional container type.
+     */
+    typedef ::xsd::cxx::tree::optional< DeferShapeChecksType > DeferShapeChecksOptional;
+
+    /**
+     * @brief Element traits type.
+     */
+    typedef ::xsd::cxx::tree::traits< DeferShapeChecksType, char > DeferShapeChecksTraits;
+
+    /**
+     * @brief Return a read-only (constant) reference to the element
+     * container.
+     *
+     * @return A constant reference to the optional container.
+     */
+    const DeferShapeChecksOptional&
+    deferShapeChecks () const;
+
+    /**
+     * @brief Return a read-write reference to the element container.
+     *
+     * @return A reference to the optional container.
+     */
+    DeferShapeChecksOptional&
+    deferShapeChecks ();
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x A new value to set.
+     *
+     * This function makes a copy of its argument and sets it as
+     * the new value of the element.
+     */
+    void
+    deferShapeChecks (const DeferShapeChecksType& x);
+
+    /**
+     * @brief Set the element value.
+     *
+     * @param x An optional container with the new value to set.
+     *
+     * If the value is present in @a x then this function makes a copy 
+     * of this value and sets it as the new value of the element.
+     * Otherwise the element container is set the 'not present' state.
+     */
+    void
+    deferShapeChecks (const DeferShapeChecksOptional& x);
+
+    /**
+     * @brief Return the default value for the element.
+     *
+     * @return The element's default value.
+     */
+    static DeferShapeChecksType
+    deferShapeChecks_default_value ();
+
+    //@}
+
     /**
      * @name Constructors
      */
@@ -4504,6 +4577,7 @@ namespace prf
     ::xsd::cxx::tree::one< GitEmailType > gitEmail_;
     ::xsd::cxx::tree::one< RecentProjectsType > recentProjects_;
     LastDirectoryOptional lastDirectory_;
+    DeferShapeChecksOptional deferShapeChecks_;
 
     //@endcond
   };
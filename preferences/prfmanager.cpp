@@ -273,6 +273,8 @@ void Manager::ensureDefaults()
     rootPtr->project().gitName() = "Holden McGroyn";
   if (rootPtr->project().gitEmail().empty())
     rootPtr->project().gitEmail() = rootPtr->project().gitName() + "@somewhere.com";
+  if (!rootPtr->project().deferShapeChecks().present())
+    rootPtr->project().deferShapeChecks() = prf::Project::deferShapeChecks_default_value();
   
   auto &features = rootPtr->features();
   
@@ -17,7 +17,7 @@
  *
  */
 
-#include <TopoDS_Iterator.hxx>
+#include <TopoDS_Shape.hxx>
 
 #include <osg/Matrixd>
 
@@ -130,88 +130,95 @@ using boost::filesystem::path;
 
 using namespace prj;
 
+//parsed files are shared with the build function, which std::function needs copyable.
+template <typename T>
+static std::shared_ptr<const T> share(std::unique_ptr<T> parsed)
+{
+  return std::shared_ptr<const T>(std::move(parsed));
+}
+
 /*! @brief Construct the FeatureLoad object
  * 
  * @parameter directoryIn is the directory where project feature files live.
- * @parameter masterShapeIn is the occt compound shape that contains all feature shapes.
  * @parameter validate is a boolean value to control xml validation. false by default.
  * @note I have not tested validation = true. I think in order for the validation check to work,
  * we will have to specify a path to a xsd file. That is why we have the 'preferencesXML.xsd'
  * file in resources.qrc.
  */
-FeatureLoad::FeatureLoad(const path& directoryIn, const TopoDS_Shape &masterShapeIn, bool validate)
+FeatureLoad::FeatureLoad(const path& directoryIn, bool validate)
 : directory(directoryIn)
-, featureId(gu::createNilId())
 {
   if (!validate)
     flags |= ::xml_schema::Flags::dont_validate;
-  
-  for (TopoDS_Iterator it(masterShapeIn); it.More(); it.Next())
-    shapeVector.push_back(it.Value());
-  
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Box), std::bind(&FeatureLoad::loadBox, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Cylinder), std::bind(&FeatureLoad::loadCylinder, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sphere), std::bind(&FeatureLoad::loadSphere, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Cone), std::bind(&FeatureLoad::loadCone, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Boolean), std::bind(&FeatureLoad::loadBoolean, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Inert), std::bind(&FeatureLoad::loadInert, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Blend), std::bind(&FeatureLoad::loadBlend, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Chamfer), std::bind(&FeatureLoad::loadChamfer, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Draft), std::bind(&FeatureLoad::loadDraft, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DatumPlane), std::bind(&FeatureLoad::loadDatumPlane, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Hollow), std::bind(&FeatureLoad::loadHollow, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Oblong), std::bind(&FeatureLoad::loadOblong, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Extract), std::bind(&FeatureLoad::loadExtract, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Squash), std::bind(&FeatureLoad::loadSquash, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Nest), std::bind(&FeatureLoad::loadNest, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DieSet), std::bind(&FeatureLoad::loadDieSet, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Strip), std::bind(&FeatureLoad::loadStrip, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Quote), std::bind(&FeatureLoad::loadQuote, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Refine), std::bind(&FeatureLoad::loadRefine, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::InstanceLinear), std::bind(&FeatureLoad::loadInstanceLinear, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::InstanceMirror), std::bind(&FeatureLoad::loadInstanceMirror, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::InstancePolar), std::bind(&FeatureLoad::loadInstancePolar, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Offset), std::bind(&FeatureLoad::loadOffset, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Thicken), std::bind(&FeatureLoad::loadThicken, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sew), std::bind(&FeatureLoad::loadSew, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Trim), std::bind(&FeatureLoad::loadTrim, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::RemoveFaces), std::bind(&FeatureLoad::loadRemoveFaces, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Torus), std::bind(&FeatureLoad::loadTorus, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Thread), std::bind(&FeatureLoad::loadThread, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DatumAxis), std::bind(&FeatureLoad::loadDatumAxis, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Extrude), std::bind(&FeatureLoad::loadExtrude, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Revolve), std::bind(&FeatureLoad::loadRevolve, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sketch), std::bind(&FeatureLoad::loadSketch, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Line), std::bind(&FeatureLoad::loadLine, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::SurfaceMesh), std::bind(&FeatureLoad::loadSurfaceMesh, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::TransitionCurve), std::bind(&FeatureLoad::loadTransitionCurve, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Ruled), std::bind(&FeatureLoad::loadRuled, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::ImagePlane), std::bind(&FeatureLoad::loadImagePlane, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sweep), std::bind(&FeatureLoad::loadSweep, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DatumSystem), std::bind(&FeatureLoad::loadDatumSystem, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::SurfaceReMesh), std::bind(&FeatureLoad::loadSurfaceReMesh, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::SurfaceMeshFill), std::bind(&FeatureLoad::loadSurfaceMeshFill, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::MapPCurve), std::bind(&FeatureLoad::loadMapPCurve, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Untrim), std::bind(&FeatureLoad::loadUntrim, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Face), std::bind(&FeatureLoad::loadFace, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Fill), std::bind(&FeatureLoad::loadFill, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Prism), std::bind(&FeatureLoad::loadPrism, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::UnderCut), std::bind(&FeatureLoad::loadUndercut, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Mutate), std::bind(&FeatureLoad::loadMutate, this, std::placeholders::_1, std::placeholders::_2)));
-  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::LawSpine), std::bind(&FeatureLoad::loadLawSpine, this, std::placeholders::_1, std::placeholders::_2)));
-}
-
-std::unique_ptr<ftr::Base> FeatureLoad::load(const std::string& idIn, const std::string& typeIn, std::size_t shapeOffsetIn)
-{
-  featureId = gu::stringToId(idIn);
-  
+  //load is called from many threads. xerces initialize and terminate are not thread safe.
+  flags |= ::xml_schema::Flags::dont_initialize;
+  
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Box), std::bind(&FeatureLoad::loadBox, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Cylinder), std::bind(&FeatureLoad::loadCylinder, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sphere), std::bind(&FeatureLoad::loadSphere, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Cone), std::bind(&FeatureLoad::loadCone, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Boolean), std::bind(&FeatureLoad::loadBoolean, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Inert), std::bind(&FeatureLoad::loadInert, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Blend), std::bind(&FeatureLoad::loadBlend, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Chamfer), std::bind(&FeatureLoad::loadChamfer, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Draft), std::bind(&FeatureLoad::loadDraft, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DatumPlane), std::bind(&FeatureLoad::loadDatumPlane, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Hollow), std::bind(&FeatureLoad::loadHollow, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Oblong), std::bind(&FeatureLoad::loadOblong, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Extract), std::bind(&FeatureLoad::loadExtract, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Squash), std::bind(&FeatureLoad::loadSquash, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Nest), std::bind(&FeatureLoad::loadNest, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DieSet), std::bind(&FeatureLoad::loadDieSet, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Strip), std::bind(&FeatureLoad::loadStrip, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Quote), std::bind(&FeatureLoad::loadQuote, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Refine), std::bind(&FeatureLoad::loadRefine, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::InstanceLinear), std::bind(&FeatureLoad::loadInstanceLinear, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::InstanceMirror), std::bind(&FeatureLoad::loadInstanceMirror, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::InstancePolar), std::bind(&FeatureLoad::loadInstancePolar, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Offset), std::bind(&FeatureLoad::loadOffset, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Thicken), std::bind(&FeatureLoad::loadThicken, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sew), std::bind(&FeatureLoad::loadSew, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Trim), std::bind(&FeatureLoad::loadTrim, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::RemoveFaces), std::bind(&FeatureLoad::loadRemoveFaces, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Torus), std::bind(&FeatureLoad::loadTorus, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Thread), std::bind(&FeatureLoad::loadThread, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DatumAxis), std::bind(&FeatureLoad::loadDatumAxis, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Extrude), std::bind(&FeatureLoad::loadExtrude, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Revolve), std::bind(&FeatureLoad::loadRevolve, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sketch), std::bind(&FeatureLoad::loadSketch, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Line), std::bind(&FeatureLoad::loadLine, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::SurfaceMesh), std::bind(&FeatureLoad::loadSurfaceMesh, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::TransitionCurve), std::bind(&FeatureLoad::loadTransitionCurve, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Ruled), std::bind(&FeatureLoad::loadRuled, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::ImagePlane), std::bind(&FeatureLoad::loadImagePlane, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Sweep), std::bind(&FeatureLoad::loadSweep, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::DatumSystem), std::bind(&FeatureLoad::loadDatumSystem, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::SurfaceReMesh), std::bind(&FeatureLoad::loadSurfaceReMesh, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::SurfaceMeshFill), std::bind(&FeatureLoad::loadSurfaceMeshFill, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::MapPCurve), std::bind(&FeatureLoad::loadMapPCurve, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Untrim), std::bind(&FeatureLoad::loadUntrim, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Face), std::bind(&FeatureLoad::loadFace, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Fill), std::bind(&FeatureLoad::loadFill, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Prism), std::bind(&FeatureLoad::loadPrism, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::UnderCut), std::bind(&FeatureLoad::loadUndercut, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::Mutate), std::bind(&FeatureLoad::loadMutate, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  functionMap.insert(std::make_pair(ftr::toString(ftr::Type::LawSpine), std::bind(&FeatureLoad::loadLawSpine, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+}
+
+/*! @brief Parse a feature file.
+ * 
+ * @return function that constructs the feature or an empty function on parse failure.
+ * @note The returned function constructs osg nodes and must be called on the gui thread.
+ */
+FeatureLoad::Build FeatureLoad::load(const std::string& idIn, const std::string& typeIn, const ShapeReader &shapeIn)
+{
   auto it = functionMap.find(typeIn);
   assert(it != functionMap.end());
   
   boost::filesystem::path filePath = directory / (idIn + ".fetr");
   try
   {
-    return it->second(filePath.string(), shapeOffsetIn);
+    return it->second(filePath.string(), shapeIn, gu::stringToId(idIn));
   }
   catch (const xsd::cxx::xml::invalid_utf16_string&)
   {
@@ -226,595 +233,745 @@ std::unique_ptr<ftr::Base> FeatureLoad::load(const std::string& idIn, const std:
     std::cerr << e << std::endl;
   }
   
-  return std::unique_ptr<ftr::Base>();
+  return Build();
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadBox(const std::string& fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadBox(const std::string& fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto box = srl::bxs::box(fileNameIn, flags);
+  auto box = share(srl::bxs::box(fileNameIn, flags));
   assert(box);
   
-  auto freshBox = std::make_unique<ftr::Box::Feature>();
-  freshBox->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshBox->serialRead(*box);
-  
-  return freshBox;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshBox = std::make_unique<ftr::Box::Feature>();
+    freshBox->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshBox->serialRead(*box);
+    
+    return freshBox;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadCylinder(const std::string& fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadCylinder(const std::string& fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sCylinder = srl::cyls::cylinder(fileNameIn, flags);
+  auto sCylinder = share(srl::cyls::cylinder(fileNameIn, flags));
   assert(sCylinder);
   
-  auto freshCylinder = std::make_unique<ftr::Cylinder::Feature>();
-  freshCylinder->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshCylinder->serialRead(*sCylinder);
-  
-  return freshCylinder;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshCylinder = std::make_unique<ftr::Cylinder::Feature>();
+    freshCylinder->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshCylinder->serialRead(*sCylinder);
+    
+    return freshCylinder;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSphere(const std::string& fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadSphere(const std::string& fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sSphere = srl::sprs::sphere(fileNameIn, flags);
+  auto sSphere = share(srl::sprs::sphere(fileNameIn, flags));
   assert(sSphere);
   
-  auto freshSphere = std::make_unique<ftr::Sphere::Feature>();
-  freshSphere->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshSphere->serialRead(*sSphere);
-  
-  return freshSphere;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshSphere = std::make_unique<ftr::Sphere::Feature>();
+    freshSphere->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshSphere->serialRead(*sSphere);
+    
+    return freshSphere;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadCone(const std::string& fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadCone(const std::string& fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sCone = srl::cns::cone(fileNameIn, flags);
+  auto sCone = share(srl::cns::cone(fileNameIn, flags));
   assert(sCone);
   
-  auto freshCone = std::make_unique<ftr::Cone::Feature>();
-  freshCone->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshCone->serialRead(*sCone);
-  
-  return freshCone;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshCone = std::make_unique<ftr::Cone::Feature>();
+    freshCone->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshCone->serialRead(*sCone);
+    
+    return freshCone;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadBoolean(const std::string& fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadBoolean(const std::string& fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sBoolean = srl::bls::boolean(fileNameIn, flags);
+  auto sBoolean = share(srl::bls::boolean(fileNameIn, flags));
   assert(sBoolean);
   
-  auto freshBoolean = std::make_unique<ftr::Boolean::Feature>();
-  freshBoolean->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshBoolean->serialRead(*sBoolean);
-  
-  return freshBoolean;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshBoolean = std::make_unique<ftr::Boolean::Feature>();
+    freshBoolean->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshBoolean->serialRead(*sBoolean);
+    
+    return freshBoolean;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadInert(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadInert(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &)
 {
-  auto sInert = srl::ints::inert(fileNameIn, flags);
+  auto sInert = share(srl::ints::inert(fileNameIn, flags));
   assert(sInert);
   
-  auto freshInert = std::make_unique<ftr::Inert::Feature>(shapeVector.at(shapeOffsetIn));
-  freshInert->serialRead(*sInert);
-  
-  return freshInert;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshInert = std::make_unique<ftr::Inert::Feature>(shapeIn()); //inert needs its shape to construct.
+    freshInert->serialRead(*sInert);
+    
+    return freshInert;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadBlend(const std::string& fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadBlend(const std::string& fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sBlend = srl::blns::blend(fileNameIn, flags);
+  auto sBlend = share(srl::blns::blend(fileNameIn, flags));
   assert(sBlend);
   
-  auto freshBlend = std::make_unique<ftr::Blend::Feature>();
-  freshBlend->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshBlend->serialRead(*sBlend);
-  
-  return freshBlend;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshBlend = std::make_unique<ftr::Blend::Feature>();
+    freshBlend->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshBlend->serialRead(*sBlend);
+    
+    return freshBlend;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadChamfer(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadChamfer(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sChamfer = srl::chms::chamfer(fileNameIn, flags);
+  auto sChamfer = share(srl::chms::chamfer(fileNameIn, flags));
   assert(sChamfer);
   
-  auto freshChamfer = std::make_unique<ftr::Chamfer::Feature>();
-  freshChamfer->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshChamfer->serialRead(*sChamfer);
-  
-  return freshChamfer;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshChamfer = std::make_unique<ftr::Chamfer::Feature>();
+    freshChamfer->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshChamfer->serialRead(*sChamfer);
+    
+    return freshChamfer;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadDraft(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadDraft(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sDraft = srl::drfs::draft(fileNameIn, flags);
+  auto sDraft = share(srl::drfs::draft(fileNameIn, flags));
   assert(sDraft);
   
-  auto freshDraft = std::make_unique<ftr::Draft::Feature>();
-  freshDraft->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshDraft->serialRead(*sDraft);
-  
-  return freshDraft;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshDraft = std::make_unique<ftr::Draft::Feature>();
+    freshDraft->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshDraft->serialRead(*sDraft);
+    
+    return freshDraft;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadDatumPlane(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadDatumPlane(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto sDatumPlane = srl::dtps::datumPlane(fileNameIn, flags);
+  auto sDatumPlane = share(srl::dtps::datumPlane(fileNameIn, flags));
   assert(sDatumPlane);
   
-  auto freshDatumPlane = std::make_unique<ftr::DatumPlane::Feature>();
-  freshDatumPlane->serialRead(*sDatumPlane);
-  
-  return freshDatumPlane;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshDatumPlane = std::make_unique<ftr::DatumPlane::Feature>();
+    freshDatumPlane->serialRead(*sDatumPlane);
+    
+    return freshDatumPlane;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadHollow(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadHollow(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sHollow = srl::hlls::hollow(fileNameIn, flags);
+  auto sHollow = share(srl::hlls::hollow(fileNameIn, flags));
   assert(sHollow);
   
-  auto freshHollow = std::make_unique<ftr::Hollow::Feature>();
-  freshHollow->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshHollow->serialRead(*sHollow);
-  
-  return freshHollow;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshHollow = std::make_unique<ftr::Hollow::Feature>();
+    freshHollow->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshHollow->serialRead(*sHollow);
+    
+    return freshHollow;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadOblong(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadOblong(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sOblong = srl::obls::oblong(fileNameIn, flags);
+  auto sOblong = share(srl::obls::oblong(fileNameIn, flags));
   assert(sOblong);
   
-  auto freshOblong = std::make_unique<ftr::Oblong::Feature>();
-  freshOblong->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshOblong->serialRead(*sOblong);
-  
-  return freshOblong;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshOblong = std::make_unique<ftr::Oblong::Feature>();
+    freshOblong->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshOblong->serialRead(*sOblong);
+    
+    return freshOblong;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadExtract(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadExtract(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sExtract = srl::exts::extract(fileNameIn, flags);
+  auto sExtract = share(srl::exts::extract(fileNameIn, flags));
   assert(sExtract);
   
-  auto freshExtract = std::make_unique<ftr::Extract::Feature>();
-  freshExtract->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshExtract->serialRead(*sExtract);
-  
-  return freshExtract;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshExtract = std::make_unique<ftr::Extract::Feature>();
+    freshExtract->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshExtract->serialRead(*sExtract);
+    
+    return freshExtract;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSquash(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadSquash(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sSquash = srl::sqss::squash(fileNameIn, flags);
+  auto sSquash = share(srl::sqss::squash(fileNameIn, flags));
   assert(sSquash);
   
-  auto freshSquash = std::make_unique<ftr::Squash>();
-  freshSquash->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshSquash->serialRead(*sSquash);
-  
-  return freshSquash;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshSquash = std::make_unique<ftr::Squash>();
+    freshSquash->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshSquash->serialRead(*sSquash);
+    
+    return freshSquash;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadNest(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadNest(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sNest = srl::nsts::nest(fileNameIn, flags);
+  auto sNest = share(srl::nsts::nest(fileNameIn, flags));
   assert(sNest);
   
-  auto freshNest = std::make_unique<ftr::Nest>();
-  freshNest->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshNest->serialRead(*sNest);
-  
-  return freshNest;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshNest = std::make_unique<ftr::Nest>();
+    freshNest->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshNest->serialRead(*sNest);
+    
+    return freshNest;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadDieSet(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadDieSet(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sds = srl::dsts::dieset(fileNameIn, flags);
+  auto sds = share(srl::dsts::dieset(fileNameIn, flags));
   assert(sds);
   
-  auto freshDieSet = std::make_unique<ftr::DieSet>();
-  freshDieSet->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshDieSet->serialRead(*sds);
-  
-  return freshDieSet;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshDieSet = std::make_unique<ftr::DieSet>();
+    freshDieSet->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshDieSet->serialRead(*sds);
+    
+    return freshDieSet;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadStrip(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadStrip(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::stps::strip(fileNameIn, flags);
+  auto ss = share(srl::stps::strip(fileNameIn, flags));
   assert(ss);
   
-  auto freshStrip = std::make_unique<ftr::Strip::Feature>();
-  freshStrip->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshStrip->serialRead(*ss);
-  
-  return freshStrip;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshStrip = std::make_unique<ftr::Strip::Feature>();
+    freshStrip->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshStrip->serialRead(*ss);
+    
+    return freshStrip;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadQuote(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadQuote(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto sq = srl::qts::quote(fileNameIn, flags);
+  auto sq = share(srl::qts::quote(fileNameIn, flags));
   assert(sq);
   
-  auto freshQuote = std::make_unique<ftr::Quote::Feature>();
-  freshQuote->serialRead(*sq);
-  
-  return freshQuote;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshQuote = std::make_unique<ftr::Quote::Feature>();
+    freshQuote->serialRead(*sq);
+    
+    return freshQuote;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadRefine(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadRefine(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::rfns::refine(fileNameIn, flags);
+  auto sr = share(srl::rfns::refine(fileNameIn, flags));
   assert(sr);
   
-  auto freshRefine = std::make_unique<ftr::Refine::Feature>();
-  freshRefine->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshRefine->serialRead(*sr);
-  
-  return freshRefine;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshRefine = std::make_unique<ftr::Refine::Feature>();
+    freshRefine->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshRefine->serialRead(*sr);
+    
+    return freshRefine;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadInstanceLinear(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadInstanceLinear(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::inls::instanceLinear(fileNameIn, flags);
+  auto sr = share(srl::inls::instanceLinear(fileNameIn, flags));
   assert(sr);
   
-  auto freshInstanceLinear = std::make_unique<ftr::InstanceLinear::Feature>();
-  freshInstanceLinear->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshInstanceLinear->serialRead(*sr);
-  
-  return freshInstanceLinear;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshInstanceLinear = std::make_unique<ftr::InstanceLinear::Feature>();
+    freshInstanceLinear->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshInstanceLinear->serialRead(*sr);
+    
+    return freshInstanceLinear;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadInstanceMirror(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadInstanceMirror(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::inms::instanceMirror(fileNameIn, flags);
+  auto sr = share(srl::inms::instanceMirror(fileNameIn, flags));
   assert(sr);
   
-  auto freshInstanceMirror = std::make_unique<ftr::InstanceMirror::Feature>();
-  freshInstanceMirror->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshInstanceMirror->serialRead(*sr);
-  
-  return freshInstanceMirror;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshInstanceMirror = std::make_unique<ftr::InstanceMirror::Feature>();
+    freshInstanceMirror->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshInstanceMirror->serialRead(*sr);
+    
+    return freshInstanceMirror;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadInstancePolar(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadInstancePolar(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::inps::instancePolar(fileNameIn, flags);
+  auto sr = share(srl::inps::instancePolar(fileNameIn, flags));
   assert(sr);
   
-  auto freshInstancePolar = std::make_unique<ftr::InstancePolar::Feature>();
-  freshInstancePolar->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  freshInstancePolar->serialRead(*sr);
-  
-  return freshInstancePolar;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto freshInstancePolar = std::make_unique<ftr::InstancePolar::Feature>();
+    freshInstancePolar->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    freshInstancePolar->serialRead(*sr);
+    
+    return freshInstancePolar;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadOffset(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadOffset(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::offs::offset(fileNameIn, flags);
+  auto sr = share(srl::offs::offset(fileNameIn, flags));
   assert(sr);
   
-  auto offset = std::make_unique<ftr::Offset::Feature>();
-  offset->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  offset->serialRead(*sr);
-  
-  return offset;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto offset = std::make_unique<ftr::Offset::Feature>();
+    offset->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    offset->serialRead(*sr);
+    
+    return offset;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadThicken(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadThicken(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::thks::thicken(fileNameIn, flags);
+  auto sr = share(srl::thks::thicken(fileNameIn, flags));
   assert(sr);
   
-  auto thicken = std::make_unique<ftr::Thicken::Feature>();
-  thicken->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  thicken->serialRead(*sr);
-  
-  return thicken;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto thicken = std::make_unique<ftr::Thicken::Feature>();
+    thicken->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    thicken->serialRead(*sr);
+    
+    return thicken;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSew(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadSew(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::sws::sew(fileNameIn, flags);
+  auto sr = share(srl::sws::sew(fileNameIn, flags));
   assert(sr);
   
-  auto sew = std::make_unique<ftr::Sew::Feature>();
-  sew->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sew->serialRead(*sr);
-  
-  return sew;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sew = std::make_unique<ftr::Sew::Feature>();
+    sew->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sew->serialRead(*sr);
+    
+    return sew;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadTrim(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadTrim(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::trms::trim(fileNameIn, flags);
+  auto sr = share(srl::trms::trim(fileNameIn, flags));
   assert(sr);
   
-  auto trim = std::make_unique<ftr::Trim::Feature>();
-  trim->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  trim->serialRead(*sr);
-  
-  return trim;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto trim = std::make_unique<ftr::Trim::Feature>();
+    trim->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    trim->serialRead(*sr);
+    
+    return trim;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadRemoveFaces(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadRemoveFaces(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto sr = srl::rmfs::removeFaces(fileNameIn, flags);
+  auto sr = share(srl::rmfs::removeFaces(fileNameIn, flags));
   assert(sr);
   
-  auto rfs = std::make_unique<ftr::RemoveFaces::Feature>();
-  rfs->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  rfs->serialRead(*sr);
-  
-  return rfs;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto rfs = std::make_unique<ftr::RemoveFaces::Feature>();
+    rfs->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    rfs->serialRead(*sr);
+    
+    return rfs;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadTorus(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadTorus(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto st = srl::trss::torus(fileNameIn, flags);
+  auto st = share(srl::trss::torus(fileNameIn, flags));
   assert(st);
   
-  auto tf = std::make_unique<ftr::Torus::Feature>();
-  tf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  tf->serialRead(*st);
-  
-  return tf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto tf = std::make_unique<ftr::Torus::Feature>();
+    tf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    tf->serialRead(*st);
+    
+    return tf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadThread(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadThread(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto st = srl::thds::thread(fileNameIn, flags);
+  auto st = share(srl::thds::thread(fileNameIn, flags));
   assert(st);
   
-  auto tf = std::make_unique<ftr::Thread::Feature>();
-  tf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  tf->serialRead(*st);
-  
-  return tf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto tf = std::make_unique<ftr::Thread::Feature>();
+    tf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    tf->serialRead(*st);
+    
+    return tf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadDatumAxis(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadDatumAxis(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto sda = srl::dtas::datumAxis(fileNameIn, flags);
+  auto sda = share(srl::dtas::datumAxis(fileNameIn, flags));
   assert(sda);
   
-  auto daf = std::make_unique<ftr::DatumAxis::Feature>();
-  daf->serialRead(*sda);
-  
-  return daf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto daf = std::make_unique<ftr::DatumAxis::Feature>();
+    daf->serialRead(*sda);
+    
+    return daf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadExtrude(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadExtrude(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto se = srl::exrs::extrude(fileNameIn, flags);
+  auto se = share(srl::exrs::extrude(fileNameIn, flags));
   assert(se);
   
-  auto ef = std::make_unique<ftr::Extrude::Feature>();
-  ef->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  ef->serialRead(*se);
-  
-  return ef;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto ef = std::make_unique<ftr::Extrude::Feature>();
+    ef->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    ef->serialRead(*se);
+    
+    return ef;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadRevolve(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadRevolve(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto se = srl::rvls::revolve(fileNameIn, flags);
+  auto se = share(srl::rvls::revolve(fileNameIn, flags));
   assert(se);
   
-  auto ef = std::make_unique<ftr::Revolve::Feature>();
-  ef->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  ef->serialRead(*se);
-  
-  return ef;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto ef = std::make_unique<ftr::Revolve::Feature>();
+    ef->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    ef->serialRead(*se);
+    
+    return ef;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSketch(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadSketch(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::skts::sketch(fileNameIn, flags);
+  auto ss = share(srl::skts::sketch(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Sketch::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Sketch::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadLine(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadLine(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::lns::line(fileNameIn, flags);
+  auto ss = share(srl::lns::line(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Line>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Line>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSurfaceMesh(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadSurfaceMesh(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto ss = srl::sfms::surfaceMesh(fileNameIn, flags);
+  auto ss = share(srl::sfms::surfaceMesh(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::SurfaceMesh::Feature>();
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::SurfaceMesh::Feature>();
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadTransitionCurve(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadTransitionCurve(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::tscs::transitionCurve(fileNameIn, flags);
+  auto ss = share(srl::tscs::transitionCurve(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::TransitionCurve::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::TransitionCurve::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadRuled(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadRuled(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::rlds::ruled(fileNameIn, flags);
+  auto ss = share(srl::rlds::ruled(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Ruled::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Ruled::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadImagePlane(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadImagePlane(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto ss = srl::imps::imageplane(fileNameIn, flags);
+  auto ss = share(srl::imps::imageplane(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::ImagePlane>();
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::ImagePlane>();
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSweep(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadSweep(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::swps::sweep(fileNameIn, flags);
+  auto ss = share(srl::swps::sweep(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Sweep::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Sweep::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadDatumSystem(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadDatumSystem(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto sds = srl::dtms::datumsystem(fileNameIn, flags);
+  auto sds = share(srl::dtms::datumsystem(fileNameIn, flags));
   assert(sds);
   
-  auto daf = std::make_unique<ftr::DatumSystem::Feature>();
-  daf->serialRead(*sds);
-  
-  return daf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto daf = std::make_unique<ftr::DatumSystem::Feature>();
+    daf->serialRead(*sds);
+    
+    return daf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSurfaceReMesh(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadSurfaceReMesh(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto ssrm = srl::srms::surfaceremesh(fileNameIn, flags);
+  auto ssrm = share(srl::srms::surfaceremesh(fileNameIn, flags));
   assert(ssrm);
   
-  auto daf = std::make_unique<ftr::SurfaceReMesh>();
-  daf->serialRead(*ssrm);
-  
-  return daf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto daf = std::make_unique<ftr::SurfaceReMesh>();
+    daf->serialRead(*ssrm);
+    
+    return daf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadSurfaceMeshFill(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadSurfaceMeshFill(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto ssrm = srl::smfs::surfacemeshfill(fileNameIn, flags);
+  auto ssrm = share(srl::smfs::surfacemeshfill(fileNameIn, flags));
   assert(ssrm);
   
-  auto daf = std::make_unique<ftr::SurfaceMeshFill>();
-  daf->serialRead(*ssrm);
-  
-  return daf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto daf = std::make_unique<ftr::SurfaceMeshFill>();
+    daf->serialRead(*ssrm);
+    
+    return daf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadMapPCurve(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadMapPCurve(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::mpc::mappcurve(fileNameIn, flags);
+  auto ss = share(srl::mpc::mappcurve(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::MapPCurve::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::MapPCurve::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadUntrim(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadUntrim(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::utr::untrim(fileNameIn, flags);
+  auto ss = share(srl::utr::untrim(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Untrim::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Untrim::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadFace(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadFace(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::fce::face(fileNameIn, flags);
+  auto ss = share(srl::fce::face(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Face::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Face::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadFill(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadFill(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::fls::fill(fileNameIn, flags);
+  auto ss = share(srl::fls::fill(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Fill::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Fill::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadPrism(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadPrism(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::prsm::prism(fileNameIn, flags);
+  auto ss = share(srl::prsm::prism(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Prism::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Prism::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadUndercut(const std::string &fileNameIn, std::size_t)
+FeatureLoad::Build FeatureLoad::loadUndercut(const std::string &fileNameIn, const ShapeReader&, const boost::uuids::uuid &)
 {
-  auto ss = srl::und::undercut(fileNameIn, flags);
+  auto ss = share(srl::und::undercut(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::UnderCut::Feature>();
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::UnderCut::Feature>();
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadMutate(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadMutate(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::mtts::mutate(fileNameIn, flags);
+  auto ss = share(srl::mtts::mutate(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::Mutate::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::Mutate::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
 
-std::unique_ptr<ftr::Base> FeatureLoad::loadLawSpine(const std::string &fileNameIn, std::size_t shapeOffsetIn)
+FeatureLoad::Build FeatureLoad::loadLawSpine(const std::string &fileNameIn, const ShapeReader &shapeIn, const boost::uuids::uuid &featureId)
 {
-  auto ss = srl::lwsp::lawspine(fileNameIn, flags);
+  auto ss = share(srl::lwsp::lawspine(fileNameIn, flags));
   assert(ss);
   
-  auto sf = std::make_unique<ftr::LawSpine::Feature>();
-  sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeVector.at(shapeOffsetIn), featureId);
-  sf->serialRead(*ss);
-  
-  return sf;
+  return [=]() -> std::unique_ptr<ftr::Base>
+  {
+    auto sf = std::make_unique<ftr::LawSpine::Feature>();
+    sf->getAnnex<ann::SeerShape>().setOCCTShape(shapeIn, featureId);
+    sf->serialRead(*ss);
+    
+    return sf;
+  };
 }
@@ -28,8 +28,6 @@
 
 #include <boost/filesystem/path.hpp>
 
-#include "tools/shapevector.h"
-
 class TopoDS_Shape;
 
 namespace ftr{class Base;}
@@ -40,72 +38,77 @@ namespace prj
    * 
    * @brief Object for feature construction upon loading of project
    * 
+   * @details load only parses and is safe to call from multiple threads
+   * at once. It returns a function that constructs the feature. Features
+   * share osg nodes from lbr::Manager, so call that function on the gui thread.
+   * Xerces is not initialized by load, so the caller needs to keep
+   * it initialized for the life of this object.
    */
   class FeatureLoad
   {
   public:
-    FeatureLoad(const boost::filesystem::path &, const TopoDS_Shape&, bool = false);
-    std::unique_ptr<ftr::Base> load(const std::string &idIn, const std::string &typeIn, std::size_t shapeOffsetIn);
+    FeatureLoad(const boost::filesystem::path &, bool = false);
+    typedef std::function<std::unique_ptr<ftr::Base> ()> Build;
+    typedef std::function<TopoDS_Shape ()> ShapeReader; //!< called when the feature shape is first used.
+    Build load(const std::string &idIn, const std::string &typeIn, const ShapeReader &shapeIn);
   private:
     boost::filesystem::path directory;
     unsigned long flags = 0;
-    occt::ShapeVector shapeVector;
-    boost::uuids::uuid featureId;
     
-    typedef std::function<std::unique_ptr<ftr::Base> (const std::string &, std::size_t)> LoadFunction;
+    typedef std::function<Build (const std::string &, const ShapeReader&, const boost::uuids::uuid &)> LoadFunction;
     typedef std::map<std::string, LoadFunction> FunctionMap;
     FunctionMap functionMap;
     
-    std::unique_ptr<ftr::Base> loadBox(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadCylinder(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSphere(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadCone(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadBoolean(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadInert(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadBlend(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadChamfer(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadDraft(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadDatumPlane(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadHollow(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadOblong(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadExtract(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSquash(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadNest(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadDieSet(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadStrip(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadQuote(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadRefine(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadInstanceLinear(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadInstanceMirror(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadInstancePolar(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadOffset(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadThicken(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSew(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadTrim(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadRemoveFaces(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadTorus(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadThread(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadDatumAxis(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadExtrude(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadRevolve(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSketch(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadLine(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSurfaceMesh(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadTransitionCurve(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadRuled(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadImagePlane(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSweep(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadDatumSystem(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSurfaceReMesh(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadSurfaceMeshFill(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadMapPCurve(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadUntrim(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadFace(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadFill(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadPrism(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadUndercut(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadMutate(const std::string &, std::size_t);
-    std::unique_ptr<ftr::Base> loadLawSpine(const std::string &, std::size_t);
+    Build loadBox(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadCylinder(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSphere(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadCone(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadBoolean(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadInert(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadBlend(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadChamfer(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadDraft(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadDatumPlane(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadHollow(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadOblong(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadExtract(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSquash(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadNest(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadDieSet(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadStrip(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadQuote(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadRefine(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadInstanceLinear(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadInstanceMirror(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadInstancePolar(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadOffset(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadThicken(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSew(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadTrim(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadRemoveFaces(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadTorus(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadThread(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadDatumAxis(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadExtrude(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadRevolve(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSketch(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadLine(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSurfaceMesh(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadTransitionCurve(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadRuled(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadImagePlane(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSweep(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadDatumSystem(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSurfaceReMesh(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadSurfaceMeshFill(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadMapPCurve(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadUntrim(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadFace(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadFill(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadPrism(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadUndercut(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadMutate(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
+    Build loadLawSpine(const std::string &, const ShapeReader&, const boost::uuids::uuid &);
   };
 }
 
@@ -18,7 +18,12 @@
  */
 
 #include <cassert>
+#include <cstring>
 #include <ostream>
+#include <iostream>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
 
 #include <boost/filesystem.hpp>
 
@@ -31,6 +36,9 @@
 #include "subprojects/libgit2pp/src/exception.hpp"
 #include "subprojects/libgit2pp/src/revwalk.hpp"
 
+#include <git2.h>
+
+#include "tools/idtools.h"
 #include "preferences/preferencesXML.h"
 #include "preferences/prfmanager.h"
 #include "message/msgnode.h"
@@ -43,6 +51,21 @@ using namespace git2;
 
 static const std::string transName = "transaction";
 
+typedef std::unique_ptr<git_pathspec, decltype(&git_pathspec_free)> PathSpec;
+
+//! same matching status uses. null on error.
+static PathSpec buildPathSpec(const std::vector<std::string> &pathSpecs)
+{
+  std::vector<char*> raw;
+  for (const auto &ps : pathSpecs)
+    raw.push_back(const_cast<char*>(ps.c_str()));
+  git_strarray array{raw.data(), raw.size()};
+  git_pathspec *out = nullptr;
+  if (git_pathspec_new(&out, &array) != 0)
+    out = nullptr;
+  return PathSpec(out, &git_pathspec_free);
+}
+
 //debug helpers
 inline std::ostream& operator<<(std::ostream &stream, const Status &statusIn)
 {
@@ -95,12 +118,26 @@ GitManager::GitManager()
   sift->name = "prj::GitManager";
   node->setHandler(std::bind(&msg::Sift::receive, sift.get(), std::placeholders::_1));
   setupDispatcher();
+  
+  worker = std::thread(&GitManager::run, this);
 }
 
-GitManager::~GitManager(){}
+GitManager::~GitManager()
+{
+  //queued commits are finished before we go.
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  condition.notify_all();
+  worker.join();
+}
 
 void GitManager::create(const std::string& pathIn)
 {
+  flush();
+  projectPath = pathIn;
+  
   git_repository_init_options opts = GIT_REPOSITORY_INIT_OPTIONS_INIT;
   opts.flags |= GIT_REPOSITORY_INIT_MKPATH;
   repo = Repository::init
@@ -165,6 +202,9 @@ void GitManager::create(const std::string& pathIn)
 
 void GitManager::open(const std::string& pathIn)
 {
+  flush();
+  projectPath = pathIn;
+  
   repo = Repository::open(pathIn);
   
   //ensure scratch directory
@@ -182,6 +222,16 @@ void GitManager::open(const std::string& pathIn)
 
 void GitManager::save()
 {
+  if (commitsDisabled)
+    return;
+  
+  //commits only look at touched paths. Pick up anything else written.
+  flush();
+  touched.clear();
+  Request request = buildRequest();
+  request.changed = stage(std::vector<std::string>());
+  commit({request});
+  
   //something here to test and respond if index diff is NOT empty.
   
   git2::OId headCommit = repo.head().target();
@@ -241,14 +291,14 @@ void GitManager::save()
   trans.setTarget(newCommitId);
 }
 
-bool GitManager::updateIndex()
+bool GitManager::updateIndex(const std::vector<std::string> &pathSpecs)
 {
    //check status.
   StatusList statusList = repo.listStatus
   (
     GIT_STATUS_SHOW_INDEX_AND_WORKDIR,
     GIT_STATUS_OPT_INCLUDE_UNTRACKED | GIT_STATUS_OPT_RENAMES_HEAD_TO_INDEX | GIT_STATUS_OPT_SORT_CASE_SENSITIVELY,
-    std::vector<std::string>()
+    pathSpecs
   );
   
   bool needCommit = false;
@@ -279,30 +329,312 @@ bool GitManager::updateIndex()
 
 void GitManager::update()
 {
-  if (!updateIndex())
+  if (commitsDisabled)
+  {
+    touched.clear();
+    return;
+  }
+  
+  //no touched paths means check everything. That is a status scan
+  //of the whole directory, so it stays on the gui thread like save.
+  std::vector<std::string> pathSpecs(touched.begin(), touched.end());
+  touched.clear();
+  Request request = buildRequest();
+  if (pathSpecs.empty() || !snapshot(request, pathSpecs))
+    request.changed = stage(pathSpecs);
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    requests.push_back(std::move(request));
+    stats.updates++;
+  }
+  condition.notify_all();
+}
+
+void GitManager::touch(const std::string &pathSpec)
+{
+  touched.insert(pathSpec);
+}
+
+void GitManager::touchFeature(const boost::uuids::uuid &featureId)
+{
+  //feature file, side car files and things like quote pictures.
+  touched.insert(gu::idToString(featureId) + "*");
+}
+
+void GitManager::flush()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  if (requests.empty() && !working)
+    return;
+  hurry = true;
+  condition.notify_all();
+  condition.wait(lock, [&](){return requests.empty() && !working;});
+  hurry = false;
+}
+
+GitManager::Stats GitManager::getStats()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return stats;
+}
+
+/*! @brief Add changed files to the index and the object database.
+ * 
+ * @details Status scan and blob writes on the calling thread. Used by
+ * save and when nothing was touched. see snapshot for update.
+ * @return false when nothing has changed or on error.
+ */
+bool GitManager::stage(const std::vector<std::string> &pathSpecs)
+{
+  std::lock_guard<std::mutex> lock(repoMutex);
+  try
+  {
+    return updateIndex(pathSpecs);
+  }
+  catch(const git2::Exception &e)
+  {
+    std::cerr << "ERROR: " << e.message() << ", in GitManager::stage" << std::endl;
+  }
+  return false;
+}
+
+/*! @brief Read the files matching path specs into the request.
+ * 
+ * @details Done on the gui thread, so the worker commits the files as
+ * they were at update, even if the next update or shape store prune
+ * writes them again. This is a directory listing and reads of small
+ * files. Shape store files are named by their content and never
+ * rewritten, so only their names are taken here. Hashing, writing
+ * blobs and the index are left to the worker. see apply.
+ * @return false if the work tree couldn't be read. Nothing is taken.
+ */
+bool GitManager::snapshot(Request &request, const std::vector<std::string> &pathSpecs)
+{
+  namespace bfs = boost::filesystem;
+  
+  PathSpec spec = buildPathSpec(pathSpecs);
+  if (!spec)
+    return false;
+  
+  bfs::path root(projectPath);
+  std::vector<File> files;
+  bool failed = false;
+  auto take = [&](const bfs::directory_entry &entry)
+  {
+    if (!bfs::is_regular_file(entry.status()))
+      return;
+    File file;
+    file.path = entry.path().lexically_relative(root).generic_string();
+    if (git_pathspec_matches_path(spec.get(), 0, file.path.c_str()) != 1)
+      return;
+    file.stored = file.path.compare(0, 7, "shapes/") == 0 && entry.path().extension() == ".bin";
+    if (!file.stored)
+    {
+      std::ifstream stream(entry.path().string(), std::ios_base::in | std::ios_base::binary);
+      if (!stream)
+      {
+        failed = true;
+        return;
+      }
+      file.contents.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    files.push_back(std::move(file));
+  };
+  
+  //a file we miss would be removed from the index. So any error gives up.
+  boost::system::error_code ec;
+  for (bfs::directory_iterator it(root, ec), end; !ec && !failed && it != end; it.increment(ec))
+  {
+    if (!bfs::is_directory(it->status()))
+    {
+      take(*it);
+      continue;
+    }
+    std::string name = it->path().filename().string();
+    if (name == ".git" || name == ".scratch")
+      continue;
+    for (bfs::recursive_directory_iterator rit(it->path(), ec), rend; !ec && !failed && rit != rend; rit.increment(ec))
+      take(*rit);
+  }
+  if (ec || failed)
+  {
+    std::cout << "WARNING: couldn't read work tree in GitManager::snapshot" << std::endl;
+    return false;
+  }
+  
+  request.snapshot = true;
+  request.pathSpecs = pathSpecs;
+  request.files = std::move(files);
+  return true;
+}
+
+/*! @brief Stage a snapshot from update.
+ * 
+ * @details Files whose blob differs from the index entry are written
+ * to the object database and index. Index entries matching the path
+ * specs that weren't in the work tree are removed.
+ * @return true if the index changed.
+ */
+bool GitManager::apply(const Request &request)
+{
+  namespace bfs = boost::filesystem;
+  
+  PathSpec spec = buildPathSpec(request.pathSpecs);
+  if (!spec)
+    return false;
+  git_index *rawIndex = repo.index().data();
+  
+  bool changed = false;
+  std::set<std::string> present;
+  for (const File &file : request.files)
+  {
+    present.insert(file.path);
+    const git_index_entry *old = git_index_get_bypath(rawIndex, file.path.c_str(), 0);
+    if (file.stored && old)
+      continue; //same name is same content.
+    
+    std::string stored;
+    if (file.stored)
+    {
+      //never rewritten, only pruned. Pruned means nothing to add.
+      std::ifstream stream((bfs::path(projectPath) / file.path).string(), std::ios_base::in | std::ios_base::binary);
+      if (!stream)
+        continue;
+      stored.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+    }
+    const std::string &bytes = file.stored ? stored : file.contents;
+    
+    git_oid oid;
+    Exception::git2_assert(git_odb_hash(&oid, bytes.data(), bytes.size(), GIT_OBJECT_BLOB));
+    if (old && git_oid_equal(&oid, &old->id))
+      continue;
+    Exception::git2_assert(git_blob_create_from_buffer(&oid, repo.data(), bytes.data(), bytes.size()));
+    
+    git_index_entry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.mode = GIT_FILEMODE_BLOB;
+    entry.id = oid;
+    entry.path = file.path.c_str();
+    entry.file_size = static_cast<std::uint32_t>(bytes.size());
+    Exception::git2_assert(git_index_add(rawIndex, &entry));
+    changed = true;
+  }
+  
+  std::vector<std::string> removed;
+  for (std::size_t index = 0; index < git_index_entrycount(rawIndex); ++index)
+  {
+    const git_index_entry *entry = git_index_get_byindex(rawIndex, index);
+    if (present.count(entry->path) == 0 && git_pathspec_matches_path(spec.get(), 0, entry->path) == 1)
+      removed.push_back(entry->path);
+  }
+  for (const auto &path : removed)
+  {
+    Exception::git2_assert(git_index_remove_bypath(rawIndex, path.c_str()));
+    changed = true;
+  }
+  
+  if (changed)
+    Exception::git2_assert(git_index_write(rawIndex));
+  return changed;
+}
+
+GitManager::Request GitManager::buildRequest()
+{
+  Request out;
+  out.message = commitMessage;
+  commitMessage.clear();
+  out.name = prf::manager().rootPtr->project().gitName();
+  out.email = prf::manager().rootPtr->project().gitEmail();
+  out.queued = std::chrono::steady_clock::now();
+  return out;
+}
+
+void GitManager::run()
+{
+  //updates that arrive within this time of the first are committed together.
+  const std::chrono::milliseconds coalesce(250);
+  
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;)
+  {
+    condition.wait(lock, [&](){return stopping || !requests.empty();});
+    if (requests.empty())
+      return; //stopping with nothing left to do.
+    
+    auto deadline = requests.front().queued + coalesce;
+    condition.wait_until(lock, deadline, [&](){return stopping || hurry;});
+    std::vector<Request> batch;
+    batch.swap(requests);
+    working = true;
+    lock.unlock();
+    
+    auto start = std::chrono::steady_clock::now();
+    try
+    {
+      commit(batch);
+    }
+    catch(const git2::Exception &e)
+    {
+      std::cerr << "ERROR: " << e.message() << ", in GitManager::run" << std::endl;
+    }
+    auto finish = std::chrono::steady_clock::now();
+    
+    lock.lock();
+    working = false;
+    std::chrono::duration<double, std::milli> latency = finish - batch.front().queued;
+    std::chrono::duration<double, std::milli> work = finish - start;
+    stats.commits++;
+    stats.lastLatency = latency.count();
+    stats.maxLatency = std::max(stats.maxLatency, latency.count());
+    stats.totalLatency += latency.count();
+    stats.lastWork = work.count();
+    stats.totalWork += work.count();
+    condition.notify_all();
+  }
+}
+
+void GitManager::commit(const std::vector<Request> &batch)
+{
+  assert(!batch.empty());
+  
+  //snapshots are staged here. Others already were. see stage.
+  std::lock_guard<std::mutex> lock(repoMutex);
+  bool changed = false;
+  std::string message;
+  for (const auto &request : batch)
+  {
+    changed |= request.changed;
+    if (request.snapshot)
+      changed |= apply(request);
+    if (request.message.empty())
+      continue;
+    if (message.empty())
+      message = request.message;
+    else
+      message += "\n    " + request.message;
+  }
+  if (!changed)
     return;
   
   //had a crash when putting sig builder constructor in sig constructor.
-  SignatureBuilder sigBuilder(prf::manager().rootPtr->project().gitName(), prf::manager().rootPtr->project().gitEmail());
+  SignatureBuilder sigBuilder(batch.back().name, batch.back().email);
   Signature sig(sigBuilder);
   OId treeId = repo.index().writeTree();
   std::list<Commit> parents;
   parents.push_back(repo.lookupCommit(repo.lookupReferenceOId("HEAD")));
   
-  if (commitMessage.empty())
-    commitMessage = "no message";
+  if (message.empty())
+    message = "no message";
   
   repo.createCommit
   (
     "HEAD",
     sig,
     sig,
-    commitMessage,
+    message,
     repo.lookupTree(treeId),
     parents
   );
-  
-  commitMessage.clear();
 }
 
 void GitManager::appendGitMessage(const std::string& message)
@@ -332,6 +664,8 @@ void GitManager::createBranch(const std::string& nameIn)
 
 git2::Commit GitManager::getCurrentHead()
 {
+  flush();
+  
   git2::Commit out;
   try
   {
@@ -347,6 +681,8 @@ git2::Commit GitManager::getCurrentHead()
 
 std::vector<git2::Commit> GitManager::getCommitsHeadToNamed(const std::string &referenceNameIn)
 {
+  flush();
+  
   git2::OId rid; //reference id.
   
   auto setIdOfPrefix = [&](const std::string &prefix)
@@ -385,6 +721,8 @@ std::vector<git2::Commit> GitManager::getCommitsHeadToNamed(const std::string &r
 
 void GitManager::resetHard(const std::string &commitIn)
 {
+  flush();
+  
   git2::OId cId;
   cId.fromString(commitIn);
   git2::Commit c = repo.lookupCommit(cId); 
@@ -393,6 +731,8 @@ void GitManager::resetHard(const std::string &commitIn)
 
 std::vector<git2::Tag> GitManager::getTags()
 {
+  flush();
+  
   /* keep in mind that git has 2 types of tags: lightweight and annotate.
    * this was throwing me off as the lightweight tags have no object
    * in the git object database. We get an exception when lookupTag gets passed
@@ -422,6 +762,8 @@ std::vector<git2::Tag> GitManager::getTags()
 
 void GitManager::createTag(const std::string &name, const std::string &message)
 {
+  flush();
+  
   try
   {
     SignatureBuilder sigBuilder(prf::manager().rootPtr->project().gitName(), prf::manager().rootPtr->project().gitEmail());
@@ -444,6 +786,8 @@ void GitManager::createTag(const std::string &name, const std::string &message)
 
 void GitManager::destroyTag(const std::string &name)
 {
+  flush();
+  
   try
   {
     repo.deleteTag(name);
@@ -456,6 +800,8 @@ void GitManager::destroyTag(const std::string &name)
 
 void GitManager::checkoutTag(const git2::Tag &tag)
 {
+  flush();
+  
   try
   {
     git2::Commit tagCommit = repo.lookupCommit(tag.targetOid());
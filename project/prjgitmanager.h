@@ -21,6 +21,15 @@
 #define PRJ_GITMANAGER_H
 
 #include <memory>
+#include <set>
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+#include <boost/uuid/uuid.hpp>
 
 #include "subprojects/libgit2pp/src/repository.hpp"
 #include "subprojects/libgit2pp/src/commit.hpp"
@@ -48,6 +57,13 @@ namespace prj
     * @note only 2 branches, 'main' and 'transaction', that are not exposed to the user.
     * @note revision is synonymous for a git tag. User can add and remove tags. Loss of work.
     * @note potential loss of work when checking out a revision.
+    * 
+    * update reads the files matching the paths reported with touch into
+    * memory right away. Writing their blobs, the index and the commit are
+    * queued and done on a worker thread. Updates that arrive close
+    * together are coalesced into 1 commit. Files written without a touch
+    * are picked up by save, which scans the whole directory. Everything
+    * else that reads or changes the repo waits for the queue.
     */
   class GitManager
   {
@@ -56,12 +72,30 @@ namespace prj
     ~GitManager();
     void open(const std::string &);
     void create(const std::string &);
-    void update();
+    void update(); //!< snapshot touched paths and queue a commit.
+    void touch(const std::string &pathSpec); //!< relative to project. may use wildcards.
+    void touchFeature(const boost::uuids::uuid&); //!< all files with the feature id stem.
+    void flush(); //!< blocks until queued commits are done.
     void save();
     void appendGitMessage(const std::string &message);
     void freezeGitMessages(){gitMessagesFrozen = true;}
     void thawGitMessages(){gitMessagesFrozen = false;}
     bool areGitMessagesFrozen(){return gitMessagesFrozen;}
+    void disableCommits(){commitsDisabled = true;} //!< update and save leave the repo alone. batch runs.
+    void enableCommits(){commitsDisabled = false;}
+    bool areCommitsDisabled(){return commitsDisabled;}
+    
+    struct Stats
+    {
+      std::size_t updates = 0; //!< update calls that queued a commit.
+      std::size_t commits = 0; //!< commits made by the worker.
+      double lastLatency = 0.0; //!< milliseconds from first queued update to commit.
+      double maxLatency = 0.0;
+      double totalLatency = 0.0;
+      double lastWork = 0.0; //!< milliseconds spent on index and commit.
+      double totalWork = 0.0;
+    };
+    Stats getStats(); //!< copy. any thread.
     
     git2::Commit getCurrentHead();
     
@@ -107,11 +141,48 @@ namespace prj
     void checkoutTag(const git2::Tag &tag);
     
   private:
-    bool updateIndex(); //false means nothing has changed.
+    bool updateIndex(const std::vector<std::string>& = std::vector<std::string>()); //false means nothing has changed. empty is everything.
     void createBranch(const std::string &nameIn); //!< create a branch with name from current HEAD.
     git2::Repository repo;
+    std::string projectPath;
     std::string commitMessage;
     bool gitMessagesFrozen = false;
+    bool commitsDisabled = false;
+    
+    //! one work tree file read at update.
+    struct File
+    {
+      std::string path; //!< relative to project with '/' separators.
+      std::string contents;
+      bool stored = false; //!< shape store file. named by content, so contents are read only if new.
+    };
+    struct Request
+    {
+      std::string message;
+      bool changed = false; //!< something was staged.
+      bool snapshot = false; //!< files are to be staged by the worker. see apply.
+      std::vector<std::string> pathSpecs; //!< index entries matching these and not in files are removed.
+      std::vector<File> files; //!< work tree files matching pathSpecs at update.
+      std::string name; //!< signature
+      std::string email; //!< signature
+      std::chrono::steady_clock::time_point queued;
+    };
+    std::set<std::string> touched; //!< since last update. gui thread.
+    std::vector<Request> requests; //!< waiting for worker. guarded by mutex.
+    bool working = false; //!< worker is committing. guarded by mutex.
+    bool hurry = false; //!< skip the coalesce wait. guarded by mutex.
+    bool stopping = false; //!< guarded by mutex.
+    Stats stats; //!< guarded by mutex.
+    std::mutex mutex;
+    std::mutex repoMutex; //!< index and objects while the worker might be committing.
+    std::condition_variable condition;
+    std::thread worker;
+    Request buildRequest(); //!< takes message. gui thread.
+    bool stage(const std::vector<std::string>&); //!< gui thread.
+    bool snapshot(Request&, const std::vector<std::string>&); //!< gui thread.
+    bool apply(const Request&); //!< worker thread with repoMutex.
+    void run(); //!< worker thread.
+    void commit(const std::vector<Request>&); //!< worker thread or idle queue.
     std::unique_ptr<msg::Node> node;
     std::unique_ptr<msg::Sift> sift;
     void setupDispatcher();
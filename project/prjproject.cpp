@@ -20,8 +20,15 @@
 #include <assert.h>
 #include <iostream>
 #include <stack>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+#include <iomanip>
 
 #include <QTextStream>
+#include <QEventLoop>
+#include <QTimer>
+#include <QKeyEvent>
 
 #include <boost/graph/topological_sort.hpp>
 #include <boost/graph/filtered_graph.hpp>
@@ -35,24 +42,34 @@
 #include <BRepTools.hxx>
 #include <BRepBuilderAPI_MakeVertex.hxx>
 #include <TopoDS.hxx>
+#include <TopoDS_Iterator.hxx>
 
 #include <osg/ValueObject>
+#include <osg/Switch>
+
+#include <xsd/cxx/xml/elements.hxx>
 
 #include "application/appapplication.h"
+#include "application/appmainwindow.h"
+#include "viewer/vwrwidget.h"
 #include "globalutilities.h"
 #include "tools/idtools.h"
 #include "tools/occtools.h"
+#include "tools/shapevector.h"
 #include "feature/ftrbase.h"
 #include "annex/annseershape.h"
 #include "annex/anncsysdragger.h"
 #include "feature/ftrinert.h"
 #include "feature/ftrmessage.h"
+#include "feature/ftrshapecheck.h"
 #include "parameter/prmparameter.h"
 #include "message/msgmessage.h"
 #include "project/prjmessage.h"
 #include "tools/graphtools.h"
 #include "tools/tlsnameindexer.h"
+#include "tools/tlsparallel.h"
 #include "project/prjfeatureload.h"
+#include "project/prjupdatejob.h"
 // #include "project/serial/xsdcxxoutput/shapehistory.h"
 #include "project/serial/generated/prjsrlprjsproject.h"
 #include "project/prjstow.h"
@@ -63,6 +80,50 @@ using namespace boost::filesystem;
 using namespace prj;
 using boost::uuids::uuid;
 
+namespace
+{
+  /*! @brief Holds off user input during a background model update.
+   * 
+   * @details Escape to the viewer still goes through, so the update
+   * can be cancelled. Everything else, menus, tool bars, shortcuts,
+   * dag view, viewer picking and prehighlight etc.., is swallowed
+   * until the update is done. Picking would reach into the scene
+   * graph of features the worker is changing.
+   */
+  class InputFilter : public QObject
+  {
+  public:
+    bool eventFilter(QObject *watched, QEvent *event) override
+    {
+      switch (event->type())
+      {
+        case QEvent::KeyPress:
+        case QEvent::KeyRelease:
+          return !(isViewer(watched) && static_cast<QKeyEvent*>(event)->key() == Qt::Key_Escape);
+        case QEvent::MouseButtonPress:
+        case QEvent::MouseButtonRelease:
+        case QEvent::MouseButtonDblClick:
+        case QEvent::MouseMove:
+        case QEvent::Wheel:
+        case QEvent::ContextMenu:
+        case QEvent::Shortcut:
+          return true;
+        default:
+          return false;
+      }
+    }
+  private:
+    bool isViewer(QObject *watched) const
+    {
+      QWidget *widget = qobject_cast<QWidget*>(watched);
+      if (!widget || !app::instance() || !app::instance()->getMainWindow())
+        return false;
+      QWidget *viewer = app::instance()->getMainWindow()->getViewer();
+      return viewer && (widget == viewer || viewer->isAncestorOf(widget));
+    }
+  };
+}
+
 Project::Project()
 : stow(new Stow(*this))
 {
@@ -77,6 +138,73 @@ QTextStream& Project::getInfo(QTextStream &stream) const
   << QObject::tr("Project Directory: ") << QString::fromStdString(getSaveDirectory().string()) << Qt::endl;
   //maybe some git stuff.
   
+  std::size_t live = 0;
+  for (auto v : boost::make_iterator_range(boost::vertices(stow->graph)))
+  {
+    if (stow->graph[v].alive)
+      live++;
+  }
+  stream
+  << QObject::tr("Graph vertices: ")
+  << live << QObject::tr(" live, ")
+  << boost::num_vertices(stow->graph) - live << QObject::tr(" dead, ")
+  << stow->compactStats.removed << QObject::tr(" compacted in ")
+  << stow->compactStats.runs << QObject::tr(" runs") << Qt::endl;
+  
+  stream
+  << QObject::tr("Shape history on last update: ")
+  << stow->historyStats.refilled << QObject::tr(" features filled, ")
+  << stow->historyStats.kept << QObject::tr(" kept, ")
+  << QString::number(stow->historyStats.milliseconds, 'f', 3) << QObject::tr(" ms") << Qt::endl;
+  
+  std::size_t pendingShapes = 0;
+  for (auto v : boost::make_iterator_range(boost::vertices(stow->graph)))
+  {
+    const ftr::Base *f = stow->graph[v].feature.get();
+    if (stow->graph[v].alive && f->hasAnnex(ann::Type::SeerShape) && f->getAnnex<ann::SeerShape>().isPending())
+      pendingShapes++;
+  }
+  
+  const UpdatePlan &plan = stow->updatePlan;
+  std::size_t widest = 0;
+  for (const auto &wave : plan.getWaves())
+    widest = std::max(widest, wave.size());
+  stream
+  << QObject::tr("Update plan: ")
+  << ((plan.isValid()) ? QObject::tr("valid, ") : QObject::tr("invalid, "))
+  << plan.getOrder().size() << QObject::tr(" features in ")
+  << plan.getWaves().size() << QObject::tr(" waves, widest wave ")
+  << widest << QObject::tr(", built ")
+  << plan.getBuildCount() << QObject::tr(" times") << Qt::endl;
+  
+  stream
+  << QObject::tr("Shape store: ")
+  << stow->shapeStore.getSerializeCount() << QObject::tr(" shapes serialized, ")
+  << stow->shapeStore.getFileWriteCount() << QObject::tr(" files written, ")
+  << stow->shapeStore.getFileReadCount() << QObject::tr(" files read, ")
+  << stow->shapeStore.getSharedReadCount() << QObject::tr(" reads shared, ")
+  << pendingShapes << QObject::tr(" features not read yet") << Qt::endl;
+  
+  GitManager::Stats gitStats = stow->gitManager.getStats();
+  double averageLatency = (gitStats.commits == 0) ? 0.0 : gitStats.totalLatency / gitStats.commits;
+  stream
+  << QObject::tr("Git: ")
+  << gitStats.updates << QObject::tr(" updates in ")
+  << gitStats.commits << QObject::tr(" commits, latency last ")
+  << QString::number(gitStats.lastLatency, 'f', 1) << QObject::tr(" ms, average ")
+  << QString::number(averageLatency, 'f', 1) << QObject::tr(" ms, max ")
+  << QString::number(gitStats.maxLatency, 'f', 1) << QObject::tr(" ms, last work ")
+  << QString::number(gitStats.lastWork, 'f', 1) << QObject::tr(" ms") << Qt::endl;
+  
+  ftr::ShapeCheck::Stats checkStats = ftr::ShapeCheck::getStats();
+  stream
+  << QObject::tr("Shape checks: ")
+  << ((ftr::ShapeCheck::getMode() == ftr::ShapeCheck::Mode::Deferred) ? QObject::tr("deferred, ") : QObject::tr("full, "))
+  << checkStats.checks << QObject::tr(" checks, ")
+  << checkStats.deferred << QObject::tr(" deferred, ")
+  << checkStats.analyzed << QObject::tr(" sub shapes analyzed, ")
+  << checkStats.cacheHits << QObject::tr(" reused") << Qt::endl;
+  
   stow->expressionManager.getInfo(stream);
   
   return stream;
@@ -92,68 +220,290 @@ GitManager& Project::getGitManager()
   return stow->gitManager;
 }
 
+/*! @brief Update dirty features
+ * 
+ * @details Feature updates run on a worker thread while this thread
+ * runs an event loop, so the gui stays responsive. Features are hidden
+ * while they update and only escape reaches the viewer. The call still
+ * returns after the update is done. Update requests made while an
+ * update is running are remembered and run after it. @see cancelUpdate
+ */
 void Project::updateModel()
 {
-  stow->node.send(msg::Message(msg::Response | msg::Pre | msg::Project | msg::Update | msg::Model));
-  
-  Vertices sorted;
-  try
+  if (stow->updateJob)
   {
-//     indexVerticesEdges();
-    boost::topological_sort(stow->graph, std::back_inserter(sorted));
+    stow->updatePending = true;
+    return;
   }
-  catch(const boost::not_a_dag &)
+  
+  stow->timings.clear();
+  ftr::ShapeCheck::resetStats();
+  do
   {
-    std::cout << std::endl << "Graph is not a dag exception in Project::updateModel()" << std::endl << std::endl;
+    stow->updatePending = false;
+    updateModelPass();
+  } while (stow->updatePending);
+  
+  //verdicts hold TShapes alive. only useful within an update.
+  ftr::ShapeCheck::clearCache();
+}
+
+bool Project::isUpdating() const
+{
+  return static_cast<bool>(stow->updateJob);
+}
+
+//! @brief Stop a running model update. Features not started stay dirty.
+void Project::cancelUpdate()
+{
+  stow->updatePending = false;
+  if (stow->updateJob)
+    stow->updateJob->cancel();
+}
+
+void Project::updateModelPass()
+{
+  //check before Pre so listeners always get the matching Post.
+  const UpdatePlan &plan = stow->getUpdatePlan();
+  if (!plan.isValid())
     return;
-  }
+  
+  stow->node.send(msg::Message(msg::Response | msg::Pre | msg::Project | msg::Update | msg::Model));
   
   //the update of a feature will trigger a state change signal.
   //we don't want to handle that state change here in the project
   //so we block.
   auto block = stow->node.createBlocker();
   
-  stow->shapeHistory.clear(); //reset history structure.
+  /* features are grouped into waves by their depth in the graph. The
+   * members of a wave don't depend on each other, so dirty members
+   * of a wave are updated concurrently. Shape history is only read
+   * during a wave and is filled, in topological order, between waves.
+   * This keeps the history identical to a sequential update.
+   * 
+   * shape history isn't rebuilt. Dirty features and their descendants
+   * have their part of the history removed up front and filled in again
+   * after their wave. Clean features keep theirs.
+   */
+  const std::vector<Vertices> &waves = plan.getWaves();
+  std::vector<bool> refills(boost::num_vertices(stow->graph), false);
+  std::vector<boost::uuids::uuid> refillIds;
+  for (auto v : plan.getOrder())
+  {
+    bool refill = !stow->graph[v].feature->isModelClean();
+    for (auto p : plan.getParents(v))
+      refill = refill || refills[p];
+    refills[v] = refill;
+    if (refill)
+      refillIds.push_back(stow->graph[v].feature->getId());
+  }
+  
+  std::chrono::duration<double, std::milli> historyTime(0.0);
+  auto historyStart = std::chrono::steady_clock::now();
+  stow->shapeHistory.removeFeatures(refillIds);
+  historyTime += std::chrono::steady_clock::now() - historyStart;
   
-  //loop through and update each feature.
-  for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+  struct Job
   {
-    Vertex currentVertex = *it;
-    ftr::Base *cFeature = stow->graph[currentVertex].feature.get();
-    
-    if (!stow->graph[currentVertex].alive)
-      continue;
-    
-    if
-    (
-      (cFeature->isModelClean()) ||
-      (stow->isFeatureInactive(currentVertex))
-    )
+    Vertex vertex;
+    ftr::UpdatePayload::UpdateMap updateMap;
+    msg::Deferral deferral;
+    bool concurrent = true; //!< false runs the feature alone.
+    osg::Node::NodeMask mainMask = 0; //!< restored when job is flushed.
+    osg::Node::NodeMask overlayMask = 0; //!< restored when job is flushed.
+  };
+  
+  //jobs of all waves in wave order. waveEnds holds one past the last job of each wave.
+  std::vector<Job> jobs;
+  std::vector<std::size_t> waveEnds;
+  for (const auto &wave : waves)
+  {
+    for (auto v : wave)
     {
-      cFeature->fillInHistory(stow->shapeHistory);
-      continue;
+      ftr::Base *cFeature = stow->graph[v].feature.get();
+      if ((cFeature->isModelClean()) || (stow->isFeatureInactive(v)))
+        continue;
+      
+      jobs.emplace_back();
+      jobs.back().vertex = v;
+      jobs.back().updateMap = plan.getParentMap(v);
+      jobs.back().concurrent = cFeature->isConcurrentSafe();
     }
-    
-    std::ostringstream messageStream;
-    messageStream << "Updating: " << cFeature->getName().toStdString() << "    Id: " << gu::idToShortString(cFeature->getId());
-    stow->node.send(msg::buildStatusMessage(messageStream.str()));
-    qApp->processEvents(); //need this or we won't see messages.
-    
-    RemovedGraph removedGraph = buildRemovedGraph(stow->graph);
-    ReversedGraph reversedGraph = boost::make_reverse_graph(removedGraph);
-    ftr::UpdatePayload::UpdateMap updateMap =
-    buildAjacentUpdateMap
-    <
-      ReversedGraph,
-      boost::graph_traits<ReversedGraph>::vertex_descriptor
-    >(reversedGraph, currentVertex);
-    
-    ftr::UpdatePayload payload(updateMap, stow->shapeHistory);
-    cFeature->updateModel(payload);
-    cFeature->serialWrite(stow->saveDirectory);
-    cFeature->fillInHistory(stow->shapeHistory);
+    waveEnds.push_back(jobs.size());
   }
   
+  /* features change their own scene graph nodes in updateModel. Cull,
+   * update and intersect traversals skip a node with a zero mask, so
+   * the features are out of rendering and picking until their job is
+   * flushed. Only this thread touches these masks.
+   */
+  for (auto &job : jobs)
+  {
+    ftr::Base *cFeature = stow->graph[job.vertex].feature.get();
+    job.mainMask = cFeature->getMainSwitch()->getNodeMask();
+    job.overlayMask = cFeature->getOverlaySwitch()->getNodeMask();
+    cFeature->getMainSwitch()->setNodeMask(0);
+    cFeature->getOverlaySwitch()->setNodeMask(0);
+  }
+  
+  /* from here until the worker is done, this thread only reads the graph.
+   * The worker owns the features being updated and the shape history.
+   */
+  auto updateJob = std::make_shared<UpdateJob>();
+  stow->updateJob = updateJob;
+  QEventLoop loop;
+  std::thread worker([&]()
+  {
+    try
+    {
+      std::size_t waveStart = 0;
+      for (std::size_t wave = 0; wave < waves.size(); ++wave)
+      {
+        auto runJob = [&](std::size_t index)
+        {
+          if (updateJob->isCancelled())
+          {
+            updateJob->post({UpdateJob::Progress::Kind::Skipped, index, 0.0});
+            return;
+          }
+          updateJob->post({UpdateJob::Progress::Kind::Started, index, 0.0});
+          auto jobStart = std::chrono::steady_clock::now();
+          Job &job = jobs.at(index);
+          try
+          {
+            msg::DeferralScope deferralScope(job.deferral);
+            ftr::UpdatePayload payload(job.updateMap, stow->shapeHistory);
+            stow->graph[job.vertex].feature->updateModel(payload);
+          }
+          catch (const std::exception &e)
+          {
+            std::cerr << "exception in feature update: " << e.what() << std::endl;
+          }
+          catch (...)
+          {
+            std::cerr << "unknown exception in feature update" << std::endl;
+          }
+          std::chrono::duration<double, std::milli> jobTime = std::chrono::steady_clock::now() - jobStart;
+          updateJob->post({UpdateJob::Progress::Kind::Finished, index, jobTime.count()});
+        };
+        //features wrapping a library with global state run one at a time after the others.
+        std::vector<std::size_t> concurrents;
+        std::vector<std::size_t> serials;
+        for (std::size_t index = waveStart; index < waveEnds.at(wave); ++index)
+        {
+          if (jobs.at(index).concurrent)
+            concurrents.push_back(index);
+          else
+            serials.push_back(index);
+        }
+        tls::parallelFor(concurrents.size(), [&](std::size_t offset){runJob(concurrents.at(offset));}, stow->updateThreadCount);
+        for (auto index : serials)
+          runJob(index);
+        waveStart = waveEnds.at(wave);
+      
+        auto fillStart = std::chrono::steady_clock::now();
+        for (auto v : waves.at(wave))
+        {
+          if (refills[v])
+            stow->graph[v].feature->fillInHistory(stow->shapeHistory);
+        }
+        historyTime += std::chrono::steady_clock::now() - fillStart;
+      }
+    }
+    catch (const std::exception &e)
+    {
+      std::cerr << "exception in model update worker: " << e.what() << std::endl;
+    }
+    updateJob->finish();
+    QMetaObject::invokeMethod(&loop, "quit", Qt::QueuedConnection);
+  });
+  
+  //stow needs to hear cancel and update requests while we wait.
+  block.clear();
+  
+  std::vector<bool> dones(jobs.size(), false);
+  std::size_t nextFlush = 0;
+  std::size_t skipCount = 0;
+  //worker is done with the feature. Back into the scene before its deferred messages.
+  auto finishJob = [&](Job &job)
+  {
+    ftr::Base *cFeature = stow->graph[job.vertex].feature.get();
+    cFeature->getMainSwitch()->setNodeMask(job.mainMask);
+    cFeature->getOverlaySwitch()->setNodeMask(job.overlayMask);
+    job.deferral.flush();
+    cFeature->serialWrite(stow->saveDirectory);
+    stow->gitManager.touchFeature(cFeature->getId());
+  };
+  auto flush = [&]()
+  {
+    auto flushBlock = stow->node.createBlocker();
+    for (const auto &progress : updateJob->take())
+    {
+      const ftr::Base *cFeature = stow->graph[jobs.at(progress.index).vertex].feature.get();
+      std::ostringstream messageStream;
+      if (progress.kind == UpdateJob::Progress::Kind::Started)
+      {
+        messageStream << "Updating: " << cFeature->getName().toStdString()
+        << "    Id: " << gu::idToShortString(cFeature->getId())
+        << "    " << progress.index + 1 << " of " << jobs.size();
+        stow->node.send(msg::buildStatusMessage(messageStream.str()));
+        continue;
+      }
+      dones.at(progress.index) = true;
+      if (progress.kind == UpdateJob::Progress::Kind::Skipped)
+      {
+        skipCount++;
+        continue;
+      }
+      FeatureTiming timing;
+      timing.featureId = cFeature->getId();
+      timing.wave = plan.getDepth(jobs.at(progress.index).vertex);
+      timing.modelMilliseconds = progress.milliseconds;
+      stow->timings.push_back(timing);
+      messageStream << "Updated: " << cFeature->getName().toStdString()
+      << "    Id: " << gu::idToShortString(cFeature->getId())
+      << "    " << std::fixed << std::setprecision(1) << progress.milliseconds << " ms";
+      stow->node.send(msg::buildStatusMessage(messageStream.str()));
+    }
+    //in job order, so the results are independent of thread timing.
+    while (nextFlush < jobs.size() && dones.at(nextFlush))
+    {
+      finishJob(jobs.at(nextFlush));
+      nextFlush++;
+    }
+  };
+  
+  QTimer timer;
+  timer.setInterval(50);
+  QObject::connect(&timer, &QTimer::timeout, flush);
+  timer.start();
+  InputFilter inputFilter;
+  qApp->installEventFilter(&inputFilter);
+  QApplication::setOverrideCursor(Qt::BusyCursor);
+  if (!updateJob->isFinished())
+    loop.exec();
+  QApplication::restoreOverrideCursor();
+  qApp->removeEventFilter(&inputFilter);
+  timer.stop();
+  if (!updateJob->isFinished())
+    updateJob->cancel(); //event loop was told to quit. application is closing.
+  worker.join();
+  
+  block = stow->node.createBlocker();
+  flush();
+  //the worker itself threw and jobs never posted finished. Flush what is left.
+  for (; nextFlush < jobs.size(); ++nextFlush)
+    finishJob(jobs.at(nextFlush));
+  stow->updateJob.reset();
+  Vertices pendingDirties;
+  std::swap(pendingDirties, stow->pendingDirties);
+  for (auto v : pendingDirties)
+    stow->dirtyDescendants(v);
+  
+  stow->historyStats.refilled = refillIds.size();
+  stow->historyStats.kept = plan.getOrder().size() - refillIds.size();
+  stow->historyStats.milliseconds = historyTime.count();
+  
   stow->updateLeafStatus();
   serialWrite();
   /* this is here to give others a chance to make changes before git makes a commit.
@@ -164,7 +514,15 @@ void Project::updateModel()
   
 //   stow->shapeHistory.writeGraphViz("/home/tanderson/.CadSeer/ShapeHistory.dot");
   
-  stow->node.send(msg::buildStatusMessage("Model Update Complete", 2.0));
+  if (updateJob->isCancelled())
+  {
+    std::ostringstream messageStream;
+    messageStream << "Model Update Cancelled. " << skipCount << " features skipped";
+    stow->node.send(msg::buildStatusMessage(messageStream.str(), 2.0));
+    stow->updatePending = false;
+  }
+  else
+    stow->node.send(msg::buildStatusMessage("Model Update Complete", 2.0));
 }
 
 void Project::updateVisual()
@@ -176,6 +534,11 @@ void Project::updateVisual()
   
   auto block = stow->node.createBlocker();
   
+  //visual times go with the model times of the same feature.
+  std::map<uuid, std::size_t> timingIndexes;
+  for (std::size_t index = 0; index < stow->timings.size(); ++index)
+    timingIndexes.insert(std::make_pair(stow->timings.at(index).featureId, index));
+  
   //don't think we need to topo sort for visual.
   for(auto its = boost::vertices(stow->graph); its.first != its.second; ++its.first)
   {
@@ -190,7 +553,22 @@ void Project::updateVisual()
 //       feature->isSuccess() && //regenerate from parent shape on failure.
       feature->isVisualDirty()
     )
+    {
+      auto visualStart = std::chrono::steady_clock::now();
       feature->updateVisual();
+      std::chrono::duration<double, std::milli> visualTime = std::chrono::steady_clock::now() - visualStart;
+      auto indexIt = timingIndexes.find(feature->getId());
+      if (indexIt == timingIndexes.end())
+      {
+        FeatureTiming timing;
+        timing.featureId = feature->getId();
+        if (stow->updatePlan.isValid())
+          timing.wave = stow->updatePlan.getDepth(*its.first);
+        indexIt = timingIndexes.insert(std::make_pair(timing.featureId, stow->timings.size())).first;
+        stow->timings.push_back(timing);
+      }
+      stow->timings.at(indexIt->second).visualMilliseconds = visualTime.count();
+    }
   }
   
   stow->node.send(msg::Message(msg::Response | msg::Post | msg::Project | msg::Update | msg::Visual));
@@ -198,6 +576,15 @@ void Project::updateVisual()
   stow->node.send(msg::buildStatusMessage("Visual Update Complete", 2.0));
 }
 
+/*! @brief Set maximum number of threads used by updateModel.
+ * 
+ * @param countIn is the thread count. 0 uses all cores. 1 is sequential.
+ */
+void Project::setUpdateThreadCount(std::size_t countIn)
+{
+  stow->updateThreadCount = countIn;
+}
+
 void Project::writeGraphViz(const std::string& fileName)
 {
   stow->writeGraphViz(fileName);
@@ -341,9 +728,8 @@ void Project::removeFeature(const uuid& idIn)
   auto removeFile = [&](Vertex vIn)
   {
     assert(exists(stow->saveDirectory));
-    path filePath = stow->saveDirectory / stow->graph[vIn].feature->getFileName();
-    if (exists(filePath))
-      remove(filePath);
+    stow->graph[vIn].feature->removeFiles(stow->saveDirectory);
+    stow->gitManager.touchFeature(stow->graph[vIn].feature->getId());
   };
   
   //bundle of calls for remove operation
@@ -573,6 +959,7 @@ void Project::removeParentTag(const uuid &targetIn, const std::string &tagIn)
     auto ce = boost::edge(*its.first, vertex, stow->graph);
     assert(ce.second);
     stow->graph[ce.first].inputType.remove(tagIn);
+    stow->updatePlan.invalidate();
     if (stow->graph[ce.first].inputType.isEmpty())
       stow->disconnect(ce.first);
   }
@@ -587,6 +974,55 @@ void Project::clearAllInputs(const boost::uuids::uuid &idIn)
   stow->removeEdges(inEdges);
 }
 
+void Project::setAllModelDirty()
+{
+  for (auto its = boost::vertices(stow->graph); its.first != its.second; ++its.first)
+  {
+    if (stow->graph[*its.first].alive)
+      stow->graph[*its.first].feature->setModelDirty();
+  }
+}
+
+const std::vector<FeatureTiming>& Project::getTimings() const
+{
+  return stow->timings;
+}
+
+/*! @brief Fully check the shapes of all successful features.
+ * 
+ * @return ids of features with an invalid shape.
+ * @details This is the validation pass for updates run with
+ * ftr::ShapeCheck::Mode::Deferred. Doesn't change feature state.
+ */
+std::vector<boost::uuids::uuid> Project::validateShapes() const
+{
+  std::vector<Vertex> vertices;
+  for (auto its = boost::vertices(stow->graph); its.first != its.second; ++its.first)
+  {
+    if (!stow->graph[*its.first].alive)
+      continue;
+    const ftr::Base *feature = stow->graph[*its.first].feature.get();
+    if (!feature->isSuccess() || !feature->hasAnnex(ann::Type::SeerShape))
+      continue;
+    if (feature->getAnnex<ann::SeerShape>().isNull())
+      continue;
+    vertices.push_back(*its.first);
+  }
+  
+  //ShapeCheck runs sub shapes in parallel, so features are checked in turn.
+  std::vector<boost::uuids::uuid> out;
+  for (auto v : vertices)
+  {
+    const ftr::Base *feature = stow->graph[v].feature.get();
+    ftr::ShapeCheck check(feature->getAnnex<ann::SeerShape>().getRootOCCTShape(), ftr::ShapeCheck::Mode::Full);
+    if (!check.isValid())
+      out.push_back(feature->getId());
+  }
+  ftr::ShapeCheck::clearCache();
+  
+  return out;
+}
+
 void Project::setAllVisualDirty()
 {
   for (auto its = boost::vertices(stow->graph); its.first != its.second; ++its.first)
@@ -656,6 +1092,7 @@ void Project::setColor(const boost::uuids::uuid &featureIdIn, const osg::Vec4 &c
     //object color. So here we just serialize the changed features to 'sneak' the
     //color change into the git commit.
     stow->graph[v].feature->serialWrite(stow->saveDirectory);
+    stow->gitManager.touchFeature(stow->graph[v].feature->getId());
     
     //log action to git.
     std::ostringstream gitMessage;
@@ -684,6 +1121,7 @@ std::vector<boost::uuids::uuid> Project::getAllFeatureIds() const
 void Project::setSaveDirectory(const boost::filesystem::path& directoryIn)
 {
   stow->saveDirectory = directoryIn;
+  stow->shapeStore.setDirectory(directoryIn);
 }
 
 const boost::filesystem::path& Project::getSaveDirectory() const
@@ -693,13 +1131,15 @@ const boost::filesystem::path& Project::getSaveDirectory() const
 
 void Project::serialWrite()
 {
-  //we accumulate all feature occt shapes into 1 master compound and write
-  //that to disk. We do this in an effort for occt to keep it's implicit
-  //sharing between saves and opens.
-  TopoDS_Compound compound;
-  std::size_t offset = 0;
-  BRep_Builder builder;
-  builder.MakeCompound(compound);
+  /* every feature shape goes to its own binary file in the shape store,
+   * named by content. Unchanged shapes aren't serialized again and
+   * identical files aren't rewritten, so git only sees shapes that changed.
+   * Shapes not read since open are still in their file and aren't touched.
+   * occt implicit sharing between features is lost on open, except between
+   * features with identical files. Shapes are only read when used, so
+   * features nobody looks at cost no shape memory.
+   */
+  std::vector<uuid> storedIds;
   
   srl::prjs::Project po
   (
@@ -716,7 +1156,17 @@ void Project::serialWrite()
     //save the state
     po.states().push_back(srl::prjs::FeatureState(gu::idToString(f->getId()), removedGraph[*its.first].state.to_string()));
     
-    //we can't add a null shape to the compound.
+    srl::prjs::Feature fo(gu::idToString(f->getId()), f->getTypeString(), srl::prjs::Feature::shapeOffset_default_value());
+    std::string shapeFile = stow->shapeStore.getFileName(f->getId());
+    if (f->hasAnnex(ann::Type::SeerShape) && f->getAnnex<ann::SeerShape>().isPending() && !shapeFile.empty())
+    {
+      fo.shapeFile(shapeFile);
+      po.features().push_back(fo);
+      storedIds.push_back(f->getId());
+      continue;
+    }
+    
+    //we can't write a null shape.
     //so we check for null and add 1 vertex as a place holder.
     TopoDS_Shape shapeOut;
     if (f->hasAnnex(ann::Type::SeerShape))
@@ -730,18 +1180,20 @@ void Project::serialWrite()
     if (shapeOut.IsNull())
       shapeOut = BRepBuilderAPI_MakeVertex(gp_Pnt(0.0, 0.0, 0.0)).Vertex();
     
-    po.features().push_back(srl::prjs::Feature(gu::idToString(f->getId()), f->getTypeString(), offset));
-    
-    //add to master compound
-    builder.Add(compound, shapeOut);
-    
-    offset++;
+    shapeFile = stow->shapeStore.write(f->getId(), shapeOut);
+    if (!shapeFile.empty())
+      fo.shapeFile(shapeFile);
+    po.features().push_back(fo);
+    storedIds.push_back(f->getId());
   }
+  stow->shapeStore.prune(storedIds);
   
-  //write out master compound
+  //projects before the shape store had all shapes in 1 compound.
   path cPath = stow->saveDirectory / "project.brep";
-  BRepTools::Clean(compound);
-  BRepTools::Write(compound, cPath.string().c_str());
+  if (exists(cPath))
+    remove(cPath);
+  stow->gitManager.touch("project.brep");
+  stow->gitManager.touch("shapes");
   
   for (auto its = boost::edges(removedGraph); its.first != its.second; ++its.first)
   {
@@ -759,10 +1211,12 @@ void Project::serialWrite()
   std::ofstream stream(pPath.string());
   xml_schema::NamespaceInfomap infoMap;
   srl::prjs::project(stream, po, infoMap);
+  stow->gitManager.touch("project.prjt");
 }
 
 void Project::save()
 {
+  stow->compact();
   stow->node.send(msg::Message(msg::Response | msg::Pre | msg::Save | msg::Project));
   
   stow->gitManager.save();
@@ -790,25 +1244,90 @@ void Project::open()
   
   try
   {
-    //read master shape.
-    TopoDS_Shape masterShape;
-    BRep_Builder junk;
-    std::fstream file(sPath.string());
-    BRepTools::Read(masterShape, file, junk);
-    
     auto project = srl::prjs::project(pPath.string(), ::xml_schema::Flags::dont_validate);
-    FeatureLoad fLoader(stow->saveDirectory, masterShape);
-    for (const auto &feature : project->features())
+    
+    /* feature shapes are read from the shape store the first time a feature
+     * uses its shape, see ann::SeerShape::setOCCTShape. Older projects have
+     * all shapes in 1 compound, which is read up front when needed.
+     */
+    occt::ShapeVector legacyShapes;
+    bool needLegacy = std::any_of
+    (
+      project->features().begin()
+      , project->features().end()
+      , [](const srl::prjs::Feature &fIn){return !fIn.shapeFile();}
+    );
+    if (needLegacy && exists(sPath))
     {
+      TopoDS_Shape masterShape;
+      BRep_Builder junk;
+      std::fstream file(sPath.string());
+      BRepTools::Read(masterShape, file, junk);
+      for (TopoDS_Iterator it(masterShape); it.More(); it.Next())
+        legacyShapes.push_back(it.Value());
+    }
+    
+    /* feature files are parsed on worker threads in batches.
+     * Between batches, the features are constructed, added to the graph in
+     * project order and their messages are sent, on this thread. Construction
+     * stays here because features share osg nodes, see lbr::Manager.
+     */
+    ::xsd::cxx::xml::auto_initializer xercesInitializer; //FeatureLoad doesn't initialize xerces.
+    FeatureLoad fLoader(stow->saveDirectory);
+    struct LoadJob
+    {
+      const srl::prjs::Feature *record = nullptr;
+      FeatureLoad::Build build;
+    };
+    const auto &records = project->features();
+    std::size_t threadCount = (stow->updateThreadCount == 0) ? tls::defaultThreadCount() : stow->updateThreadCount;
+    std::size_t batchSize = std::max(threadCount * 4, static_cast<std::size_t>(1));
+    for (std::size_t batchStart = 0; batchStart < records.size(); batchStart += batchSize)
+    {
+      std::vector<LoadJob> jobs(std::min(batchSize, records.size() - batchStart));
+      for (std::size_t index = 0; index < jobs.size(); ++index)
+        jobs.at(index).record = &records[batchStart + index];
+      
       std::ostringstream messageStream;
-      messageStream << "Loading: " << feature.type() << "    Id: " << feature.id();
+      messageStream << "Loading: features " << batchStart + 1 << " to " << batchStart + jobs.size() << " of " << records.size();
       stow->node.sendBlocked(msg::buildStatusMessage(messageStream.str()));
       qApp->processEvents(); //need this or we won't see messages.
       
-      std::unique_ptr<ftr::Base> featurePtr = fLoader.load(feature.id(), feature.type(), feature.shapeOffset());
-      if (featurePtr)
+      auto runJob = [&](std::size_t index)
       {
-        ftr::Base * f = addFeature(std::move(featurePtr));
+        LoadJob &job = jobs.at(index);
+        TopoDS_Shape legacyShape;
+        if (!job.record->shapeFile() && job.record->shapeOffset() < legacyShapes.size())
+          legacyShape = legacyShapes.at(job.record->shapeOffset());
+        boost::optional<std::string> shapeFile;
+        if (job.record->shapeFile())
+          shapeFile = job.record->shapeFile().get();
+        const ShapeStore *store = &stow->shapeStore;
+        auto reader = [store, shapeFile, legacyShape]() -> TopoDS_Shape
+        {
+          TopoDS_Shape shape = legacyShape;
+          if (shapeFile)
+            shape = store->read(shapeFile.get());
+          if (shape.IsNull())
+            shape = BRepBuilderAPI_MakeVertex(gp_Pnt(0.0, 0.0, 0.0)).Vertex();
+          return shape;
+        };
+        job.build = fLoader.load(job.record->id(), job.record->type(), reader);
+      };
+      tls::parallelFor(jobs.size(), runJob, threadCount);
+      
+      for (auto &job : jobs)
+      {
+        if (!job.build)
+          continue;
+        ftr::Base * f = addFeature(job.build());
+        if
+        (
+          job.record->shapeFile()
+          && f->hasAnnex(ann::Type::SeerShape)
+          && exists(stow->shapeStore.getDirectory() / job.record->shapeFile().get())
+        )
+          stow->shapeStore.remember(f->getId(), job.record->shapeFile().get());
         
         //send state message
         ftr::Message fMessage(f->getId(), f->getState(), ftr::StateOffset::Loading);
@@ -817,6 +1336,18 @@ void Project::open()
       }
     }
     
+    //visible features need their shapes for the first visual update. Read those now and in parallel.
+    std::vector<const ann::SeerShape*> visibleShapes;
+    for (auto v : boost::make_iterator_range(boost::vertices(stow->graph)))
+    {
+      const ftr::Base *f = stow->graph[v].feature.get();
+      if (f->isVisible3D() && f->hasAnnex(ann::Type::SeerShape) && f->getAnnex<ann::SeerShape>().isPending())
+        visibleShapes.push_back(&f->getAnnex<ann::SeerShape>());
+    }
+    stow->node.sendBlocked(msg::buildStatusMessage("Loading: Visible Shapes"));
+    qApp->processEvents();
+    tls::parallelFor(visibleShapes.size(), [&](std::size_t index){visibleShapes.at(index)->getRootOCCTShape();}, threadCount);
+    
     stow->node.sendBlocked(msg::buildStatusMessage("Loading: Project States"));
     qApp->processEvents();
     for (const auto &state : project->states())
@@ -892,10 +1423,15 @@ void Project::shapeTrackDump(const uuid &shapeId, const path &directory) const
 
 ftr::UpdatePayload::UpdateMap Project::getParentMap(const boost::uuids::uuid &idIn) const
 {
-  ftr::UpdatePayload::UpdateMap updateMap;
-  
   auto vertex = stow->findVertex(idIn);
   assert(vertex != NullVertex());
+  if (!stow->updateJob)
+  {
+    const UpdatePlan &plan = stow->getUpdatePlan();
+    if (plan.isValid())
+      return plan.getParentMap(vertex);
+  }
+  
   RemovedGraph removedGraph = buildRemovedGraph(stow->graph); //children
   ReversedGraph reversedGraph = boost::make_reverse_graph(removedGraph); //parents
   
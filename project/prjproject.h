@@ -46,6 +46,7 @@ namespace prj
 {
   class GitManager;
   class Stow;
+  struct FeatureTiming;
   
 class Project
 {
@@ -56,9 +57,15 @@ public:
     void addOCCShape(const TopoDS_Shape &shapeIn, std::string);
     prm::Parameter* findParameter(const boost::uuids::uuid &idIn) const;
     void updateModel();
+    bool isUpdating() const;
+    void cancelUpdate();
     void updateVisual();
+    void setUpdateThreadCount(std::size_t);
     void writeGraphViz(const std::string &fileName);
+    void setAllModelDirty();
     void setAllVisualDirty();
+    const std::vector<FeatureTiming>& getTimings() const;
+    std::vector<boost::uuids::uuid> validateShapes() const;
     void setColor(const boost::uuids::uuid&, const osg::Vec4&);
     std::vector<boost::uuids::uuid> getAllFeatureIds() const;
     
@@ -114,6 +121,7 @@ public:
     
 private:
     void serialWrite();
+    void updateModelPass();
     std::unique_ptr<Stow> stow; //think pimpl
 };
 }
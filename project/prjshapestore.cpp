@@ -0,0 +1,217 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+
+#include <boost/filesystem.hpp>
+
+#include <BinTools.hxx>
+#include <BRepTools.hxx>
+
+#include <git2.h>
+
+#include "project/prjshapestore.h"
+
+using namespace prj;
+namespace bfs = boost::filesystem;
+
+void ShapeStore::setDirectory(const bfs::path &projectDirectory)
+{
+  directory = projectDirectory / "shapes";
+  if (!bfs::exists(directory))
+    bfs::create_directories(directory);
+}
+
+std::string ShapeStore::write(const boost::uuids::uuid &featureId, const TopoDS_Shape &shape)
+{
+  auto it = entries.find(featureId);
+  if (it != entries.end())
+  {
+    if (it->second.shape.IsEqual(shape))
+      return it->second.fileName;
+    //remembered on open and the shape came from its file.
+    if (it->second.shape.IsNull())
+    {
+      std::lock_guard<std::mutex> lock(readMutex);
+      auto readIt = readShapes.find(it->second.fileName);
+      if (readIt != readShapes.end() && readIt->second.IsEqual(shape))
+      {
+        it->second.shape = shape;
+        return it->second.fileName;
+      }
+    }
+  }
+  
+  //triangulation isn't part of the model.
+  BRepTools::Clean(shape);
+  std::ostringstream shapeStream;
+  BinTools::Write(shape, shapeStream);
+  std::string shapeBytes = shapeStream.str();
+  serializeCount++;
+  
+  //same id git gives the file, so a name collision means a collision in git too.
+  git_oid oid;
+  if (git_odb_hash(&oid, shapeBytes.data(), shapeBytes.size(), GIT_OBJECT_BLOB) != 0)
+  {
+    std::cout << "ERROR: couldn't hash shape" << std::endl;
+    return std::string();
+  }
+  std::string fileName = std::string(git_oid_tostr_s(&oid)) + ".bin";
+  
+  //size check catches a file damaged outside of cadseer.
+  bfs::path filePath = directory / fileName;
+  boost::system::error_code sizeEc;
+  if (bfs::file_size(filePath, sizeEc) != shapeBytes.size() || sizeEc)
+  {
+    //write and rename, so a partial file never has a valid name.
+    bfs::path tempPath = directory / (fileName + ".tmp");
+    {
+      std::ofstream fileStream(tempPath.string(), std::ios::binary);
+      fileStream.write(shapeBytes.data(), shapeBytes.size());
+      if (!fileStream)
+      {
+        std::cout << "ERROR: couldn't write shape file: " << tempPath.string() << std::endl;
+        return std::string();
+      }
+    }
+    boost::system::error_code ec;
+    bfs::rename(tempPath, filePath, ec);
+    if (ec)
+    {
+      std::cout << "ERROR: couldn't rename shape file: " << ec.message() << std::endl;
+      return std::string();
+    }
+    fileWriteCount++;
+  }
+  
+  entries[featureId] = Entry{shape, fileName};
+  return fileName;
+}
+
+void ShapeStore::remember(const boost::uuids::uuid &featureId, const std::string &fileName)
+{
+  entries[featureId] = Entry{TopoDS_Shape(), fileName};
+}
+
+std::string ShapeStore::getFileName(const boost::uuids::uuid &featureId) const
+{
+  auto it = entries.find(featureId);
+  if (it == entries.end())
+    return std::string();
+  return it->second.fileName;
+}
+
+TopoDS_Shape ShapeStore::read(const std::string &fileName) const
+{
+  {
+    std::lock_guard<std::mutex> lock(readMutex);
+    auto it = readShapes.find(fileName);
+    if (it != readShapes.end())
+    {
+      sharedReadCount++;
+      return it->second;
+    }
+  }
+  
+  //read outside of the lock. Another thread might read the same file, first one in wins.
+  TopoDS_Shape out;
+  std::ifstream fileStream((directory / fileName).string(), std::ios::binary);
+  if (!fileStream.is_open() || !BinTools::Read(out, fileStream))
+  {
+    std::cout << "ERROR: couldn't read shape file: " << fileName << std::endl;
+    return TopoDS_Shape();
+  }
+  
+  std::lock_guard<std::mutex> lock(readMutex);
+  fileReadCount++;
+  return readShapes.insert(std::make_pair(fileName, out)).first->second;
+}
+
+std::size_t ShapeStore::getFileReadCount() const
+{
+  std::lock_guard<std::mutex> lock(readMutex);
+  return fileReadCount;
+}
+
+std::size_t ShapeStore::getSharedReadCount() const
+{
+  std::lock_guard<std::mutex> lock(readMutex);
+  return sharedReadCount;
+}
+
+//! names write gives files, and its temporaries. Nothing else in the directory is ours.
+static bool isStoreFile(const std::string &name)
+{
+  std::size_t hexLength = GIT_OID_HEXSZ;
+  if (name.size() < hexLength + 4)
+    return false;
+  for (std::size_t index = 0; index < hexLength; ++index)
+  {
+    char c = name[index];
+    if (!((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f')))
+      return false;
+  }
+  std::string suffix = name.substr(hexLength);
+  return suffix == ".bin" || suffix == ".bin.tmp";
+}
+
+void ShapeStore::prune(const std::vector<boost::uuids::uuid> &featureIds)
+{
+  std::set<boost::uuids::uuid> keep(featureIds.begin(), featureIds.end());
+  std::set<std::string> referenced;
+  for (auto it = entries.begin(); it != entries.end();)
+  {
+    if (keep.count(it->first) == 0)
+    {
+      it = entries.erase(it);
+      continue;
+    }
+    referenced.insert(it->second.fileName);
+    ++it;
+  }
+  
+  {
+    std::lock_guard<std::mutex> lock(readMutex);
+    for (auto it = readShapes.begin(); it != readShapes.end();)
+    {
+      if (referenced.count(it->first) == 0)
+        it = readShapes.erase(it);
+      else
+        ++it;
+    }
+  }
+  
+  if (!bfs::exists(directory))
+    return;
+  std::vector<bfs::path> doomed;
+  for (const auto &entry : bfs::directory_iterator(directory))
+  {
+    std::string name = entry.path().filename().string();
+    if (isStoreFile(name) && referenced.count(name) == 0)
+      doomed.push_back(entry.path());
+  }
+  for (const auto &path : doomed)
+  {
+    boost::system::error_code ec;
+    bfs::remove(path, ec);
+  }
+}
@@ -0,0 +1,88 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRJ_SHAPESTORE_H
+#define PRJ_SHAPESTORE_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/uuid/uuid.hpp>
+
+#include <TopoDS_Shape.hxx>
+
+namespace prj
+{
+  /*! @class ShapeStore
+   * @brief Content addressed files of feature shapes.
+   * 
+   * @details Each feature root shape is written in BinTools format
+   * to the 'shapes' sub directory of the project. Files are named
+   * by the git blob id of their bytes, so a file is only written when no
+   * identical shape has been written before. The last shape written
+   * for each feature is remembered and an unchanged shape isn't
+   * serialized again. prune removes store files nobody references. git
+   * keeps older files for older commits.
+   * 
+   * Files are read when a feature first uses its shape, see
+   * ann::SeerShape::setOCCTShape. Shapes read are kept by file name,
+   * so features with identical files share one occt shape.
+   */
+  class ShapeStore
+  {
+  public:
+    void setDirectory(const boost::filesystem::path &projectDirectory);
+    const boost::filesystem::path& getDirectory() const {return directory;}
+    
+    //! returns file name inside the store directory. empty on failure.
+    std::string write(const boost::uuids::uuid&, const TopoDS_Shape&);
+    //! feature file is current. Used after open to avoid rewriting.
+    void remember(const boost::uuids::uuid&, const std::string&);
+    //! file last written or remembered for feature. empty if none.
+    std::string getFileName(const boost::uuids::uuid&) const;
+    //! null shape on failure. thread safe.
+    TopoDS_Shape read(const std::string &fileName) const;
+    //! forget features not in list and remove files they alone referenced.
+    void prune(const std::vector<boost::uuids::uuid>&);
+    
+    std::size_t getSerializeCount() const {return serializeCount;}
+    std::size_t getFileWriteCount() const {return fileWriteCount;}
+    std::size_t getFileReadCount() const; //!< files read from disk.
+    std::size_t getSharedReadCount() const; //!< reads answered with a shape already read.
+  private:
+    struct Entry
+    {
+      TopoDS_Shape shape; //!< null when remembered and not written since.
+      std::string fileName;
+    };
+    boost::filesystem::path directory;
+    std::map<boost::uuids::uuid, Entry> entries;
+    std::size_t serializeCount = 0; //!< shapes converted to bytes.
+    std::size_t fileWriteCount = 0; //!< files created.
+    mutable std::mutex readMutex; //!< guards members below.
+    mutable std::map<std::string, TopoDS_Shape> readShapes; //!< file name to shape read from it.
+    mutable std::size_t fileReadCount = 0;
+    mutable std::size_t sharedReadCount = 0;
+  };
+}
+
+#endif // PRJ_SHAPESTORE_H
@@ -17,13 +17,19 @@
  *
  */
 
+#include <chrono>
+#include <fstream>
+
 #include <boost/signals2/shared_connection_block.hpp>
 #include <boost/filesystem.hpp>
 #include <boost/graph/topological_sort.hpp>
 
 #include <osg/Node> //yuck
 
+#include <QApplication>
 #include <QDesktopServices>
+#include <QThread>
+#include <QTimer>
 #include <QUrl>
 
 #include "application/appapplication.h"
@@ -50,6 +56,21 @@ Stow::Stow(Project &pIn)
   sift.name = "prj::Project";
   node.setHandler(std::bind(&msg::Sift::receive, &sift, std::placeholders::_1));
   setupDispatcher();
+  
+  compactTimer = std::make_unique<QTimer>();
+  compactTimer->setSingleShot(true);
+  compactTimer->setInterval(2000);
+  QObject::connect(compactTimer.get(), &QTimer::timeout, [this]()
+  {
+    if (!compactScheduled)
+      return;
+    if (!canCompact())
+    {
+      compactTimer->start(); //try again later.
+      return;
+    }
+    compact();
+  });
 }
 
 Stow::~Stow() = default;
@@ -57,10 +78,29 @@ Stow::~Stow() = default;
 Vertex Stow::addFeature(std::unique_ptr<ftr::Base> feature)
 {
   Vertex newVertex = boost::add_vertex(graph);
+  featureIndex[feature->getId()] = newVertex;
   graph[newVertex].feature = std::move(feature);
+  indexParameters(newVertex);
+  updatePlan.invalidate();
   return newVertex;
 }
 
+void Stow::indexParameters(Vertex vIn)
+{
+  for (const auto *p : graph[vIn].feature->getParameters())
+    parameterIndex[p->getId()] = vIn;
+}
+
+void Stow::unindexParameters(Vertex vIn)
+{
+  for (const auto *p : graph[vIn].feature->getParameters())
+  {
+    auto it = parameterIndex.find(p->getId());
+    if (it != parameterIndex.end() && it->second == vIn)
+      parameterIndex.erase(it);
+  }
+}
+
 void Stow::removeFeature(Vertex remove)
 {
   prj::Message pMessage;
@@ -75,6 +115,102 @@ void Stow::removeFeature(Vertex remove)
   //edges should already be cleared with appropriate messages. Just in case.
   boost::clear_vertex(remove, graph);
   graph[remove].alive = false;
+  featureIndex.erase(graph[remove].feature->getId());
+  unindexParameters(remove);
+  updatePlan.invalidate();
+  shapeHistory.removeFeatures({graph[remove].feature->getId()});
+  scheduleCompact();
+}
+
+/*! @brief Remove dead vertices from the graph.
+ * 
+ * @return number of vertices removed.
+ * @details Vertices are renumbered, so every Vertex and Edge held
+ * anywhere is invalid afterward. Only call with none on the stack:
+ * on save or from the idle timer, see canCompact. Everything outside
+ * of the project refers to features by id, which is unaffected. Dead
+ * features are moved to the graveyard, so feature pointers handed out
+ * earlier stay valid. Does nothing while a model update is running.
+ */
+std::size_t Stow::compact()
+{
+  if (updateJob)
+    return 0;
+  compactScheduled = false;
+  
+  std::size_t removed = 0;
+  for (auto v : boost::make_iterator_range(boost::vertices(graph)))
+  {
+    if (!graph[v].alive)
+      removed++;
+  }
+  if (removed == 0)
+    return 0;
+  
+  std::vector<Vertex> oldToNew(boost::num_vertices(graph), NullVertex());
+  Graph fresh;
+  for (auto v : boost::make_iterator_range(boost::vertices(graph)))
+  {
+    if (!graph[v].alive)
+    {
+      graveyard.push_back(std::move(graph[v].feature));
+      continue;
+    }
+    Vertex nv = boost::add_vertex(fresh);
+    fresh[nv].feature = std::move(graph[v].feature);
+    fresh[nv].state = graph[v].state;
+    oldToNew[v] = nv;
+  }
+  
+  //per source vertex keeps the out edge order of each feature.
+  for (auto v : boost::make_iterator_range(boost::vertices(graph)))
+  {
+    for (auto e : boost::make_iterator_range(boost::out_edges(v, graph)))
+    {
+      Vertex target = boost::target(e, graph);
+      if (oldToNew[v] == NullVertex() || oldToNew[target] == NullVertex())
+        continue;
+      boost::add_edge(oldToNew[v], oldToNew[target], graph[e], fresh);
+    }
+  }
+  
+  graph.swap(fresh);
+  
+  featureIndex.clear();
+  parameterIndex.clear();
+  for (auto v : boost::make_iterator_range(boost::vertices(graph)))
+  {
+    featureIndex[graph[v].feature->getId()] = v;
+    indexParameters(v);
+  }
+  updatePlan.invalidate();
+  
+  compactStats.runs++;
+  compactStats.removed += removed;
+  return removed;
+}
+
+//! compact on save or once the application has been idle for a while.
+void Stow::scheduleCompact()
+{
+  compactScheduled = true;
+  compactTimer->start();
+}
+
+/*! @brief Check nothing up stack can hold a Vertex or Edge.
+ * 
+ * @details Timers also fire from processEvents and nested event loops.
+ * Commands, model updates, project loading and modal dialogs all run those.
+ */
+bool Stow::canCompact() const
+{
+  return
+    !updateJob
+    && !isLoading
+    && !commandActive
+    && !QApplication::activeModalWidget()
+    && !QApplication::activePopupWidget()
+    && QThread::currentThread()->loopLevel() <= 1;
 }
 
 Edge Stow::connect(const Vertex &parentIn, const Vertex &childIn, const ftr::InputType &type)
@@ -94,6 +230,7 @@ Edge Stow::connect(const Vertex &parentIn, const Vertex &childIn, const ftr::Inp
     return newEdge;
   }
   graph[newEdge].inputType += type;
+  updatePlan.invalidate();
   sendConnectMessage(parentIn, childIn, type);
   return newEdge;
 }
@@ -127,6 +264,7 @@ void Stow::disconnect(const Edge &eIn)
 {
   sendDisconnectMessage(boost::source(eIn, graph), boost::target(eIn, graph), graph[eIn].inputType);
   boost::remove_edge(eIn, graph);
+  updatePlan.invalidate();
 }
 
 void Stow::sendDisconnectMessage(const Vertex &parentIn, const Vertex &childIn, const ftr::InputType &type) const
@@ -164,13 +302,11 @@ ftr::Base* Stow::findFeature(const boost::uuids::uuid &idIn) const
 
 Vertex Stow::findVertex(const boost::uuids::uuid &idIn) const
 {
-  for (auto its = boost::vertices(graph); its.first != its.second; ++its.first)
+  auto it = featureIndex.find(idIn);
+  if (it != featureIndex.end())
   {
-    if (graph[*its.first].feature->getId() == idIn)
-    {
-      assert(graph[*its.first].alive);
-      return *its.first;
-    }
+    assert(graph[it->second].alive);
+    return it->second;
   }
   assert(0); //no vertex with id in prj::Stow::findVertex
   std::cout << "warning: no vertex with id in prj::Stow::findVertex" << std::endl;
@@ -192,10 +328,16 @@ std::vector<boost::uuids::uuid> Stow::getAllFeatureIds() const
 
 prm::Parameter* Stow::findParameter(const boost::uuids::uuid &idIn) const
 {
+  auto it = parameterIndex.find(idIn);
+  if (it != parameterIndex.end() && graph[it->second].alive && graph[it->second].feature->hasParameter(idIn))
+    return graph[it->second].feature->getParameter(idIn);
+  
+  //features can add parameters after they are added to the project. scan and remember.
   for (auto its = boost::vertices(graph); its.first != its.second; ++its.first)
   {
-    if (!graph[*its.first].feature->hasParameter(idIn))
+    if (!graph[*its.first].alive || !graph[*its.first].feature->hasParameter(idIn))
       continue;
+    parameterIndex[idIn] = *its.first;
     return graph[*its.first].feature->getParameter(idIn);
   }
 
@@ -282,6 +424,21 @@ void Stow::setupDispatcher()
         , std::bind(&Stow::forceUpdateDispatched, this, std::placeholders::_1)
       )
       , std::make_pair
+      (
+        msg::Request | msg::Project | msg::Validate
+        , std::bind(&Stow::validateShapesDispatched, this, std::placeholders::_1)
+      )
+      , std::make_pair
+      (
+        msg::Response | msg::Command | msg::Active
+        , std::bind(&Stow::commandActiveDispatched, this, std::placeholders::_1)
+      )
+      , std::make_pair
+      (
+        msg::Response | msg::Command | msg::Inactive
+        , std::bind(&Stow::commandInactiveDispatched, this, std::placeholders::_1)
+      )
+      , std::make_pair
       (
         msg::Request | msg::Project | msg::Update | msg::Model
         , std::bind(&Stow::updateModelDispatched, this, std::placeholders::_1)
@@ -331,12 +488,33 @@ void Stow::setupDispatcher()
         msg::Request | msg::Project | msg::Feature | msg::Dissolve
         , std::bind(&Stow::dissolveFeatureDispatched, this, std::placeholders::_1)
       )
+      , std::make_pair
+      (
+        msg::Request | msg::Project | msg::Update | msg::Cancel
+        , std::bind(&Stow::cancelUpdateDispatched, this, std::placeholders::_1)
+      )
     }
   );
 }
 
+/*! @brief Refuse project edits while a model update is running.
+ * 
+ * @details The model update runs on a worker and the event loop keeps
+ * running, so requests can arrive while features are being updated.
+ * @return true if the request should be ignored.
+ */
+bool Stow::rejectWhileUpdating()
+{
+  if (!updateJob)
+    return false;
+  node.send(msg::buildStatusMessage(QObject::tr("Model update running. Escape in viewer cancels").toStdString(), 2.0));
+  return true;
+}
+
 void Stow::setCurrentLeafDispatched(const msg::Message &messageIn)
 {
+  if (rejectWhileUpdating())
+    return;
   prj::Message message = messageIn.getPRJ();
   //send response signal out 'pre set current feature'.
   assert(message.featureIds.size() == 1);
@@ -346,6 +524,8 @@ void Stow::setCurrentLeafDispatched(const msg::Message &messageIn)
 
 void Stow::removeFeatureDispatched(const msg::Message &messageIn)
 {
+  if (rejectWhileUpdating())
+    return;
   prj::Message message = messageIn.getPRJ();
   assert(message.featureIds.size() == 1);
   project.removeFeature(message.featureIds.front());
@@ -353,6 +533,12 @@ void Stow::removeFeatureDispatched(const msg::Message &messageIn)
 
 void Stow::updateDispatched(const msg::Message&)
 {
+  if (updateJob)
+  {
+    updatePending = true; //running update will go again.
+    return;
+  }
+  
   app::WaitCursor waitCursor;
   project.updateModel();
   project.updateVisual();
@@ -362,6 +548,9 @@ void Stow::updateDispatched(const msg::Message&)
 
 void Stow::forceUpdateDispatched(const msg::Message&)
 {
+  if (rejectWhileUpdating())
+    return;
+  
   RemovedGraph rg = buildRemovedGraph(graph);
   for (auto its = boost::vertices(rg); its.first != its.second; ++its.first)
     rg[*its.first].feature->setModelDirty();
@@ -373,6 +562,35 @@ void Stow::forceUpdateDispatched(const msg::Message&)
   node.sendBlocked(msg::buildStatusMessage(std::string()));
 }
 
+//! full shape checks for when updates only ran the cheap ones. see ftr::ShapeCheck.
+void Stow::validateShapesDispatched(const msg::Message&)
+{
+  if (rejectWhileUpdating())
+    return;
+  
+  std::vector<boost::uuids::uuid> invalids;
+  {
+    app::WaitCursor waitCursor;
+    invalids = project.validateShapes();
+  }
+  
+  if (invalids.empty())
+  {
+    node.sendBlocked(msg::buildStatusMessage(QObject::tr("All shapes are valid").toStdString(), 2.0));
+    return;
+  }
+  
+  QString names;
+  for (const auto &id : invalids)
+  {
+    if (!names.isEmpty())
+      names += ", ";
+    names += findFeature(id)->getName();
+  }
+  QString message = QObject::tr("Invalid shapes: ") + names;
+  node.sendBlocked(msg::buildStatusMessage(message.toStdString(), 5.0));
+}
+
 void Stow::updateModelDispatched(const msg::Message&)
 {
   project.updateModel();
@@ -380,11 +598,15 @@ void Stow::updateModelDispatched(const msg::Message&)
 
 void Stow::updateVisualDispatched(const msg::Message&)
 {
+  if (updateJob)
+    return; //features are changing. visuals are updated after.
   project.updateVisual();
 }
 
 void Stow::saveProjectRequestDispatched(const msg::Message&)
 {
+  if (rejectWhileUpdating())
+    return;
   project.save();
 }
 
@@ -463,11 +685,23 @@ void Stow::featureStateChangedDispatched(const msg::Message &messageIn)
   if ((co == ftr::StateOffset::ModelDirty) && (!fMessage.state.test(ftr::StateOffset::ModelDirty)))
     return;
   
+  //the worker may be updating the descendants. project dirties them after the pass.
+  if (updateJob)
+  {
+    pendingDirties.push_back(findVertex(fMessage.featureId));
+    return;
+  }
+  
   //this code blocks all incoming messages to the project while it
   //executes. This prevents the cycles from setting a dependent fetures dirty.
   auto block = node.createBlocker();
   
-  Vertex vertex = findVertex(fMessage.featureId);
+  dirtyDescendants(findVertex(fMessage.featureId));
+}
+
+//! @brief Set all features downstream of vertex dirty. Block incoming messages first.
+void Stow::dirtyDescendants(Vertex vertex)
+{
   Vertices vertices;
   gu::BFSLimitVisitor<Vertex> visitor(vertices);
   boost::breadth_first_search(graph, vertex, boost::visitor(visitor));
@@ -478,6 +712,16 @@ void Stow::featureStateChangedDispatched(const msg::Message &messageIn)
     graph[v].feature->setModelDirty();
 }
 
+void Stow::commandActiveDispatched(const msg::Message&)
+{
+  commandActive = true;
+}
+
+void Stow::commandInactiveDispatched(const msg::Message&)
+{
+  commandActive = false;
+}
+
 void Stow::dumpProjectGraphDispatched(const msg::Message &)
 {
   //   indexVerticesEdges();
@@ -485,11 +729,19 @@ void Stow::dumpProjectGraphDispatched(const msg::Message &)
   path filePath = app::instance()->getApplicationDirectory() / "project.dot";
   writeGraphViz(filePath.string());
   
+  if (!updateJob)
+  {
+    std::ofstream planStream((app::instance()->getApplicationDirectory() / "updateplan.txt").string());
+    getUpdatePlan().dump(planStream, graph);
+  }
+  
   QDesktopServices::openUrl(QUrl(QString::fromStdString(filePath.string())));
 }
 
 void Stow::shownThreeDDispatched(const msg::Message &mIn)
 {
+  if (updateJob)
+    return; //visual stays dirty and is updated with the next visual update.
   uuid id = mIn.getVWR().featureId;
   auto feature = findFeature(id);
   if
@@ -504,6 +756,8 @@ void Stow::shownThreeDDispatched(const msg::Message &mIn)
 
 void Stow::reorderFeatureDispatched(const msg::Message &mIn)
 {
+  if (rejectWhileUpdating())
+    return;
   const prj::Message &pm = mIn.getPRJ();
   Vertices fvs; //feature vertices.
   for (const auto &id : pm.featureIds)
@@ -634,6 +888,9 @@ void Stow::reorderFeatureDispatched(const msg::Message &mIn)
 
 void Stow::toggleSkippedDispatched(const msg::Message &mIn)
 {
+  if (rejectWhileUpdating())
+    return;
+  
   //log action to git.
   std::ostringstream gitMessage;
   gitMessage << QObject::tr("Toggling skip status for: ").toStdString();
@@ -653,6 +910,8 @@ void Stow::toggleSkippedDispatched(const msg::Message &mIn)
 
 void Stow::dissolveFeatureDispatched(const msg::Message &mIn)
 {
+  if (rejectWhileUpdating())
+    return;
   const prj::Message &pm = mIn.getPRJ();
   assert(pm.featureIds.size() == 1);
   assert(hasFeature(pm.featureIds.front()));
@@ -766,9 +1025,11 @@ void Stow::dissolveFeatureDispatched(const msg::Message &mIn)
   removeEdges(etr);
   
   //now finally remove the actual vertices.
+  std::vector<uuid> removedIds;
   for (const auto &v : vertsToRemove)
   {
     assert (boost::degree(v, graph) == 0);
+    removedIds.push_back(graph[v].feature->getId());
     
     prj::Message pMessage;
     pMessage.feature = graph[v].feature.get();
@@ -781,13 +1042,19 @@ void Stow::dissolveFeatureDispatched(const msg::Message &mIn)
     
     //remove file if exists.
     assert(boost::filesystem::exists(saveDirectory));
-    path filePath = saveDirectory / fb->getFileName();
-    if (boost::filesystem::exists(filePath))
-      boost::filesystem::remove(filePath);
+    fb->removeFiles(saveDirectory);
+    gitManager.touchFeature(fb->getId());
     
     boost::clear_vertex(v, graph); //should be redundent.
     graph[v].alive = false;
+    featureIndex.erase(graph[v].feature->getId());
+    unindexParameters(v);
+    updatePlan.invalidate();
+    scheduleCompact();
   }
+  //the inert feature reuses the shape ids. The history has to forget the
+  //dissolved features, or the inert feature's fill skips those shapes.
+  shapeHistory.removeFeatures(removedIds);
   
   node.send
   (
@@ -850,6 +1117,13 @@ void Stow::updateLeafStatus()
   }
 }
 
+const UpdatePlan& Stow::getUpdatePlan()
+{
+  if (!updatePlan.isValid() && !updatePlan.build(graph))
+    std::cout << std::endl << "Graph is not a dag exception in " << BOOST_CURRENT_FUNCTION << std::endl << std::endl;
+  return updatePlan;
+}
+
 void Stow::buildShapeHistory()
 {
   //used for loading so don't worry about 'dead' vertices
@@ -865,6 +1139,15 @@ void Stow::buildShapeHistory()
     return;
   }
   
+  auto start = std::chrono::steady_clock::now();
   for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
     graph[*it].feature->fillInHistory(shapeHistory);
+  historyStats.refilled = sorted.size();
+  historyStats.kept = 0;
+  historyStats.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Stow::cancelUpdateDispatched(const msg::Message&)
+{
+  project.cancelUpdate();
 }
@@ -22,16 +22,23 @@
 
 #include <memory>
 #include <vector>
+#include <unordered_map>
 
 #include <boost/filesystem/path.hpp>
+#include <boost/functional/hash.hpp>
 
 #include "message/msgnode.h"
 #include "message/msgsift.h"
 #include "expressions/exprmanager.h"
 #include "project/prjgitmanager.h"
 #include "project/prjgraph.h"
+#include "project/prjupdateplan.h"
+#include "project/prjupdatejob.h"
+#include "project/prjshapestore.h"
 #include "feature/ftrshapehistory.h"
 
+class QTimer;
+
 namespace prm{class Parameter;}
 namespace ftr{class Base;}
 
@@ -62,7 +69,12 @@ namespace prj
     
     void writeGraphViz(const std::string &fileName);
     void updateLeafStatus();
+    void dirtyDescendants(Vertex);
     void buildShapeHistory();
+    std::size_t compact();
+    void scheduleCompact();
+    bool canCompact() const;
+    const UpdatePlan& getUpdatePlan(); //!< builds plan if needed. check isValid.
     
     void setFeatureActive(Vertex);
     void setFeatureInactive(Vertex);
@@ -78,6 +90,7 @@ namespace prj
     void removeFeatureDispatched(const msg::Message &);
     void updateDispatched(const msg::Message &);
     void forceUpdateDispatched(const msg::Message &);
+    void validateShapesDispatched(const msg::Message &);
     void updateModelDispatched(const msg::Message &);
     void updateVisualDispatched(const msg::Message &);
     void saveProjectRequestDispatched(const msg::Message &);
@@ -88,6 +101,10 @@ namespace prj
     void reorderFeatureDispatched(const msg::Message&);
     void toggleSkippedDispatched(const msg::Message&);
     void dissolveFeatureDispatched(const msg::Message&);
+    void cancelUpdateDispatched(const msg::Message&);
+    void commandActiveDispatched(const msg::Message&);
+    void commandInactiveDispatched(const msg::Message&);
+    bool rejectWhileUpdating();
     
     Project &project;
     Graph graph;
@@ -96,10 +113,39 @@ namespace prj
     expr::Manager expressionManager;
     GitManager gitManager;
     ftr::ShapeHistory shapeHistory;
+    UpdatePlan updatePlan; //!< invalidate on any topology change.
+    ShapeStore shapeStore;
     boost::filesystem::path saveDirectory;
     bool isLoading = false;
+    std::size_t updateThreadCount = 0; //!< max threads for model update. 0 = all cores.
+    struct HistoryStats
+    {
+      std::size_t refilled = 0; //!< features filled into shape history.
+      std::size_t kept = 0; //!< alive features left alone.
+      double milliseconds = 0.0; //!< time spent removing and filling.
+    };
+    HistoryStats historyStats; //!< from the last model update or build.
+    std::shared_ptr<UpdateJob> updateJob; //!< only valid while a model update is running.
+    bool updatePending = false; //!< model update was requested while one was running.
+    Vertices pendingDirties; //!< dirty or skipped while a model update ran. descendants dirtied after the pass.
+    std::vector<FeatureTiming> timings; //!< features updated since the last updateModel call.
+    struct CompactStats
+    {
+      std::size_t runs = 0; //!< compactions that removed something.
+      std::size_t removed = 0; //!< dead vertices removed over all runs.
+    };
+    CompactStats compactStats;
+    bool compactScheduled = false; //!< dead vertices are waiting on save or the idle timer.
+    std::unique_ptr<QTimer> compactTimer; //!< single shot. restarted by scheduleCompact.
+    bool commandActive = false; //!< command manager has a command on its stack.
+    std::vector<std::unique_ptr<ftr::Base>> graveyard; //!< features compacted out of the graph. pointers to them stay valid.
   private:
     void sendStateMessage(const Vertex&, std::size_t);
+    void indexParameters(Vertex);
+    void unindexParameters(Vertex);
+    typedef std::unordered_map<uuid, Vertex, boost::hash<uuid>> IdIndex;
+    IdIndex featureIndex; //!< alive vertices only. rebuilt by compact.
+    mutable IdIndex parameterIndex; //!< parameter to owning feature. a hint, verified on use.
   };
 }
 
@@ -0,0 +1,56 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "project/prjupdatejob.h"
+
+using namespace prj;
+
+void UpdateJob::cancel()
+{
+  cancelled = true;
+}
+
+bool UpdateJob::isCancelled() const
+{
+  return cancelled;
+}
+
+void UpdateJob::post(const Progress &progressIn)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  progress.push_back(progressIn);
+}
+
+std::vector<UpdateJob::Progress> UpdateJob::take()
+{
+  std::vector<Progress> out;
+  std::lock_guard<std::mutex> lock(mutex);
+  out.swap(progress);
+  return out;
+}
+
+void UpdateJob::finish()
+{
+  finished = true;
+}
+
+bool UpdateJob::isFinished() const
+{
+  return finished;
+}
@@ -0,0 +1,80 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRJ_UPDATEJOB_H
+#define PRJ_UPDATEJOB_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+#include <boost/uuid/uuid.hpp>
+
+namespace prj
+{
+  //! time spent updating one feature. @see Project::getTimings
+  struct FeatureTiming
+  {
+    boost::uuids::uuid featureId;
+    std::size_t wave = 0; //!< update wave. @see UpdatePlan
+    double modelMilliseconds = 0.0; //!< 0 when model wasn't updated.
+    double visualMilliseconds = 0.0; //!< 0 when visual wasn't updated.
+  };
+  
+  /*! @class UpdateJob
+   * @brief State shared between the gui thread and a model update worker.
+   * 
+   * @details The worker posts progress as features start and finish.
+   * The gui thread takes the posted progress to send status messages and
+   * to flush feature messages in order. Cancel is checked before each
+   * feature update. Features that haven't started when cancelled are
+   * skipped and stay dirty.
+   */
+  class UpdateJob
+  {
+  public:
+    struct Progress
+    {
+      enum class Kind
+      {
+        Started
+        , Finished
+        , Skipped
+      };
+      Kind kind;
+      std::size_t index; //!< feature offset in update order.
+      double milliseconds; //!< time spent in feature update. Finished only.
+    };
+    
+    void cancel(); //!< any thread.
+    bool isCancelled() const; //!< any thread.
+    void post(const Progress&); //!< worker threads.
+    std::vector<Progress> take(); //!< gui thread. returns and clears posted progress.
+    void finish(); //!< worker. called last.
+    bool isFinished() const; //!< any thread.
+    
+  private:
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> finished{false};
+    std::mutex mutex;
+    std::vector<Progress> progress;
+  };
+}
+
+#endif // PRJ_UPDATEJOB_H
@@ -0,0 +1,103 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <ostream>
+
+#include <boost/graph/topological_sort.hpp>
+
+#include "tools/idtools.h"
+#include "feature/ftrbase.h"
+#include "project/prjupdateplan.h"
+
+using namespace prj;
+
+bool UpdatePlan::build(Graph &graph)
+{
+  valid = false;
+  buildCount++;
+  
+  Vertices sorted;
+  try
+  {
+    boost::topological_sort(graph, std::back_inserter(sorted));
+  }
+  catch(const boost::not_a_dag &)
+  {
+    return false;
+  }
+  
+  RemovedGraph removedGraph = buildRemovedGraph(graph);
+  ReversedGraph reversedGraph = boost::make_reverse_graph(removedGraph);
+  
+  std::size_t count = boost::num_vertices(graph);
+  order.clear();
+  waves.clear();
+  depths.assign(count, 0);
+  parents.assign(count, Vertices());
+  parentMaps.assign(count, ftr::UpdatePayload::UpdateMap());
+  
+  for (auto it = sorted.rbegin(); it != sorted.rend(); ++it)
+  {
+    if (!graph[*it].alive)
+      continue;
+    order.push_back(*it);
+    
+    std::size_t depth = 0;
+    for (auto p : boost::make_iterator_range(boost::adjacent_vertices(*it, reversedGraph)))
+    {
+      depth = std::max(depth, depths[p] + 1);
+      parents[*it].push_back(p);
+    }
+    depths[*it] = depth;
+    if (depth >= waves.size())
+      waves.resize(depth + 1);
+    waves[depth].push_back(*it);
+    
+    parentMaps[*it] = buildAjacentUpdateMap
+    <
+      ReversedGraph,
+      boost::graph_traits<ReversedGraph>::vertex_descriptor
+    >(reversedGraph, *it);
+  }
+  
+  valid = true;
+  return true;
+}
+
+std::ostream& UpdatePlan::dump(std::ostream &stream, const Graph &graph) const
+{
+  if (!valid)
+    return stream << "update plan is not valid" << std::endl;
+  
+  stream << "update plan: " << order.size() << " features in " << waves.size() << " waves. built " << buildCount << " times" << std::endl;
+  for (std::size_t index = 0; index < waves.size(); ++index)
+  {
+    stream << "wave " << index << ":" << std::endl;
+    for (auto v : waves.at(index))
+    {
+      stream << "    " << graph[v].feature->getName().toStdString()
+      << "    " << gu::idToShortString(graph[v].feature->getId())
+      << "    parents:";
+      for (auto p : parents.at(v))
+        stream << " " << gu::idToShortString(graph[p].feature->getId());
+      stream << std::endl;
+    }
+  }
+  return stream;
+}
@@ -0,0 +1,70 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PRJ_UPDATEPLAN_H
+#define PRJ_UPDATEPLAN_H
+
+#include <iosfwd>
+#include <vector>
+
+#include "project/prjgraph.h"
+
+namespace prj
+{
+  /*! @class UpdatePlan
+   * @brief Graph topology derived data for model updates.
+   * 
+   * @details Holds the update order, the waves of independent
+   * features and the parent map of every alive feature. These only
+   * depend on the topology of the project graph, so the plan is
+   * built once and kept until the owner invalidates it. Stow invalidates
+   * it for every feature add and remove, connection and disconnection.
+   * Dirty and inactive states are not part of the plan.
+   */
+  class UpdatePlan
+  {
+  public:
+    void invalidate(){valid = false;}
+    bool isValid() const {return valid;}
+    bool build(Graph&); //!< false if graph isn't a dag. plan stays invalid.
+    
+    const Vertices& getOrder() const {return order;} //!< alive vertices. parents before children.
+    const std::vector<Vertices>& getWaves() const {return waves;} //!< members of a wave don't depend on each other.
+    std::size_t getDepth(Vertex v) const {return depths.at(v);}
+    const Vertices& getParents(Vertex v) const {return parents.at(v);}
+    const ftr::UpdatePayload::UpdateMap& getParentMap(Vertex v) const {return parentMaps.at(v);}
+    std::size_t getBuildCount() const {return buildCount;}
+    
+    std::ostream& dump(std::ostream&, const Graph&) const;
+    
+  private:
+    bool valid = false;
+    std::size_t buildCount = 0; //!< number of builds. to see how often the plan is thrown away.
+    Vertices order;
+    std::vector<Vertices> waves;
+    //@{
+    //! indexed by vertex. entries for dead vertices are empty.
+    std::vector<std::size_t> depths;
+    std::vector<Vertices> parents;
+    std::vector<ftr::UpdatePayload::UpdateMap> parentMaps;
+    //@}
+  };
+}
+
+#endif // PRJ_UPDATEPLAN_H
@@ -776,6 +776,36 @@ namespace prj
       {
         this->faces_ = s;
       }
+
+      const Surface::BinaryOptional& Surface::
+      binary () const
+      {
+        return this->binary_;
+      }
+
+      Surface::BinaryOptional& Surface::
+      binary ()
+      {
+        return this->binary_;
+      }
+
+      void Surface::
+      binary (const BinaryType& x)
+      {
+        this->binary_.set (x);
+      }
+
+      void Surface::
+      binary (const BinaryOptional& x)
+      {
+        this->binary_ = x;
+      }
+
+      void Surface::
+      binary (::std::unique_ptr< BinaryType > x)
+      {
+        this->binary_.set (std::move (x));
+      }
     }
   }
 }
@@ -1961,7 +1991,8 @@ namespace prj
       Surface ()
       : ::xml_schema::Type (),
         points_ (this),
-        faces_ (this)
+        faces_ (this),
+        binary_ (this)
       {
       }
 
@@ -1971,7 +2002,8 @@ namespace prj
                ::xml_schema::Container* c)
       : ::xml_schema::Type (x, f, c),
         points_ (x.points_, f, this),
-        faces_ (x.faces_, f, this)
+        faces_ (x.faces_, f, this),
+        binary_ (x.binary_, f, this)
       {
       }
 
@@ -1981,7 +2013,8 @@ namespace prj
                ::xml_schema::Container* c)
       : ::xml_schema::Type (e, f | ::xml_schema::Flags::base, c),
         points_ (this),
-        faces_ (this)
+        faces_ (this),
+        binary_ (this)
       {
         if ((f & ::xml_schema::Flags::base) == 0)
         {
@@ -2022,6 +2055,20 @@ namespace prj
             continue;
           }
 
+          // binary
+          //
+          if (n.name () == "binary" && n.namespace_ ().empty ())
+          {
+            ::std::unique_ptr< BinaryType > r (
+              BinaryTraits::create (i, f, this));
+
+            if (!this->binary_)
+            {
+              this->binary_.set (::std::move (r));
+              continue;
+            }
+          }
+
           break;
         }
       }
@@ -2041,6 +2088,7 @@ namespace prj
           static_cast< ::xml_schema::Type& > (*this) = x;
           this->points_ = x.points_;
           this->faces_ = x.faces_;
+          this->binary_ = x.binary_;
         }
 
         return *this;
@@ -2553,6 +2601,18 @@ namespace prj
 
           s << *b;
         }
+
+        // binary
+        //
+        if (i.binary ())
+        {
+          ::xercesc::DOMElement& s (
+            ::xsd::cxx::xml::dom::create_element (
+              "binary",
+              e));
+
+          s << *i.binary ();
+        }
       }
     }
   }
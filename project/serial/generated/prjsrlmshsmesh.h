@@ -909,6 +909,27 @@ namespace prj
         void
         faces (const FacesSequence& s);
 
+        // binary
+        //
+        typedef ::xml_schema::String BinaryType;
+        typedef ::xsd::cxx::tree::optional< BinaryType > BinaryOptional;
+        typedef ::xsd::cxx::tree::traits< BinaryType, char > BinaryTraits;
+
+        const BinaryOptional&
+        binary () const;
+
+        BinaryOptional&
+        binary ();
+
+        void
+        binary (const BinaryType& x);
+
+        void
+        binary (const BinaryOptional& x);
+
+        void
+        binary (::std::unique_ptr< BinaryType > p);
+
         // Constructors.
         //
         Surface ();
@@ -941,6 +962,7 @@ namespace prj
         protected:
         PointsSequence points_;
         FacesSequence faces_;
+        BinaryOptional binary_;
       };
     }
   }
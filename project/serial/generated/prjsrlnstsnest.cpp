@@ -210,6 +210,66 @@ namespace prj
       {
         this->pitch_.set (x);
       }
+
+      const Nest::ToleranceOptional& Nest::
+      tolerance () const
+      {
+        return this->tolerance_;
+      }
+
+      Nest::ToleranceOptional& Nest::
+      tolerance ()
+      {
+        return this->tolerance_;
+      }
+
+      void Nest::
+      tolerance (const ToleranceType& x)
+      {
+        this->tolerance_.set (x);
+      }
+
+      void Nest::
+      tolerance (const ToleranceOptional& x)
+      {
+        this->tolerance_ = x;
+      }
+
+      void Nest::
+      tolerance (::std::unique_ptr< ToleranceType > x)
+      {
+        this->tolerance_.set (std::move (x));
+      }
+
+      const Nest::AngleCountOptional& Nest::
+      angleCount () const
+      {
+        return this->angleCount_;
+      }
+
+      Nest::AngleCountOptional& Nest::
+      angleCount ()
+      {
+        return this->angleCount_;
+      }
+
+      void Nest::
+      angleCount (const AngleCountType& x)
+      {
+        this->angleCount_.set (x);
+      }
+
+      void Nest::
+      angleCount (const AngleCountOptional& x)
+      {
+        this->angleCount_ = x;
+      }
+
+      void Nest::
+      angleCount (::std::unique_ptr< AngleCountType > x)
+      {
+        this->angleCount_.set (std::move (x));
+      }
     }
   }
 }
@@ -240,7 +300,9 @@ namespace prj
         feedDirection_ (feedDirection, this),
         gapLabel_ (gapLabel, this),
         feedDirectionLabel_ (feedDirectionLabel, this),
-        pitch_ (pitch, this)
+        pitch_ (pitch, this),
+        tolerance_ (this),
+        angleCount_ (this)
       {
       }
 
@@ -259,7 +321,9 @@ namespace prj
         feedDirection_ (std::move (feedDirection), this),
         gapLabel_ (std::move (gapLabel), this),
         feedDirectionLabel_ (std::move (feedDirectionLabel), this),
-        pitch_ (pitch, this)
+        pitch_ (pitch, this),
+        tolerance_ (this),
+        angleCount_ (this)
       {
       }
 
@@ -274,7 +338,9 @@ namespace prj
         feedDirection_ (x.feedDirection_, f, this),
         gapLabel_ (x.gapLabel_, f, this),
         feedDirectionLabel_ (x.feedDirectionLabel_, f, this),
-        pitch_ (x.pitch_, f, this)
+        pitch_ (x.pitch_, f, this),
+        tolerance_ (x.tolerance_, f, this),
+        angleCount_ (x.angleCount_, f, this)
       {
       }
 
@@ -289,7 +355,9 @@ namespace prj
         feedDirection_ (this),
         gapLabel_ (this),
         feedDirectionLabel_ (this),
-        pitch_ (this)
+        pitch_ (this),
+        tolerance_ (this),
+        angleCount_ (this)
       {
         if ((f & ::xml_schema::Flags::base) == 0)
         {
@@ -403,6 +471,34 @@ namespace prj
             }
           }
 
+          // tolerance
+          //
+          if (n.name () == "tolerance" && n.namespace_ ().empty ())
+          {
+            ::std::unique_ptr< ToleranceType > r (
+              ToleranceTraits::create (i, f, this));
+
+            if (!this->tolerance_)
+            {
+              this->tolerance_.set (::std::move (r));
+              continue;
+            }
+          }
+
+          // angleCount
+          //
+          if (n.name () == "angleCount" && n.namespace_ ().empty ())
+          {
+            ::std::unique_ptr< AngleCountType > r (
+              AngleCountTraits::create (i, f, this));
+
+            if (!this->angleCount_)
+            {
+              this->angleCount_.set (::std::move (r));
+              continue;
+            }
+          }
+
           break;
         }
 
@@ -476,6 +572,8 @@ namespace prj
           this->gapLabel_ = x.gapLabel_;
           this->feedDirectionLabel_ = x.feedDirectionLabel_;
           this->pitch_ = x.pitch_;
+          this->tolerance_ = x.tolerance_;
+          this->angleCount_ = x.angleCount_;
         }
 
         return *this;
@@ -859,6 +957,30 @@ namespace prj
 
           s << ::xml_schema::AsDouble(i.pitch ());
         }
+
+        // tolerance
+        //
+        if (i.tolerance ())
+        {
+          ::xercesc::DOMElement& s (
+            ::xsd::cxx::xml::dom::create_element (
+              "tolerance",
+              e));
+
+          s << *i.tolerance ();
+        }
+
+        // angleCount
+        //
+        if (i.angleCount ())
+        {
+          ::xercesc::DOMElement& s (
+            ::xsd::cxx::xml::dom::create_element (
+              "angleCount",
+              e));
+
+          s << *i.angleCount ();
+        }
       }
 
       void
@@ -222,6 +222,48 @@ namespace prj
         void
         pitch (const PitchType& x);
 
+        // tolerance
+        //
+        typedef ::prj::srl::spt::Parameter ToleranceType;
+        typedef ::xsd::cxx::tree::optional< ToleranceType > ToleranceOptional;
+        typedef ::xsd::cxx::tree::traits< ToleranceType, char > ToleranceTraits;
+
+        const ToleranceOptional&
+        tolerance () const;
+
+        ToleranceOptional&
+        tolerance ();
+
+        void
+        tolerance (const ToleranceType& x);
+
+        void
+        tolerance (const ToleranceOptional& x);
+
+        void
+        tolerance (::std::unique_ptr< ToleranceType > p);
+
+        // angleCount
+        //
+        typedef ::prj::srl::spt::Parameter AngleCountType;
+        typedef ::xsd::cxx::tree::optional< AngleCountType > AngleCountOptional;
+        typedef ::xsd::cxx::tree::traits< AngleCountType, char > AngleCountTraits;
+
+        const AngleCountOptional&
+        angleCount () const;
+
+        AngleCountOptional&
+        angleCount ();
+
+        void
+        angleCount (const AngleCountType& x);
+
+        void
+        angleCount (const AngleCountOptional& x);
+
+        void
+        angleCount (::std::unique_ptr< AngleCountType > p);
+
         // Constructors.
         //
         Nest (const BaseType&,
@@ -273,6 +315,8 @@ namespace prj
         ::xsd::cxx::tree::one< GapLabelType > gapLabel_;
         ::xsd::cxx::tree::one< FeedDirectionLabelType > feedDirectionLabel_;
         ::xsd::cxx::tree::one< PitchType > pitch_;
+        ToleranceOptional tolerance_;
+        AngleCountOptional angleCount_;
       };
     }
   }
@@ -127,6 +127,36 @@ namespace prj
         this->shapeOffset_.set (x);
       }
 
+      const Feature::ShapeFileOptional& Feature::
+      shapeFile () const
+      {
+        return this->shapeFile_;
+      }
+
+      Feature::ShapeFileOptional& Feature::
+      shapeFile ()
+      {
+        return this->shapeFile_;
+      }
+
+      void Feature::
+      shapeFile (const ShapeFileType& x)
+      {
+        this->shapeFile_.set (x);
+      }
+
+      void Feature::
+      shapeFile (const ShapeFileOptional& x)
+      {
+        this->shapeFile_ = x;
+      }
+
+      void Feature::
+      shapeFile (::std::unique_ptr< ShapeFileType > x)
+      {
+        this->shapeFile_.set (std::move (x));
+      }
+
       Feature::ShapeOffsetType Feature::
       shapeOffset_default_value ()
       {
@@ -720,7 +750,8 @@ namespace prj
       : ::xml_schema::Type (),
         id_ (id, this),
         type_ (type, this),
-        shapeOffset_ (shapeOffset, this)
+        shapeOffset_ (shapeOffset, this),
+        shapeFile_ (this)
       {
       }
 
@@ -731,7 +762,8 @@ namespace prj
       : ::xml_schema::Type (x, f, c),
         id_ (x.id_, f, this),
         type_ (x.type_, f, this),
-        shapeOffset_ (x.shapeOffset_, f, this)
+        shapeOffset_ (x.shapeOffset_, f, this),
+        shapeFile_ (x.shapeFile_, f, this)
       {
       }
 
@@ -742,7 +774,8 @@ namespace prj
       : ::xml_schema::Type (e, f | ::xml_schema::Flags::base, c),
         id_ (this),
         type_ (this),
-        shapeOffset_ (this)
+        shapeOffset_ (this),
+        shapeFile_ (this)
       {
         if ((f & ::xml_schema::Flags::base) == 0)
         {
@@ -800,6 +833,20 @@ namespace prj
             }
           }
 
+          // shapeFile
+          //
+          if (n.name () == "shapeFile" && n.namespace_ ().empty ())
+          {
+            ::std::unique_ptr< ShapeFileType > r (
+              ShapeFileTraits::create (i, f, this));
+
+            if (!this->shapeFile_)
+            {
+              this->shapeFile_.set (::std::move (r));
+              continue;
+            }
+          }
+
           break;
         }
 
@@ -841,6 +888,7 @@ namespace prj
           this->id_ = x.id_;
           this->type_ = x.type_;
           this->shapeOffset_ = x.shapeOffset_;
+          this->shapeFile_ = x.shapeFile_;
         }
 
         return *this;
@@ -2244,6 +2292,18 @@ namespace prj
 
           s << i.shapeOffset ();
         }
+
+        // shapeFile
+        //
+        if (i.shapeFile ())
+        {
+          ::xercesc::DOMElement& s (
+            ::xsd::cxx::xml::dom::create_element (
+              "shapeFile",
+              e));
+
+          s << *i.shapeFile ();
+        }
       }
 
       void
@@ -163,6 +163,27 @@ namespace prj
         static ShapeOffsetType
         shapeOffset_default_value ();
 
+        // shapeFile
+        //
+        typedef ::xml_schema::String ShapeFileType;
+        typedef ::xsd::cxx::tree::optional< ShapeFileType > ShapeFileOptional;
+        typedef ::xsd::cxx::tree::traits< ShapeFileType, char > ShapeFileTraits;
+
+        const ShapeFileOptional&
+        shapeFile () const;
+
+        ShapeFileOptional&
+        shapeFile ();
+
+        void
+        shapeFile (const ShapeFileType& x);
+
+        void
+        shapeFile (const ShapeFileOptional& x);
+
+        void
+        shapeFile (::std::unique_ptr< ShapeFileType > p);
+
         // Constructors.
         //
         Feature (const IdType&,
@@ -200,6 +221,7 @@ namespace prj
         ::xsd::cxx::tree::one< TypeType > type_;
         static const TypeType type_default_value_;
         ::xsd::cxx::tree::one< ShapeOffsetType > shapeOffset_;
+        ShapeFileOptional shapeFile_;
       };
 
       class FeatureState: public ::xml_schema::Type
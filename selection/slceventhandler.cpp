@@ -160,12 +160,16 @@ bool EventHandler::handle(const osgGA::GUIEventAdapter& eventAdapter,
     return true; //overlay has taken event;
   }
     
-  //escape key should dispatch to cancel command.
+  //escape key should dispatch to cancel command or a running model update.
   if (eventAdapter.getEventType() == osgGA::GUIEventAdapter::KEYUP)
   {
     if (eventAdapter.getKey() == osgGA::GUIEventAdapter::KEY_Escape)
     {
-      node->send(msg::Message(msg::Request | msg::Command | msg::Done));
+      prj::Project *project = app::instance()->getProject();
+      if (project && project->isUpdating())
+        node->send(msg::Message(msg::Request | msg::Project | msg::Update | msg::Cancel));
+      else
+        node->send(msg::Message(msg::Request | msg::Command | msg::Done));
       return true;
     }
   }
@@ -20,6 +20,9 @@
 #include <cassert>
 #include <iostream>
 #include <array>
+#include <algorithm>
+#include <unordered_set>
+#include <mutex>
 
 #include <boost/optional/optional.hpp>
 #include <boost/current_function.hpp>
@@ -29,6 +32,12 @@
 
 using namespace skt;
 
+namespace
+{
+  //! Slvs_Solve works on global data. Every call goes through this.
+  std::mutex solveMutex;
+}
+
 //! @details return the handle to the current work plane origin
 Slvs_hEntity Solver::getWPOrigin() const
 {
@@ -84,6 +93,7 @@ void Solver::createYAxis()
 Slvs_hParam Solver::addParameter(double value)
 {
   parameters.push_back(Slvs_MakeParam(nph, group, value));
+  parameterIndex[nph] = parameters.size() - 1;
   nph++;
   return parameters.back().h;
 }
@@ -96,14 +106,11 @@ Slvs_hParam Solver::addParameter(double value)
  */
 void Solver::removeParameter(Slvs_hParam ph)
 {
-  for (auto it = parameters.begin(); it != parameters.end(); ++it)
-  {
-    if (it->h == ph)
-    {
-      parameters.erase(it);
-      break;
-    }
-  }
+  auto it = parameterIndex.find(ph);
+  if (it == parameterIndex.end())
+    return;
+  parameters.erase(parameters.begin() + it->second);
+  reindex(parameters, parameterIndex);
 }
 
 /*! @details Get a vector of orphaned parameter handles.
@@ -114,27 +121,15 @@ void Solver::removeParameter(Slvs_hParam ph)
  */ 
 std::vector<Slvs_hParam> Solver::getOrphanedParameters() const
 {
+  std::unordered_set<Slvs_hParam> referenced;
+  for (const auto &e : entities)
+    referenced.insert(std::begin(e.param), std::end(e.param));
+  
   std::vector<Slvs_hParam> out;
   for (const auto &p : parameters)
   {
-    bool found = false;
-    Slvs_hParam ch = p.h; //current handle
-    for (const auto &e : entities)
-    {
-      if
-      (
-        e.param[0] == ch
-        || e.param[1] == ch
-        || e.param[2] == ch
-        || e.param[3] == ch
-      )
-      {
-        found = true;
-        break;
-      }
-    }
-    if (!found)
-      out.push_back(ch);
+    if (referenced.count(p.h) == 0)
+      out.push_back(p.h);
   }
   return out;
 }
@@ -147,13 +142,14 @@ std::vector<Slvs_hParam> Solver::getOrphanedParameters() const
  */
 int Solver::removeOrphanedParameters()
 {
-  int count = 0;
-  for (auto ph : getOrphanedParameters())
-  {
-    removeParameter(ph);
-    count++;
-  }
-  return count;
+  auto orphans = getOrphanedParameters();
+  if (orphans.empty())
+    return 0;
+  std::unordered_set<Slvs_hParam> htr(orphans.begin(), orphans.end()); //handles to remove
+  auto ptei = std::remove_if(parameters.begin(), parameters.end(), [&](const Slvs_Param &p){return htr.count(p.h) != 0;});
+  parameters.erase(ptei, parameters.end());
+  reindex(parameters, parameterIndex);
+  return static_cast<int>(orphans.size());
 }
 
 /*! @details Add a new 3d point. 
@@ -170,9 +166,7 @@ Slvs_hEntity Solver::addPoint3d(Slvs_hParam px, Slvs_hParam py, Slvs_hParam pz)
   assert(findParameter(py));
   assert(findParameter(pz));
   
-  entities.push_back(Slvs_MakePoint3d(neh, group, px, py, pz));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakePoint3d(neh, group, px, py, pz));
 }
 
 /*! @details Add a new 3d point.
@@ -201,9 +195,7 @@ Slvs_hEntity Solver::addPoint2d(Slvs_hParam pu, Slvs_hParam pv)
   assert(findParameter(pu));
   assert(findParameter(pv));
   
-  entities.push_back(Slvs_MakePoint2d(neh, group, workPlane, pu, pv));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakePoint2d(neh, group, workPlane, pu, pv));
 }
 
 /*! @details Add a new 2d point referencing work plane
@@ -234,9 +226,7 @@ Slvs_hEntity Solver::addNormal3d(Slvs_hParam qwh, Slvs_hParam qxh, Slvs_hParam q
   assert(findParameter(qyh));
   assert(findParameter(qzh));
   
-  entities.push_back(Slvs_MakeNormal3d(neh, group, qwh, qxh, qyh, qzh));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakeNormal3d(neh, group, qwh, qxh, qyh, qzh));
 }
 
 /*! @details create and orientation from an x and y vectors.
@@ -272,9 +262,7 @@ Slvs_hEntity Solver::addWorkPlane(Slvs_hEntity origin, Slvs_hEntity normal)
   assert(isEntityType(origin, SLVS_E_POINT_IN_3D));
   assert(isEntityType(normal, SLVS_E_NORMAL_IN_3D));
   
-  entities.push_back(Slvs_MakeWorkplane(neh, group, origin, normal));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakeWorkplane(neh, group, origin, normal));
 }
 
 /*! @details create a line segment.
@@ -288,9 +276,7 @@ Slvs_hEntity Solver::addLineSegment(Slvs_hEntity p1, Slvs_hEntity p2)
   assert(isEntityType(p1, SLVS_E_POINT_IN_2D) || isEntityType(p1, SLVS_E_POINT_IN_3D));
   assert(isEntityType(p2, SLVS_E_POINT_IN_2D) || isEntityType(p2, SLVS_E_POINT_IN_3D));
   
-  entities.push_back(Slvs_MakeLineSegment(neh, group, workPlane, p1, p2));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakeLineSegment(neh, group, workPlane, p1, p2));
 }
 
 /*! @details create an addArcOfCircle
@@ -315,9 +301,7 @@ Slvs_hEntity Solver::addArcOfCircle
   assert(isEntityType(start, SLVS_E_POINT_IN_2D));
   assert(isEntityType(end, SLVS_E_POINT_IN_2D));
   
-  entities.push_back(Slvs_MakeArcOfCircle(neh, group, workPlane, orient, center, start, end));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakeArcOfCircle(neh, group, workPlane, orient, center, start, end));
 }
 
 /*! @details create distance entity.
@@ -340,9 +324,7 @@ Slvs_hEntity Solver::addDistance(Slvs_hParam p)
 {
   assert(findParameter(p));
   
-  entities.push_back(Slvs_MakeDistance(neh, group, workPlane, p));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakeDistance(neh, group, workPlane, p));
 }
 
 /*! @details create circle entity.
@@ -356,9 +338,7 @@ Slvs_hEntity Solver::addCircle(Slvs_hEntity point, Slvs_hEntity distance)
   assert(isEntityType(point, SLVS_E_POINT_IN_2D));
   assert(isEntityType(distance, SLVS_E_DISTANCE));
   
-  entities.push_back(Slvs_MakeCircle(neh, group, workPlane, point, getWPNormal3d(), distance));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakeCircle(neh, group, workPlane, point, getWPNormal3d(), distance));
 }
 
 /*! @details create a cubic bezier entity.
@@ -376,9 +356,7 @@ Slvs_hEntity Solver::addCubicBezier(Slvs_hEntity p1, Slvs_hEntity p2, Slvs_hEnti
   assert(isEntityType(p3, SLVS_E_POINT_IN_2D));
   assert(isEntityType(p4, SLVS_E_POINT_IN_2D));
   
-  entities.push_back(Slvs_MakeCubic(neh, group, workPlane, p1, p2, p3, p4));
-  neh++;
-  return entities.back().h;
+  return pushEntity(Slvs_MakeCubic(neh, group, workPlane, p1, p2, p3, p4));
 }
 
 /*! @details remove an entity from the system.
@@ -389,43 +367,59 @@ Slvs_hEntity Solver::addCubicBezier(Slvs_hEntity p1, Slvs_hEntity p2, Slvs_hEnti
  */
 void Solver::removeEntity(Slvs_hEntity eh)
 {
-  std::vector<Slvs_hEntity> htr(1, eh); //handles to remove
-  auto oe = findEntity(eh); //optional entity
-  if (!oe)
-    return;
-  
-  if (oe.get().type == SLVS_E_LINE_SEGMENT)
-  {
-    //remove endpoints.
-    htr.push_back(oe.get().point[0]);
-    htr.push_back(oe.get().point[1]);
-  }
-  else if (oe.get().type == SLVS_E_ARC_OF_CIRCLE)
-  {
-    //remove endpoints and center.
-    htr.push_back(oe.get().point[0]);
-    htr.push_back(oe.get().point[1]);
-    htr.push_back(oe.get().point[2]);
-  }
-  else if (oe.get().type == SLVS_E_CIRCLE)
-  {
-    //remove center point and distance.
-    htr.push_back(oe.get().point[0]);
-    htr.push_back(oe.get().distance);
-  }
-  else if (oe.get().type == SLVS_E_CUBIC)
+  removeEntities(std::vector<Slvs_hEntity>(1, eh));
+}
+
+/*! @details remove entities from the system in one pass.
+ * 
+ * @param ehs are the handles of the entities to remove. Missing handles are ignored.
+ * @note Same dependent removal as @ref removeEntity.
+ */
+void Solver::removeEntities(const std::vector<Slvs_hEntity> &ehs)
+{
+  std::unordered_set<Slvs_hEntity> htr; //handles to remove
+  for (auto eh : ehs)
   {
-    //remove pointS.
-    htr.push_back(oe.get().point[0]);
-    htr.push_back(oe.get().point[1]);
-    htr.push_back(oe.get().point[2]);
-    htr.push_back(oe.get().point[3]);
+    auto oe = findEntity(eh); //optional entity
+    if (!oe)
+      continue;
+    htr.insert(eh);
+    
+    const Slvs_Entity &e = oe.get();
+    if (e.type == SLVS_E_LINE_SEGMENT)
+    {
+      //remove endpoints.
+      htr.insert(e.point[0]);
+      htr.insert(e.point[1]);
+    }
+    else if (e.type == SLVS_E_ARC_OF_CIRCLE)
+    {
+      //remove endpoints and center.
+      htr.insert(e.point[0]);
+      htr.insert(e.point[1]);
+      htr.insert(e.point[2]);
+    }
+    else if (e.type == SLVS_E_CIRCLE)
+    {
+      //remove center point and distance.
+      htr.insert(e.point[0]);
+      htr.insert(e.distance);
+    }
+    else if (e.type == SLVS_E_CUBIC)
+    {
+      //remove pointS.
+      htr.insert(e.point[0]);
+      htr.insert(e.point[1]);
+      htr.insert(e.point[2]);
+      htr.insert(e.point[3]);
+    }
   }
+  if (htr.empty())
+    return;
   
-  auto ptei = entities.end(); //past the end iterator
-  for (const auto &rh : htr)
-    ptei = std::remove_if(entities.begin(), ptei, [&rh](const Slvs_Entity& e){return e.h == rh;});
+  auto ptei = std::remove_if(entities.begin(), entities.end(), [&](const Slvs_Entity& e){return htr.count(e.h) != 0;});
   entities.erase(ptei, entities.end());
+  reindex(entities, entityIndex);
 }
 
 /*! @details Get all the orphaned entities. An orphaned entity is one 
@@ -436,51 +430,22 @@ void Solver::removeEntity(Slvs_hEntity eh)
  */
 std::vector<Slvs_hEntity> Solver::getOrphanedEntities() const
 {
-  std::vector<Slvs_hParam> aph; //all parameter handles
-  for (const auto &p : parameters)
-    aph.push_back(p.h);
-  uniquefy(aph);
-  
-  std::vector<Slvs_hEntity> aeh; //all entity handles
-  for (const auto &e : entities)
-    aeh.push_back(e.h);
-  uniquefy(aeh);
+  //handle of zero is null and doesn't need to exist.
+  auto hasParameter = [&](Slvs_hParam h){return h == 0 || parameterIndex.count(h) != 0;};
+  auto hasEntity = [&](Slvs_hEntity h){return h == 0 || entityIndex.count(h) != 0;};
   
   std::vector<Slvs_hEntity> out;
   for (const auto &e : entities)
   {
-    std::vector<Slvs_hParam> cph; //current parameter handles
-    cph.push_back(e.param[0]);
-    cph.push_back(e.param[1]);
-    cph.push_back(e.param[2]);
-    cph.push_back(e.param[3]);
-    uniquefy(cph);
-    
-    std::vector<Slvs_hEntity> ceh; //current entity handles
-    ceh.push_back(e.wrkpl);
-    ceh.push_back(e.point[0]);
-    ceh.push_back(e.point[1]);
-    ceh.push_back(e.point[2]);
-    ceh.push_back(e.point[3]);
-    ceh.push_back(e.normal);
-    ceh.push_back(e.distance);
-    uniquefy(ceh);
-    
-    std::vector<Slvs_hParam> tph; //temp parameter handles
-    std::set_intersection(cph.begin(), cph.end(), aph.begin(), aph.end(), std::back_inserter(tph));
-    if (tph.size() != cph.size())
-    {
-      out.push_back(e.h);
-      continue;
-    }
-    
-    std::vector<Slvs_hEntity> teh; //temp entity handles
-    std::set_intersection(ceh.begin(), ceh.end(), aeh.begin(), aeh.end(), std::back_inserter(teh));
-    if (teh.size() != ceh.size())
-    {
+    if
+    (
+      !std::all_of(std::begin(e.param), std::end(e.param), hasParameter)
+      || !std::all_of(std::begin(e.point), std::end(e.point), hasEntity)
+      || !hasEntity(e.wrkpl)
+      || !hasEntity(e.normal)
+      || !hasEntity(e.distance)
+    )
       out.push_back(e.h);
-      continue;
-    }
   }
   
   return out;
@@ -494,13 +459,9 @@ std::vector<Slvs_hEntity> Solver::getOrphanedEntities() const
  */
 int Solver::removeOrphanedEntities()
 {
-  int count = 0;
-  for (auto eh : getOrphanedEntities())
-  {
-    removeEntity(eh);
-    count++;
-  }
-  return count;
+  auto orphans = getOrphanedEntities();
+  removeEntities(orphans);
+  return static_cast<int>(orphans.size());
 }
 
 
@@ -517,6 +478,7 @@ Slvs_hConstraint Solver::addConstraint(const Slvs_Constraint &cIn)
   constraints.push_back(cIn);
   if (constraints.back().h == 0)
     constraints.back().h = nch;
+  constraintIndex[constraints.back().h] = constraints.size() - 1;
   nch++;
   return constraints.back().h;
 }
@@ -1838,12 +1800,7 @@ Slvs_hConstraint Solver::addDiameter(double value, Slvs_hEntity e)
  */
 bool Solver::hasConstraint(Slvs_hConstraint ch)
 {
-  for (const auto &c : constraints)
-  {
-    if (c.h == ch)
-      return true;
-  }
-  return false;
+  return constraintIndex.count(ch) != 0;
 }
 
 /*! @details remove a constraint from the system.
@@ -1854,14 +1811,11 @@ bool Solver::hasConstraint(Slvs_hConstraint ch)
  */
 void Solver::removeConstraint(Slvs_hConstraint ch)
 {
-  for (auto it = constraints.begin(); it != constraints.end(); ++it)
-  {
-    if (it->h == ch)
-    {
-      constraints.erase(it);
-      break;
-    }
-  }
+  auto it = constraintIndex.find(ch);
+  if (it == constraintIndex.end())
+    return;
+  constraints.erase(constraints.begin() + it->second);
+  reindex(constraints, constraintIndex);
 }
 
 /*! @details Get all the orphaned constraints. An orphaned constraint is one 
@@ -1872,25 +1826,20 @@ void Solver::removeConstraint(Slvs_hConstraint ch)
  */
 std::vector<Slvs_hConstraint> Solver::getOrphanedConstraints() const
 {
-  std::vector<Slvs_hEntity> aeh; //all entity handles
-  for (const auto &e : entities)
-    aeh.push_back(e.h);
-  uniquefy(aeh);
+  auto hasEntity = [&](Slvs_hEntity h){return h == 0 || entityIndex.count(h) != 0;};
   
   std::vector<Slvs_hConstraint> out;
   for (const auto &c : constraints)
   {
-    std::vector<Slvs_hEntity> ceh; //current entity handles
-    ceh.push_back(c.ptA);
-    ceh.push_back(c.ptB);
-    ceh.push_back(c.entityA);
-    ceh.push_back(c.entityB);
-    ceh.push_back(c.entityC);
-    ceh.push_back(c.entityD);
-    uniquefy(ceh);
-    std::vector<Slvs_hEntity> teh; //temp entity handles.
-    std::set_intersection(ceh.begin(), ceh.end(), aeh.begin(), aeh.end(), std::back_inserter(teh));
-    if (teh.size() != ceh.size())
+    if
+    (
+      !hasEntity(c.ptA)
+      || !hasEntity(c.ptB)
+      || !hasEntity(c.entityA)
+      || !hasEntity(c.entityB)
+      || !hasEntity(c.entityC)
+      || !hasEntity(c.entityD)
+    )
       out.push_back(c.h);
   }
   return out;
@@ -1904,13 +1853,14 @@ std::vector<Slvs_hConstraint> Solver::getOrphanedConstraints() const
  */
 int Solver::removeOrphanedConstraints()
 {
-  int count = 0;
-  for (auto ch : getOrphanedConstraints())
-  {
-    removeConstraint(ch);
-    count++;
-  }
-  return count;
+  auto orphans = getOrphanedConstraints();
+  if (orphans.empty())
+    return 0;
+  std::unordered_set<Slvs_hConstraint> htr(orphans.begin(), orphans.end()); //handles to remove
+  auto ptei = std::remove_if(constraints.begin(), constraints.end(), [&](const Slvs_Constraint &c){return htr.count(c.h) != 0;});
+  constraints.erase(ptei, constraints.end());
+  reindex(constraints, constraintIndex);
+  return static_cast<int>(orphans.size());
 }
 
 /*! @details Set the value of a constraint.
@@ -1920,14 +1870,9 @@ int Solver::removeOrphanedConstraints()
  */
 void Solver::updateConstraintValue(Slvs_hConstraint handle, double value)
 {
-  for (auto &c : constraints)
-  {
-    if (c.h == handle)
-    {
-      c.valA = value;
-      break;
-    }
-  }
+  auto it = constraintIndex.find(handle);
+  if (it != constraintIndex.end())
+    constraints[it->second].valA = value;
 }
 
 /*! @details Clears the parameters marked for drag
@@ -1965,13 +1910,10 @@ void Solver::dragSet(const std::vector<Slvs_hParam> &prms)
  */
 boost::optional<const Slvs_Param&> Solver::findParameter(Slvs_hParam pIn) const
 {
-  for (const auto &p : parameters)
-  {
-    if (p.h == pIn)
-      return p;
-  }
-  
-  return boost::none;
+  auto it = parameterIndex.find(pIn);
+  if (it == parameterIndex.end())
+    return boost::none;
+  return parameters[it->second];
 }
 
 /*! @details Find the actual entity from a handle.
@@ -1982,13 +1924,10 @@ boost::optional<const Slvs_Param&> Solver::findParameter(Slvs_hParam pIn) const
  */
 boost::optional<const Slvs_Entity&> Solver::findEntity(Slvs_hEntity eIn) const
 {
-  for (const auto &e : entities)
-  {
-    if (e.h == eIn)
-      return e;
-  }
-  
-  return boost::none;
+  auto it = entityIndex.find(eIn);
+  if (it == entityIndex.end())
+    return boost::none;
+  return entities[it->second];
 }
 
 /*! @details Find the actual constraint from a handle.
@@ -1999,13 +1938,10 @@ boost::optional<const Slvs_Entity&> Solver::findEntity(Slvs_hEntity eIn) const
  */
 boost::optional<const Slvs_Constraint&> Solver::findConstraint(Slvs_hConstraint cIn) const
 {
-  for (const auto &c : constraints)
-  {
-    if (c.h == cIn)
-      return c;
-  }
-  
-  return boost::none;
+  auto it = constraintIndex.find(cIn);
+  if (it == constraintIndex.end())
+    return boost::none;
+  return constraints[it->second];
 }
 
 /*! @details Test for entity types.
@@ -2046,14 +1982,23 @@ boost::optional<double> Solver::getParameterValue(Slvs_hParam pIn)
  */
 void Solver::setParameterValue(Slvs_hParam pIn, double freshValue)
 {
-  for (auto &p : parameters)
-  {
-    if (p.h == pIn)
-    {
-      p.val = freshValue;
-      break;
-    }
-  }
+  auto it = parameterIndex.find(pIn);
+  if (it != parameterIndex.end())
+    parameters[it->second].val = freshValue;
+}
+
+/*! @details Add an entity and index it.
+ * 
+ * @param eIn is the entity with handle from neh.
+ * @return The handle of the entity.
+ * @note This increments the next entity handle.
+ */
+Slvs_hEntity Solver::pushEntity(const Slvs_Entity &eIn)
+{
+  entities.push_back(eIn);
+  entityIndex[eIn.h] = entities.size() - 1;
+  neh++;
+  return eIn.h;
 }
 
 /*! @details Get the next handle for a parameter.
@@ -2152,6 +2097,8 @@ void Solver::prepare()
  * in output for demo with purposefully redundant constraint. Looking at
  * system.cpp:System::Solve, it appears the parameter is used in a special
  * case and can be by passed. Long story short: don't expect much.
+ * @note Safe to call from any thread. SolveSpace is not reentrant,
+ * so calls from all solvers are serialized.
  */
 void Solver::solve(const Slvs_hGroup &groupIn, bool calculateFailures)
 {
@@ -2160,7 +2107,10 @@ void Solver::solve(const Slvs_hGroup &groupIn, bool calculateFailures)
     sys.calculateFaileds = 1;
   else
     sys.calculateFaileds = 0;
-  Slvs_Solve(&sys, groupIn);
+  {
+    std::lock_guard<std::mutex> lock(solveMutex);
+    Slvs_Solve(&sys, groupIn);
+  }
   failed.resize(sys.faileds);
   dragClear();
 }
@@ -2308,6 +2258,10 @@ void Solver::serialIn(const prj::srl::skts::Solver &sIn)
     constraints.push_back(cIn);
   }
   
+  reindex(parameters, parameterIndex);
+  reindex(entities, entityIndex);
+  reindex(constraints, constraintIndex);
+  
   nph = sIn.nextParameterHandle();
   neh = sIn.nextEntityHandle();
   nch = sIn.nextConstraintHandle();
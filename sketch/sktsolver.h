@@ -24,6 +24,7 @@
 
 #include <vector>
 #include <cstring>
+#include <unordered_map>
 
 #include <boost/optional/optional_fwd.hpp>
 
@@ -149,6 +150,7 @@ namespace skt
     Slvs_hEntity addCubicBezier(Slvs_hEntity, Slvs_hEntity, Slvs_hEntity, Slvs_hEntity);
     
     void removeEntity(Slvs_hEntity);
+    void removeEntities(const std::vector<Slvs_hEntity>&);
     std::vector<Slvs_hEntity> getOrphanedEntities() const;
     int removeOrphanedEntities();
     const std::vector<Slvs_Entity>& getEntities() const {return entities;}//!< @details get const vector of actual entities.
@@ -263,6 +265,28 @@ namespace skt
     
     std::vector<Slvs_hConstraint> failed; //!< @details Failing constraint handles for a failed solve.
     
+    /** @anchor HandleIndex
+     * @name Handle Index
+     * Handle to offset into the contiguous vectors above, which are passed
+     * straight to Slvs_Solve. Every change to the vectors goes through
+     * this class and updates these. Solving only changes values.
+     */
+    ///@{
+    typedef std::unordered_map<uint32_t, std::size_t> HandleIndex;
+    HandleIndex parameterIndex;
+    HandleIndex entityIndex;
+    HandleIndex constraintIndex;
+    template <typename T>
+    static void reindex(const std::vector<T> &objects, HandleIndex &index)
+    {
+      index.clear();
+      index.reserve(objects.size());
+      for (std::size_t offset = 0; offset < objects.size(); ++offset)
+        index[objects[offset].h] = offset;
+    }
+    Slvs_hEntity pushEntity(const Slvs_Entity&);
+    ///@}
+    
     Slvs_hParam nph = 1; //!< @details Next parameter handle.
     Slvs_hEntity neh = 1; //!< @details Next entity handle.
     Slvs_hConstraint nch = 1; //!< @details Next constraint handle.
@@ -19,6 +19,12 @@
 
 #include <iostream>
 #include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+#include <thread>
+#include <chrono>
+#include <memory>
 
 #include <boost/uuid/uuid.hpp>
 #include <boost/uuid/uuid_generators.hpp>
@@ -79,7 +85,8 @@ namespace skt
    * Individual nodes will be much easier to work with but possible slow performance.
    * Going with individual for now. Lets don't premature optimize. Sketches should
    * be small to moderate on complexity. Not going to use boost multi index
-   * for this.
+   * for this. Imported profiles can have thousands of entities though, so
+   * handle lookups go through a hash index. Add records with addRecord.
    */
   struct Map
   {
@@ -96,6 +103,19 @@ namespace skt
     };
     
     std::vector<Record> records; //!< all the records for mapping
+    std::unordered_map<SSHandle, std::size_t> handleIndex; //!< handle to offset into records.
+    
+    /*! @brief Add a record.
+     * @param handle Solvespace handle of new record.
+     * @return Reference to new record. Invalidated by next add.
+     */
+    Record& addRecord(SSHandle handle)
+    {
+      records.push_back(Record());
+      records.back().handle = handle;
+      handleIndex[handle] = records.size() - 1;
+      return records.back();
+    }
     
     /*! @brief Get a record.
      * @param key Solvespace handle used for search.
@@ -103,12 +123,11 @@ namespace skt
      */
     boost::optional<Record&> getRecord(SSHandle key)
     {
-      for (auto &r : records)
-      {
-        if (r.handle == key)
-          return r;
-      }
-      return boost::none;
+      auto it = handleIndex.find(key);
+      if (it == handleIndex.end())
+        return boost::none;
+      assert(records.at(it->second).handle == key);
+      return records[it->second];
     }
     
     /*! @brief Get a record.
@@ -155,13 +174,13 @@ namespace skt
      */
     void removeUnreferenced()
     {
-      for (auto it = records.begin(); it != records.end();)
-      {
-        if (!it->referenced)
-          it = records.erase(it);
-        else
-          ++it;
-      }
+      auto last = std::remove_if(records.begin(), records.end(), [](const Record &r){return !r.referenced;});
+      if (last == records.end())
+        return;
+      records.erase(last, records.end());
+      handleIndex.clear();
+      for (std::size_t index = 0; index < records.size(); ++index)
+        handleIndex[records[index].handle] = index;
     }
   };
   
@@ -258,6 +277,49 @@ namespace skt
       previousPoint = boost::none;
       previousPick.release();
     }
+    
+    /*! @struct DragSolve
+     * @brief State of the drag solve pipeline.
+     * 
+     * @details Drag events only store the latest target point. When no
+     * solve is running, the target is applied to the solver and a copy
+     * is solved on a worker thread. Targets arriving while a solve runs
+     * replace each other, so stale intermediate positions are dropped.
+     * The visual refreshes when a solve completes.
+     */
+    struct DragSolve
+    {
+      std::thread worker;
+      std::unique_ptr<Solver> solving; //!< copy being solved. worker owns it until joined.
+      double solveMilliseconds = 0.0; //!< written by worker. read after join.
+      boost::optional<osg::Vec3d> target; //!< latest drag point not yet solved.
+      std::size_t generation = 0; //!< incremented with every launch. stale completions are ignored.
+      
+      //@{
+      //! stats for the current drag.
+      std::size_t solves = 0;
+      std::size_t dropped = 0; //!< drag events replaced before being solved.
+      double lastMilliseconds = 0.0;
+      double maxMilliseconds = 0.0;
+      double totalMilliseconds = 0.0;
+      //@}
+      
+      bool isRunning() const {return worker.joinable();}
+      void resetStats()
+      {
+        solves = 0;
+        dropped = 0;
+        lastMilliseconds = 0.0;
+        maxMilliseconds = 0.0;
+        totalMilliseconds = 0.0;
+      }
+      ~DragSolve()
+      {
+        if (worker.joinable())
+          worker.join();
+      }
+    };
+    std::shared_ptr<DragSolve> dragSolve = std::make_shared<DragSolve>(); //!< shared so queued completions can detect destruction.
   };
 }
   
@@ -405,9 +467,7 @@ void Visual::update()
     if (!record)
     {
       // add new entity
-      data->eMap.records.push_back(Map::Record());
-      record = data->eMap.records.back();
-      record.get().handle = e.h;
+      record = data->eMap.addRecord(e.h);
       record.get().id = gu::createRandomId();
       record.get().construction = false;
     }
@@ -575,9 +635,7 @@ void Visual::update()
     if (!record)
     {
       // add new constraint
-      data->cMap.records.push_back(Map::Record());
-      record = data->cMap.records.back();
-      record.get().handle = c.h;
+      record = data->cMap.addRecord(c.h);
       record.get().id = gu::createRandomId();
     }
     //build and/or update constraints.
@@ -1510,20 +1568,15 @@ void Visual::startDrag(const osgUtil::LineSegmentIntersector::Intersections &is)
     data->previousPick = data->preHighlight;
     data->previousPoint = op.get();
     data->state = State::drag;
+    data->dragSolve->resetStats();
   }
 }
 
 /*! @brief Response to a mouse drag.
  * 
- * @note I did some profiling to see if I can figure out why 
- * updating feels sluggish when dragging. The time to run solver
- * was similar to freecad, solvespace doesn't show time to solve by default.
- * The time to visual update looked insignificant. 
- * I tried different threading models for the viewer. didn't help.
- * I am convinced that the solver is working efficiently and the 
- * event system queue is being flooded. I tried clearing the osg event
- * queue, but that didn't help. Buffering must happen above. Perhaps
- * X11 for the prototype.
+ * @note Solving on every mouse move flooded the event queue and made
+ * dragging feel sluggish. Now entity drags only record the latest point
+ * and solving happens on a worker. @see launchDragSolve
  */
 void Visual::drag(const osgUtil::LineSegmentIntersector::Intersections &is)
 {
@@ -1537,77 +1590,13 @@ void Visual::drag(const osgUtil::LineSegmentIntersector::Intersections &is)
   auto record = data->eMap.getRecord(data->previousPick);
   if (record)
   {
-    osg::Vec3d projection = op.get() - data->previousPoint.get();
-    if (projection.length() < std::numeric_limits<float>::epsilon())
-      return;
-    SSHandle ph = record.get().handle;
-    auto oe = solver.findEntity(ph);
-    assert(oe);
-    std::vector<Slvs_hParam> draggedParameters;
-    auto projectPoint = [&](Slvs_hParam x, Slvs_hParam y)
-    {
-      osg::Vec3d cp(solver.getParameterValue(x).get(), solver.getParameterValue(y).get(), 0.0);
-      cp += projection;
-      solver.setParameterValue(x, cp.x());
-      solver.setParameterValue(y, cp.y());
-      draggedParameters.push_back(x);
-      draggedParameters.push_back(y);
-    };
-    
-    auto pPoint = [&](boost::optional<const Slvs_Entity&> opIn)
-    {
-      assert(opIn);
-      assert(opIn.get().type == SLVS_E_POINT_IN_2D);
-      projectPoint(opIn.get().param[0], opIn.get().param[1]);
-    };
-    
-    if (solver.isEntityType(ph, SLVS_E_POINT_IN_2D))
-    {
-      pPoint(oe);
-    }
-    if (solver.isEntityType(ph, SLVS_E_LINE_SEGMENT))
-    {
-      pPoint(solver.findEntity(oe.get().point[0]));
-      pPoint(solver.findEntity(oe.get().point[1]));
-    }
-    if (solver.isEntityType(ph, SLVS_E_ARC_OF_CIRCLE))
-    {
-      pPoint(solver.findEntity(oe.get().point[0]));
-      pPoint(solver.findEntity(oe.get().point[1]));
-      pPoint(solver.findEntity(oe.get().point[2]));
-    }
-    if (solver.isEntityType(ph, SLVS_E_CIRCLE))
-    {
-      auto oc = solver.findEntity(ph);
-      assert(oc);
-      
-      osg::Vec3d center = convert(oc.get().point[0]);
-      osg::Vec3d rv = op.get() - center; //radius vector
-      rv.normalize();
-      osg::Vec3d pp = projectPointLine(center, rv, data->previousPoint.get());
-      osg::Vec3d prv = op.get() - pp; // projected radius vector
-      double adjustment = prv.length();
-      prv.normalize();
-      if ((prv - rv).length() > std::numeric_limits<float>::epsilon())
-        adjustment *= -1.0;
-      
-      auto od = solver.findEntity(oc.get().distance);
-      assert(od);
-      auto opv = solver.getParameterValue(od.get().param[0]);
-      solver.setParameterValue(od.get().param[0], opv.get() + adjustment);
-      draggedParameters.push_back(od.get().param[0]);
-    }
-    if (solver.isEntityType(ph, SLVS_E_CUBIC))
-    {
-      pPoint(solver.findEntity(oe.get().point[0]));
-      pPoint(solver.findEntity(oe.get().point[1]));
-      pPoint(solver.findEntity(oe.get().point[2]));
-      pPoint(solver.findEntity(oe.get().point[3]));
-    }
-    
-    solver.dragSet(draggedParameters);
-    solver.solve(solver.getGroup(), true);
-    update();
+    //latest point wins. solve now if worker is free, else when it finishes.
+    Data::DragSolve &ds = *data->dragSolve;
+    if (ds.target)
+      ds.dropped++;
+    ds.target = op.get();
+    if (!ds.isRunning())
+      launchDragSolve();
   }
   else
   {
@@ -1651,14 +1640,180 @@ void Visual::drag(const osgUtil::LineSegmentIntersector::Intersections &is)
         cb->setTextLocation(op.get() * ddi);
       }
     }
+    
+    data->previousPoint = op.get();
+  }
+}
+
+/*! @brief Apply the pending drag point to the solver and solve a copy on a worker.
+ * 
+ * @details The live solver is only touched here and in applyDragSolve,
+ * both on the gui thread, and never while the worker runs.
+ */
+void Visual::launchDragSolve()
+{
+  Data::DragSolve &ds = *data->dragSolve;
+  assert(!ds.isRunning());
+  assert(ds.target);
+  osg::Vec3d point = ds.target.get();
+  ds.target = boost::none;
+  
+  auto record = data->eMap.getRecord(data->previousPick);
+  if (!record)
+    return;
+  osg::Vec3d projection = point - data->previousPoint.get();
+  if (projection.length() < std::numeric_limits<float>::epsilon())
+    return;
+  SSHandle ph = record.get().handle;
+  auto oe = solver.findEntity(ph);
+  assert(oe);
+  std::vector<Slvs_hParam> draggedParameters;
+  auto projectPoint = [&](Slvs_hParam x, Slvs_hParam y)
+  {
+    osg::Vec3d cp(solver.getParameterValue(x).get(), solver.getParameterValue(y).get(), 0.0);
+    cp += projection;
+    solver.setParameterValue(x, cp.x());
+    solver.setParameterValue(y, cp.y());
+    draggedParameters.push_back(x);
+    draggedParameters.push_back(y);
+  };
+  
+  auto pPoint = [&](boost::optional<const Slvs_Entity&> opIn)
+  {
+    assert(opIn);
+    assert(opIn.get().type == SLVS_E_POINT_IN_2D);
+    projectPoint(opIn.get().param[0], opIn.get().param[1]);
+  };
+  
+  if (solver.isEntityType(ph, SLVS_E_POINT_IN_2D))
+  {
+    pPoint(oe);
+  }
+  if (solver.isEntityType(ph, SLVS_E_LINE_SEGMENT))
+  {
+    pPoint(solver.findEntity(oe.get().point[0]));
+    pPoint(solver.findEntity(oe.get().point[1]));
+  }
+  if (solver.isEntityType(ph, SLVS_E_ARC_OF_CIRCLE))
+  {
+    pPoint(solver.findEntity(oe.get().point[0]));
+    pPoint(solver.findEntity(oe.get().point[1]));
+    pPoint(solver.findEntity(oe.get().point[2]));
+  }
+  if (solver.isEntityType(ph, SLVS_E_CIRCLE))
+  {
+    auto oc = solver.findEntity(ph);
+    assert(oc);
+    
+    osg::Vec3d center = convert(oc.get().point[0]);
+    osg::Vec3d rv = point - center; //radius vector
+    rv.normalize();
+    osg::Vec3d pp = projectPointLine(center, rv, data->previousPoint.get());
+    osg::Vec3d prv = point - pp; // projected radius vector
+    double adjustment = prv.length();
+    prv.normalize();
+    if ((prv - rv).length() > std::numeric_limits<float>::epsilon())
+      adjustment *= -1.0;
+    
+    auto od = solver.findEntity(oc.get().distance);
+    assert(od);
+    auto opv = solver.getParameterValue(od.get().param[0]);
+    solver.setParameterValue(od.get().param[0], opv.get() + adjustment);
+    draggedParameters.push_back(od.get().param[0]);
+  }
+  if (solver.isEntityType(ph, SLVS_E_CUBIC))
+  {
+    pPoint(solver.findEntity(oe.get().point[0]));
+    pPoint(solver.findEntity(oe.get().point[1]));
+    pPoint(solver.findEntity(oe.get().point[2]));
+    pPoint(solver.findEntity(oe.get().point[3]));
   }
   
-  data->previousPoint = op.get();
+  solver.dragSet(draggedParameters);
+  data->previousPoint = point;
+  
+  ds.solving = std::make_unique<Solver>(solver);
+  solver.dragClear();
+  std::size_t generation = ++ds.generation;
+  std::weak_ptr<Data::DragSolve> weak = data->dragSolve;
+  Data::DragSolve *dsp = &ds; //destructor of DragSolve joins, so valid while worker runs.
+  ds.worker = std::thread([this, weak, dsp, generation]()
+  {
+    auto start = std::chrono::steady_clock::now();
+    dsp->solving->solve(dsp->solving->getGroup(), true);
+    std::chrono::duration<double, std::milli> time = std::chrono::steady_clock::now() - start;
+    dsp->solveMilliseconds = time.count();
+    
+    QMetaObject::invokeMethod(app::instance(), [this, weak, generation]()
+    {
+      auto locked = weak.lock();
+      if (!locked || locked->generation != generation || !locked->isRunning())
+        return; //visual is gone or waitDragSolve already took it.
+      applyDragSolve();
+      if (locked->target)
+        launchDragSolve();
+    }, Qt::QueuedConnection);
+  });
+}
+
+//! @brief Join the drag worker, if any, and take its solution.
+void Visual::applyDragSolve()
+{
+  Data::DragSolve &ds = *data->dragSolve;
+  if (!ds.isRunning())
+    return;
+  ds.worker.join();
+  std::unique_ptr<Solver> solved = std::move(ds.solving);
+  
+  ds.solves++;
+  ds.lastMilliseconds = ds.solveMilliseconds;
+  ds.maxMilliseconds = std::max(ds.maxMilliseconds, ds.solveMilliseconds);
+  ds.totalMilliseconds += ds.solveMilliseconds;
+  
+  //nothing should change the sketch structure during a drag. be sure.
+  if
+  (
+    solved->getParameters().size() != solver.getParameters().size()
+    || solved->getEntities().size() != solver.getEntities().size()
+    || solved->getConstraints().size() != solver.getConstraints().size()
+  )
+  {
+    std::cout << "WARNING: sketch changed during drag solve. discarding solution" << std::endl;
+    return;
+  }
+  solver = *solved;
+  update();
+}
+
+//! @brief Finish running and pending drag solves before returning.
+void Visual::waitDragSolve()
+{
+  applyDragSolve();
+  if (data->dragSolve->target)
+  {
+    launchDragSolve();
+    applyDragSolve();
+  }
 }
 
 //! @brief Response to ending of a mouse drag.
 void Visual::finishDrag(const osgUtil::LineSegmentIntersector::Intersections&)
 {
+  //release position is the final position.
+  waitDragSolve();
+  const Data::DragSolve &ds = *data->dragSolve;
+  if (ds.solves != 0)
+  {
+    std::ostringstream stream;
+    stream << std::fixed << std::setprecision(2)
+    << "Drag solves: " << ds.solves
+    << "    Dropped: " << ds.dropped
+    << "    Last: " << ds.lastMilliseconds << " ms"
+    << "    Max: " << ds.maxMilliseconds << " ms"
+    << "    Average: " << ds.totalMilliseconds / static_cast<double>(ds.solves) << " ms";
+    app::instance()->messageSlot(msg::buildStatusMessage(stream.str()));
+  }
+  
   data->state = State::selection;
   data->clearPrevious();
 }
@@ -2228,9 +2383,7 @@ boost::optional<std::pair<SSHandle, std::shared_ptr<prm::Parameter>>> Visual::ad
   solver.solve(solver.getGroup(), true);
   
   std::shared_ptr<prm::Parameter> parameter = std::make_shared<prm::Parameter>(prm::Names::Distance, length);
-  data->cMap.records.push_back(Map::Record());
-  Map::Record &record = data->cMap.records.back();
-  record.handle = dh;
+  Map::Record &record = data->cMap.addRecord(dh);
   record.id = gu::createRandomId();
   connectDistance(dh, parameter.get(), osg::Vec3d(length / 2.0, -0.1, 0.0));
   
@@ -2457,9 +2610,7 @@ boost::optional<std::pair<SSHandle, std::shared_ptr<prm::Parameter>>> Visual::ad
     std::shared_ptr<prm::Parameter> parameter = std::make_shared<prm::Parameter>
     (prm::Names::Diameter, radius.get() * 2.0);
     
-    data->cMap.records.push_back(Map::Record());
-    Map::Record &record = data->cMap.records.back();
-    record.handle = dh;
+    Map::Record &record = data->cMap.addRecord(dh);
     record.id = gu::createRandomId();
     connectDiameter(dh, parameter.get(), position * 1.5);
 
@@ -2613,9 +2764,7 @@ boost::optional<std::pair<SSHandle, std::shared_ptr<prm::Parameter>>> Visual::ad
     solver.solve(solver.getGroup(), true);
     
     std::shared_ptr<prm::Parameter> parameter = std::make_shared<prm::Parameter> (prm::Names::Angle, osg::RadiansToDegrees(angle));
-    data->cMap.records.push_back(Map::Record());
-    Map::Record &record = data->cMap.records.back();
-    record.handle = ah;
+    Map::Record &record = data->cMap.addRecord(ah);
     record.id = gu::createRandomId();
     
     osg::Vec3d np = boundingCenter(lines);
@@ -3949,22 +4098,16 @@ void Visual::serialIn(const prj::srl::skts::Visual &sIn)
   
   for (const auto &e : sIn.entityMap())
   {
-    Map::Record record;
-    record.handle = e.handle();
+    Map::Record &record = data->eMap.addRecord(e.handle());
     record.id = gu::stringToId(e.id());
     record.construction = e.construction();
-    
-    data->eMap.records.push_back(record);
   }
   
   for (const auto &c : sIn.constraintMap())
   {
-    Map::Record record;
-    record.handle = c.handle();
+    Map::Record &record = data->cMap.addRecord(c.handle());
     record.id = gu::stringToId(c.id());
     //location is used in Sketch::serialRead
     record.construction = c.construction();
-    
-    data->cMap.records.push_back(record);
   }
 }
@@ -267,6 +267,10 @@ namespace skt
     void clearHighlight(osg::Drawable*);
     void setPointBig(osg::Geometry*);
     void setPointSmall(osg::Geometry*);
+    
+    void launchDragSolve();
+    void applyDragSolve();
+    void waitDragSolve();
   };
 }
 
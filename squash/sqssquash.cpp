@@ -18,6 +18,7 @@
  */
 
 #include <cassert>
+#include <cmath>
 
 #include <boost/filesystem.hpp>
 #include <boost/next_prior.hpp>
@@ -29,8 +30,12 @@
 #include <igl/massmatrix.h>
 
 #include <CGAL/Polygon_mesh_processing/border.h>
+#include <CGAL/AABB_tree.h>
+#include <CGAL/AABB_traits.h>
+#include <CGAL/AABB_triangle_primitive.h>
 
 #include "tools/idtools.h"
+#include "tools/tlsparallel.h"
 #include "squash/sqsigl.h"
 #include "squash/sqssquash.h"
 #include "mesh/mshparameters.h"
@@ -47,6 +52,15 @@
 #include <BRepBuilderAPI_MakeWire.hxx>
 #include <BRepBuilderAPI_MakeFace.hxx>
 #include <BRepExtrema_DistShapeShape.hxx>
+#include <BRepBuilderAPI_Copy.hxx>
+#include <BRepMesh_IncrementalMesh.hxx>
+#include <BRep_Builder.hxx>
+#include <BRep_Tool.hxx>
+#include <TopoDS.hxx>
+#include <TopoDS_Compound.hxx>
+#include <TopExp_Explorer.hxx>
+#include <Poly_Triangulation.hxx>
+#include <Precision.hxx>
 
 using namespace boost::filesystem;
 
@@ -208,32 +222,137 @@ double inferEdgeLength(const msh::srf::Mesh &mIn, int granularity = 0, int tCoun
   return clength;
 }
 
+/* Tessellate the base faces once and put the triangles in an aabb tree.
+ * Distance to the tessellation is within the triangulation deflection of
+ * the exact distance, so only vertices that are ambiguous within that band
+ * get the exact extrema test. The deflection is usually well above the
+ * tolerance, so most vertices are ambiguous. The exact test goes to the
+ * face of the nearest triangle first and then only to faces whose box
+ * holds the vertex.
+ */
 Vertices getBaseVertices(const msh::srf::Mesh &mIn, const occt::FaceVector &fvIn)
 {
   //we are not checking the connection of the faces in.
+  const double tolerance = 0.0001;
   Bnd_Box bb;
   for (const auto &f : fvIn)
     BRepBndLib::Add(f, bb);
-  Vertices out;
+  Vertices candidates;
   for (const auto &v : CGAL::vertices(mIn))
   {
     gp_Pnt occp(mIn.point(v).x(), mIn.point(v).y(), mIn.point(v).z());
-    if (bb.IsOut(occp))
+    if (!bb.IsOut(occp))
+      candidates.push_back(v);
+  }
+  if (candidates.empty())
+    return candidates;
+  
+  //copy so we leave mesh intact in the original faces. don't copy geometry.
+  BRep_Builder builder;
+  TopoDS_Compound compound;
+  builder.MakeCompound(compound);
+  for (const auto &f : fvIn)
+    builder.Add(compound, f);
+  BRepBuilderAPI_Copy copier(compound, Standard_False, Standard_False);
+  double linear = std::max(std::sqrt(bb.SquareExtent()) * 0.001, Precision::Confusion());
+  BRepMesh_IncrementalMesh(copier.Shape(), linear, Standard_False, 0.5, Standard_True);
+  
+  std::vector<Kernel::Triangle_3> triangles;
+  std::vector<std::size_t> triangleFaces; //!< index into fvIn for each triangle.
+  double deflection = 0.0;
+  bool complete = true;
+  for (std::size_t faceIndex = 0; faceIndex < fvIn.size(); ++faceIndex)
+  {
+    TopLoc_Location location;
+    const TopoDS_Face &face = TopoDS::Face(copier.ModifiedShape(fvIn[faceIndex]));
+    const Handle(Poly_Triangulation) &triangulation = BRep_Tool::Triangulation(face, location);
+    if (triangulation.IsNull())
+    {
+      complete = false;
       continue;
+    }
+    deflection = std::max(deflection, triangulation->Deflection());
+    gp_Trsf transformation = location.Transformation();
+    auto node = [&](int index) -> Point
+    {
+      gp_Pnt point = triangulation->Node(index);
+      point.Transform(transformation);
+      return Point(point.X(), point.Y(), point.Z());
+    };
+    for (int index = 1; index < triangulation->NbTriangles() + 1; ++index)
+    {
+      int N1, N2, N3;
+      triangulation->Triangle(index).Get(N1, N2, N3);
+      triangles.emplace_back(node(N1), node(N2), node(N3));
+      triangleFaces.push_back(faceIndex);
+    }
+  }
+  
+  using Primitive = CGAL::AABB_triangle_primitive<Kernel, std::vector<Kernel::Triangle_3>::iterator>;
+  using Tree = CGAL::AABB_tree<CGAL::AABB_traits<Kernel, Primitive>>;
+  Tree tree(triangles.begin(), triangles.end());
+  if (!triangles.empty())
+  {
+    //build tree and distance search structure now. they are built lazily and not thread safe.
+    tree.build();
+    tree.accelerate_distance_queries();
+    tree.squared_distance(mIn.point(candidates.front()));
+  }
+  
+  std::vector<Bnd_Box> faceBoxes(fvIn.size());
+  for (std::size_t index = 0; index < fvIn.size(); ++index)
+  {
+    BRepBndLib::Add(fvIn[index], faceBoxes[index]);
+    faceBoxes[index].Enlarge(tolerance);
+  }
+  
+  //nearest is an index into fvIn to try first. fvIn.size() for none.
+  auto isExactlyOn = [&](const Point &p, std::size_t nearest) -> bool
+  {
+    gp_Pnt occp(p.x(), p.y(), p.z());
     TopoDS_Vertex vx = BRepBuilderAPI_MakeVertex(occp);
-    for (const auto &f : fvIn)
+    auto isOn = [&](std::size_t index) -> bool
     {
-      BRepExtrema_DistShapeShape dss(vx, f);
-      if (!dss.IsDone())
+      BRepExtrema_DistShapeShape dss(vx, fvIn[index]);
+      return dss.IsDone() && dss.Value() < tolerance;
+    };
+    if (nearest < fvIn.size() && isOn(nearest))
+      return true;
+    for (std::size_t index = 0; index < fvIn.size(); ++index)
+    {
+      if (index == nearest || faceBoxes[index].IsOut(occp))
         continue;
-      if (dss.Value() < 0.0001)
-      {
-        out.push_back(v);
-        break;
-      }
+      if (isOn(index))
+        return true;
     }
-  }
+    return false;
+  };
   
+  std::vector<char> flags(candidates.size(), 0);
+  tls::parallelFor(candidates.size(), [&](std::size_t index)
+  {
+    const Point &p = mIn.point(candidates[index]);
+    if (!complete || triangles.empty())
+    {
+      flags[index] = isExactlyOn(p, fvIn.size());
+      return;
+    }
+    auto closest = tree.closest_point_and_primitive(p);
+    double distance = std::sqrt(CGAL::to_double(CGAL::squared_distance(p, closest.first)));
+    if (distance + deflection < tolerance)
+      flags[index] = 1;
+    else if (distance - deflection >= tolerance)
+      flags[index] = 0;
+    else
+      flags[index] = isExactlyOn(p, triangleFaces[std::distance(triangles.begin(), closest.second)]);
+  });
+  
+  Vertices out;
+  for (std::size_t index = 0; index < candidates.size(); ++index)
+  {
+    if (flags[index])
+      out.push_back(candidates[index]);
+  }
   return out;
 }
 
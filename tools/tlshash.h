@@ -0,0 +1,64 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TLS_HASH_H
+#define TLS_HASH_H
+
+#include <cstdint>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace tls
+{
+  /*! @struct Hasher
+   * @brief Content hash for cache keys.
+   * 
+   * @details 128 bit FNV-1a. Fast and stable across runs and machines.
+   * Not cryptographic and nothing checks a match, so a collision is a
+   * silent wrong cache hit. Accidental collisions at 128 bits are not a
+   * practical concern. Don't key untrusted input with it.
+   */
+  struct Hasher
+  {
+    __extension__ typedef unsigned __int128 Value;
+    Value h = (static_cast<Value>(0x6c62272e07bb0142ULL) << 64) | 0x62b821756295c58dULL;
+    void process(const void *data, std::size_t size)
+    {
+      const unsigned char *bytes = static_cast<const unsigned char*>(data);
+      for (std::size_t index = 0; index < size; ++index)
+      {
+        h ^= bytes[index];
+        //multiply by the FNV prime, 2^88 + 0x13b.
+        h = (h << 88) + h * 0x13bU;
+      }
+    }
+    //! 32 hex characters.
+    std::string toString() const
+    {
+      std::ostringstream stream;
+      stream << std::hex << std::setfill('0')
+      << std::setw(16) << static_cast<std::uint64_t>(h >> 64)
+      << std::setw(16) << static_cast<std::uint64_t>(h);
+      return stream.str();
+    }
+  };
+}
+
+#endif // TLS_HASH_H
@@ -0,0 +1,166 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <vector>
+#include <iostream>
+#include <exception>
+
+#include "tools/tlsparallel.h"
+
+namespace
+{
+  //! one call of parallelFor. Shared with the pool, so late helpers find it finished.
+  struct Job
+  {
+    std::size_t count = 0;
+    const std::function<void (std::size_t)> *function = nullptr; //!< only touched for indexes < count.
+    std::atomic<std::size_t> next{0};
+    std::size_t done = 0; //!< guarded by mutex.
+    std::mutex mutex;
+    std::condition_variable finished;
+    
+    void run()
+    {
+      for (std::size_t index = next++; index < count; index = next++)
+      {
+        try
+        {
+          (*function)(index);
+        }
+        catch (const std::exception &e)
+        {
+          std::cerr << "exception in tls::parallelFor: " << e.what() << std::endl;
+        }
+        catch (...)
+        {
+          std::cerr << "unknown exception in tls::parallelFor" << std::endl;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (++done == count)
+          finished.notify_all();
+      }
+    }
+    
+    void wait()
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [this](){return done == count;});
+    }
+  };
+  
+  /*! @brief Threads shared by all calls of parallelFor.
+   * 
+   * @details One less than the default thread count, as the
+   * calling thread always works on its own job.
+   */
+  class Pool
+  {
+  public:
+    Pool()
+    {
+      for (std::size_t index = 1; index < tls::defaultThreadCount(); ++index)
+        threads.emplace_back(&Pool::loop, this);
+    }
+    
+    ~Pool()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+      }
+      wake.notify_all();
+      for (auto &t : threads)
+        t.join();
+    }
+    
+    void help(const std::shared_ptr<Job> &job, std::size_t helpers)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (std::size_t index = 0; index < helpers; ++index)
+          queue.push_back(job);
+      }
+      wake.notify_all();
+    }
+    
+    std::size_t size() const {return threads.size();}
+    
+  private:
+    void loop()
+    {
+      for (;;)
+      {
+        std::shared_ptr<Job> job;
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          wake.wait(lock, [this](){return stop || !queue.empty();});
+          if (stop)
+            return;
+          job = queue.front();
+          queue.pop_front();
+        }
+        job->run();
+      }
+    }
+    
+    std::vector<std::thread> threads;
+    std::deque<std::shared_ptr<Job>> queue;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop = false;
+  };
+  
+  Pool& pool()
+  {
+    static Pool p;
+    return p;
+  }
+}
+
+std::size_t tls::defaultThreadCount()
+{
+  std::size_t out = std::thread::hardware_concurrency();
+  if (out == 0) //unknown.
+    out = 1;
+  return out;
+}
+
+void tls::parallelFor(std::size_t count, const std::function<void (std::size_t)> &function, std::size_t threadCount)
+{
+  if (threadCount == 0)
+    threadCount = defaultThreadCount();
+  threadCount = std::min(threadCount, count);
+  
+  auto job = std::make_shared<Job>();
+  job->count = count;
+  job->function = &function;
+  if (threadCount > 1)
+    pool().help(job, std::min(threadCount - 1, pool().size()));
+  
+  //calling thread is a worker too.
+  job->run();
+  job->wait();
+}
@@ -0,0 +1,47 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TLS_PARALLEL_H
+#define TLS_PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+
+namespace tls
+{
+  //! number of threads to use when none requested. never less than 1.
+  std::size_t defaultThreadCount();
+  
+  /*! @brief Call a function for every index in [0, count) on worker threads.
+   * 
+   * @param count is the number of indexes.
+   * @param function is called once for each index. Must be thread safe.
+   * @param threadCount is the maximum number of threads. 0 uses defaultThreadCount.
+   * @details Blocks until all indexes are processed. Indexes are handed
+   * out in ascending order to whichever thread is free. The calling thread
+   * works too and is helped by threads of one shared pool, so nested calls
+   * don't start more threads than cores. Helpers that are busy elsewhere
+   * simply leave the work to the caller. With a thread count of 1 or a count
+   * of 1, everything is run on the calling thread. Exceptions escaping
+   * function are caught, reported to std::cerr and swallowed.
+   */
+  void parallelFor(std::size_t count, const std::function<void (std::size_t)> &function, std::size_t threadCount = 0);
+}
+
+#endif // TLS_PARALLEL_H
@@ -0,0 +1,298 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <limits>
+#include <array>
+
+#include <osg/Drawable>
+#include <osg/TriangleFunctor>
+
+#include "tools/tlsparallel.h"
+#include "tools/tlsraycaster.h"
+
+using namespace tls;
+
+namespace
+{
+  constexpr std::size_t leafSize = 4;
+  constexpr double infinity = std::numeric_limits<double>::infinity();
+  
+  struct Collector
+  {
+    std::vector<std::array<osg::Vec3d, 3>> *out = nullptr;
+    osg::Matrixd matrix;
+    void operator()(const osg::Vec3 &v0, const osg::Vec3 &v1, const osg::Vec3 &v2)
+    {
+      out->push_back({osg::Vec3d(v0) * matrix, osg::Vec3d(v1) * matrix, osg::Vec3d(v2) * matrix});
+    }
+  };
+  
+  void expand(osg::Vec3d &min, osg::Vec3d &max, const osg::Vec3d &point)
+  {
+    for (int index = 0; index < 3; ++index)
+    {
+      min[index] = std::min(min[index], point[index]);
+      max[index] = std::max(max[index], point[index]);
+    }
+  }
+}
+
+struct RayCaster::Ray
+{
+  osg::Vec3d start;
+  osg::Vec3d direction;
+  osg::Vec3d inverse; //!< component wise reciprocal of direction for slab test.
+  double length; //!< parameter of end. relative to direction.
+  
+  Ray(const osg::Vec3d &startIn, const osg::Vec3d &directionIn, double lengthIn)
+  : start(startIn)
+  , direction(directionIn)
+  , inverse(1.0 / directionIn.x(), 1.0 / directionIn.y(), 1.0 / directionIn.z())
+  , length(lengthIn)
+  {}
+  
+  //! entry parameter into box or infinity when missed or beyond limit.
+  double enter(const Node &node, double limit) const
+  {
+    double near = 0.0;
+    double far = limit;
+    for (int index = 0; index < 3; ++index)
+    {
+      double t0 = (node.min[index] - start[index]) * inverse[index];
+      double t1 = (node.max[index] - start[index]) * inverse[index];
+      if (t0 > t1)
+        std::swap(t0, t1);
+      //nan from 0 * inf fails both compares and leaves the range alone.
+      if (t0 > near)
+        near = t0;
+      if (t1 < far)
+        far = t1;
+      if (near > far)
+        return infinity;
+    }
+    return near;
+  }
+  
+  //! Moller-Trumbore. parameter of hit or infinity.
+  double hit(const Triangle &triangle, double limit) const
+  {
+    osg::Vec3d p = direction ^ triangle.edge2;
+    double determinant = triangle.edge1 * p;
+    if (std::fabs(determinant) < std::numeric_limits<double>::epsilon())
+      return infinity;
+    double inverseDeterminant = 1.0 / determinant;
+    osg::Vec3d s = start - triangle.v0;
+    double u = (s * p) * inverseDeterminant;
+    if (u < 0.0 || u > 1.0)
+      return infinity;
+    osg::Vec3d q = s ^ triangle.edge1;
+    double v = (direction * q) * inverseDeterminant;
+    if (v < 0.0 || u + v > 1.0)
+      return infinity;
+    double t = (triangle.edge2 * q) * inverseDeterminant;
+    if (t < 0.0 || t > limit)
+      return infinity;
+    return t;
+  }
+};
+
+void RayCaster::add(const osg::Drawable &drawable, const osg::Matrixd &matrix)
+{
+  std::vector<std::array<osg::Vec3d, 3>> collected;
+  osg::TriangleFunctor<Collector> functor;
+  functor.out = &collected;
+  functor.matrix = matrix;
+  drawable.accept(functor);
+  
+  triangles.reserve(triangles.size() + collected.size());
+  for (const auto &c : collected)
+    triangles.push_back(Triangle{c[0], c[1] - c[0], c[2] - c[0]});
+  nodes.clear(); //need to rebuild.
+}
+
+void RayCaster::build()
+{
+  nodes.clear();
+  if (triangles.empty())
+    return;
+  
+  std::vector<osg::Vec3d> centroids;
+  centroids.reserve(triangles.size());
+  for (const auto &t : triangles)
+    centroids.push_back(t.v0 + (t.edge1 + t.edge2) / 3.0);
+  
+  nodes.reserve(2 * triangles.size() / leafSize + 1);
+  buildNode(centroids, 0, triangles.size());
+}
+
+/*! @brief Build subtree for triangles [begin, end).
+ * 
+ * @details Splits at the median centroid of the longest centroid
+ * axis. Nodes are stored depth first so the left child of an
+ * interior node is always the next node. Returns index of node.
+ */
+std::size_t RayCaster::buildNode(std::vector<osg::Vec3d> &centroids, std::size_t begin, std::size_t end)
+{
+  std::size_t nodeIndex = nodes.size();
+  nodes.emplace_back();
+  
+  osg::Vec3d min(infinity, infinity, infinity);
+  osg::Vec3d max(-infinity, -infinity, -infinity);
+  osg::Vec3d cMin = min;
+  osg::Vec3d cMax = max;
+  for (std::size_t index = begin; index < end; ++index)
+  {
+    const Triangle &t = triangles[index];
+    expand(min, max, t.v0);
+    expand(min, max, t.v0 + t.edge1);
+    expand(min, max, t.v0 + t.edge2);
+    expand(cMin, cMax, centroids[index]);
+  }
+  nodes[nodeIndex].min = min;
+  nodes[nodeIndex].max = max;
+  
+  osg::Vec3d extent = cMax - cMin;
+  int axis = 0;
+  if (extent.y() > extent[axis])
+    axis = 1;
+  if (extent.z() > extent[axis])
+    axis = 2;
+  if (end - begin <= leafSize || extent[axis] <= 0.0)
+  {
+    nodes[nodeIndex].first = begin;
+    nodes[nodeIndex].count = end - begin;
+    return nodeIndex;
+  }
+  
+  //sort an index permutation so triangles and centroids stay in sync.
+  std::size_t middle = begin + (end - begin) / 2;
+  std::vector<std::size_t> order(end - begin);
+  for (std::size_t index = 0; index < order.size(); ++index)
+    order[index] = begin + index;
+  std::nth_element
+  (
+    order.begin()
+    , order.begin() + (middle - begin)
+    , order.end()
+    , [&](std::size_t a, std::size_t b){return centroids[a][axis] < centroids[b][axis];}
+  );
+  std::vector<Triangle> tTemp;
+  std::vector<osg::Vec3d> cTemp;
+  tTemp.reserve(order.size());
+  cTemp.reserve(order.size());
+  for (auto index : order)
+  {
+    tTemp.push_back(triangles[index]);
+    cTemp.push_back(centroids[index]);
+  }
+  std::copy(tTemp.begin(), tTemp.end(), triangles.begin() + begin);
+  std::copy(cTemp.begin(), cTemp.end(), centroids.begin() + begin);
+  
+  buildNode(centroids, begin, middle);
+  std::size_t right = buildNode(centroids, middle, end);
+  nodes[nodeIndex].first = right;
+  return nodeIndex;
+}
+
+std::optional<double> RayCaster::cast(const Ray &ray) const
+{
+  if (nodes.empty())
+    return std::nullopt;
+  
+  double closest = ray.length;
+  bool found = false;
+  
+  std::array<std::size_t, 64> stack;
+  std::size_t stackSize = 0;
+  if (ray.enter(nodes.front(), closest) == infinity)
+    return std::nullopt;
+  stack[stackSize++] = 0;
+  while (stackSize != 0)
+  {
+    const Node &node = nodes[stack[--stackSize]];
+    if (node.count != 0)
+    {
+      for (std::size_t index = node.first; index < node.first + node.count; ++index)
+      {
+        double t = ray.hit(triangles[index], closest);
+        if (t != infinity)
+        {
+          closest = t;
+          found = true;
+        }
+      }
+      continue;
+    }
+    
+    //push farther child first so nearer child is processed first.
+    std::size_t left = &node - nodes.data() + 1;
+    std::size_t right = node.first;
+    double leftEnter = ray.enter(nodes[left], closest);
+    double rightEnter = ray.enter(nodes[right], closest);
+    if (leftEnter > rightEnter)
+    {
+      std::swap(left, right);
+      std::swap(leftEnter, rightEnter);
+    }
+    if (rightEnter != infinity)
+      stack[stackSize++] = right;
+    if (leftEnter != infinity)
+      stack[stackSize++] = left;
+  }
+  
+  if (!found)
+    return std::nullopt;
+  return closest;
+}
+
+std::optional<osg::Vec3d> RayCaster::cast(const osg::Vec3d &start, const osg::Vec3d &direction, double length) const
+{
+  auto t = cast(Ray(start, direction, length));
+  if (!t)
+    return std::nullopt;
+  return start + direction * *t;
+}
+
+std::vector<std::optional<osg::Vec3d>> RayCaster::cast
+(
+  const std::vector<osg::Vec3d> &starts
+  , const osg::Vec3d &direction
+  , double length
+  , std::size_t threadCount
+) const
+{
+  std::vector<std::optional<osg::Vec3d>> out(starts.size());
+  
+  //chunks keep neighboring rays, that traverse the same nodes, on one thread.
+  constexpr std::size_t chunkSize = 256;
+  std::size_t chunkCount = (starts.size() + chunkSize - 1) / chunkSize;
+  tls::parallelFor(chunkCount, [&](std::size_t chunk)
+  {
+    std::size_t end = std::min(starts.size(), (chunk + 1) * chunkSize);
+    for (std::size_t index = chunk * chunkSize; index < end; ++index)
+    {
+      auto t = cast(Ray(starts[index], direction, length));
+      if (t)
+        out[index] = starts[index] + direction * *t;
+    }
+  }, threadCount);
+  
+  return out;
+}
@@ -0,0 +1,93 @@
+/*
+ * CadSeer. Parametric Solid Modeling.
+ * Copyright (C) 2021  Thomas S. Anderson blobfish.at.gmx.com
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TLS_RAYCASTER_H
+#define TLS_RAYCASTER_H
+
+#include <optional>
+#include <vector>
+
+#include <osg/Vec3d>
+#include <osg/Matrixd>
+
+namespace osg{class Drawable;}
+
+namespace tls
+{
+  /*! @class RayCaster
+   * @brief Closest hit ray casting against triangles.
+   * 
+   * @details Triangles are collected once from osg drawables
+   * and a bounding volume hierarchy is built over them. Casts
+   * don't modify the caster, so any number of threads can cast
+   * against one instance. Use this instead of osgUtil::LineSegmentIntersector
+   * when casting many rays against the same unchanging geometry.
+   */
+  class RayCaster
+  {
+  public:
+    RayCaster() = default;
+    //! add triangles of drawable transformed by matrix. Call build after.
+    void add(const osg::Drawable&, const osg::Matrixd& = osg::Matrixd::identity());
+    void build();
+    std::size_t getTriangleCount() const {return triangles.size();}
+    
+    //! closest hit point of segment start + direction * length. direction need not be normalized.
+    std::optional<osg::Vec3d> cast(const osg::Vec3d &start, const osg::Vec3d &direction, double length) const;
+    
+    /*! @brief Cast parallel rays.
+     * 
+     * @param starts is the start point of each ray.
+     * @param direction shared by all rays.
+     * @param length shared by all rays.
+     * @param threadCount see tls::parallelFor.
+     * @return closest hit for each start point. Same size and order as starts.
+     */
+    std::vector<std::optional<osg::Vec3d>> cast
+    (
+      const std::vector<osg::Vec3d> &starts
+      , const osg::Vec3d &direction
+      , double length
+      , std::size_t threadCount = 0
+    ) const;
+    
+  private:
+    struct Ray;
+    struct Triangle
+    {
+      osg::Vec3d v0;
+      osg::Vec3d edge1; //!< v1 - v0
+      osg::Vec3d edge2; //!< v2 - v0
+    };
+    struct Node
+    {
+      osg::Vec3d min;
+      osg::Vec3d max;
+      std::size_t first = 0; //!< first triangle for leaf. right child for interior.
+      std::size_t count = 0; //!< triangle count for leaf. 0 for interior. left child follows parent.
+    };
+    std::vector<Triangle> triangles;
+    std::vector<Node> nodes;
+    
+    std::size_t buildNode(std::vector<osg::Vec3d>&, std::size_t, std::size_t);
+    std::optional<double> cast(const Ray&) const;
+  };
+}
+
+#endif // TLS_RAYCASTER_H
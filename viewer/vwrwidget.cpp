@@ -184,6 +184,7 @@ struct Widget::Stow
   osg::ref_ptr<slc::EventHandler> selectionHandler;
   osg::ref_ptr<vwr::SpaceballManipulator> spaceballManipulator;
   osg::ref_ptr<osgViewer::ScreenCaptureHandler> screenCaptureHandler;
+  std::vector<msg::Message> pendingLODs; //!< arrived during a model update.
   
   Stow(vwr::Widget *wIn)
   : widget(wIn)
@@ -797,10 +798,23 @@ struct Widget::Stow
   void projectUpdatedDispatched(const msg::Message &)
   {
     serialWrite();
+    
+    std::vector<msg::Message> lods;
+    lods.swap(pendingLODs);
+    for (const auto &m : lods)
+      lodGeneratedDispatched(m);
   }
 
   void lodGeneratedDispatched(const msg::Message &mIn)
   {
+    //features being updated are out of the scene and their nodes belong to the worker.
+    prj::Project *project = app::instance()->getProject();
+    if (project && project->isUpdating())
+    {
+      pendingLODs.push_back(mIn);
+      return;
+    }
+    
     const lod::Message &m = mIn.getLOD();
     slc::PLODIdVisitor vis(m.featureId);
     root->accept(vis);
@@ -810,20 +824,12 @@ struct Widget::Stow
       std::cout << "WARNING: can't find paged lod node in lodGeneratedDispatched" << std::endl;
       return;
     }
-    if (!boost::filesystem::exists(m.filePathOSG))
-    {
-      std::cout
-      << "Warning: file doesn't exist"
-      << m.filePathOSG.string()
-      << " in lodGeneratedDispatched"
-      << std::endl;
-      return;
-    }
-    osg::Node *fileNode = osgDB::readNodeFile(m.filePathOSG.string());
+    //lod::Manager read the node out of shared memory.
+    osg::Node *fileNode = m.node.get();
     if (!fileNode)
     {
       std::cout
-      << "Warning: failed to load file "
+      << "Warning: no node for "
       << m.filePathOSG.string()
       << " in lodGeneratedDispatched"
       << std::endl;